@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ofMain.h"
+
+
+// xorshift generator, cheap enough for per-element respawns in tight loops.
+// Not thread safe; give each thread its own.
+
+class FastRandom
+{
+public:
+    FastRandom(uint32_t seed=2463534242u) {setSeed(seed);}
+
+    void setSeed(uint32_t seed) {state = seed ? seed : 1;}
+
+    uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // same ranges as ofRandom
+    float random(float max) {return max * (next() >> 8) * (1.0f / 16777216.0f);}
+    float random(float min, float max) {return min + random(max - min);}
+
+private:
+    uint32_t state;
+};
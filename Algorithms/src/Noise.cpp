@@ -0,0 +1,423 @@
+#include "Noise.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define F2 0.366025403f     // 0.5 * (sqrt(3) - 1)
+#define G2 0.211324865f     // (3 - sqrt(3)) / 6
+#define F3 0.333333333f
+#define G3 0.166666667f
+
+
+// Ken Perlin's permutation, repeated so indices up to 511 need no wrap
+static const unsigned char perm[512] =
+{
+    151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+    190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,20,
+    125,136,171,168,68,175,74,165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,
+    105,92,41,55,46,245,40,244,102,143,54,65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,
+    135,130,116,188,159,86,164,100,109,198,173,186,3,64,52,217,226,250,124,123,5,202,38,147,118,126,255,
+    82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,170,213,119,248,152,2,44,154,163,70,221,
+    153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,218,246,97,228,
+    251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,192,214,31,181,199,
+    106,157,184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,29,24,72,243,141,128,
+    195,78,66,215,61,156,180,
+    151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+    190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,20,
+    125,136,171,168,68,175,74,165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,
+    105,92,41,55,46,245,40,244,102,143,54,65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,
+    135,130,116,188,159,86,164,100,109,198,173,186,3,64,52,217,226,250,124,123,5,202,38,147,118,126,255,
+    82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,170,213,119,248,152,2,44,154,163,70,221,
+    153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,218,246,97,228,
+    251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,192,214,31,181,199,
+    106,157,184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,29,24,72,243,141,128,
+    195,78,66,215,61,156,180
+};
+
+// gradients picked by the low bits of a hash, as a vector so they apply as a dot product
+static const float grad1[16] = {1, 2, 3, 4, 5, 6, 7, 8, -1, -2, -3, -4, -5, -6, -7, -8};
+
+static const float grad2[8][2] =
+{
+    {1, 2}, {-1, 2}, {1, -2}, {-1, -2},
+    {2, 1}, {2, -1}, {-2, 1}, {-2, -1}
+};
+
+static const float grad3[16][3] =
+{
+    {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0},
+    {1, 0, 1}, {-1, 0, 1}, {1, 0, -1}, {-1, 0, -1},
+    {0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1},
+    {1, 1, 0}, {0, -1, 1}, {-1, 1, 0}, {0, -1, -1}
+};
+
+// like ofNoise, integral values below zero go to the cell below
+static inline int fastFloor(float x)
+{
+    return x > 0 ? (int) x : (int) x - 1;
+}
+
+static inline float noise1(float x)
+{
+    int i0 = fastFloor(x);
+    float x0 = x - i0;
+    float x1 = x0 - 1.0f;
+    float t0 = 1.0f - x0*x0;
+    float t1 = 1.0f - x1*x1;
+    t0 *= t0;
+    t1 *= t1;
+    float n0 = t0 * t0 * (grad1[perm[i0 & 0xff] & 15] * x0);
+    float n1 = t1 * t1 * (grad1[perm[(i0 + 1) & 0xff] & 15] * x1);
+    return 0.25f * (n0 + n1);
+}
+
+static inline float corner2(int hash, float x, float y)
+{
+    float t = 0.5f - x*x - y*y;
+    if (t < 0.0f) return 0.0f;
+    t *= t;
+    const float *g = grad2[hash & 7];
+    return t * t * (g[0] * x + g[1] * y);
+}
+
+static inline float noise2(float x, float y)
+{
+    float s = (x + y) * F2;
+    int i = fastFloor(x + s);
+    int j = fastFloor(y + s);
+    float t = (float) (i + j) * G2;
+    float x0 = x - (i - t);
+    float y0 = y - (j - t);
+    int i1 = x0 > y0 ? 1 : 0;
+    int j1 = 1 - i1;
+    float x1 = x0 - i1 + G2;
+    float y1 = y0 - j1 + G2;
+    float x2 = x0 - 1.0f + 2.0f * G2;
+    float y2 = y0 - 1.0f + 2.0f * G2;
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    float n0 = corner2(perm[ii + perm[jj]], x0, y0);
+    float n1 = corner2(perm[ii + i1 + perm[jj + j1]], x1, y1);
+    float n2 = corner2(perm[ii + 1 + perm[jj + 1]], x2, y2);
+    return 40.0f * (n0 + n1 + n2);
+}
+
+static inline float corner3(int hash, float x, float y, float z)
+{
+    float t = 0.6f - x*x - y*y - z*z;
+    if (t < 0.0f) return 0.0f;
+    t *= t;
+    const float *g = grad3[hash & 15];
+    return t * t * (g[0] * x + g[1] * y + g[2] * z);
+}
+
+static inline float noise3(float x, float y, float z)
+{
+    float s = (x + y + z) * F3;
+    int i = fastFloor(x + s);
+    int j = fastFloor(y + s);
+    int k = fastFloor(z + s);
+    float t = (float) (i + j + k) * G3;
+    float x0 = x - (i - t);
+    float y0 = y - (j - t);
+    float z0 = z - (k - t);
+
+    // offsets of the second and third corners of the simplex
+    bool xy = x0 >= y0, yz = y0 >= z0, xz = x0 >= z0;
+    int i1 = xy && xz, j1 = !xy && yz, k1 = !xz && !yz;
+    int i2 = xy || xz, j2 = !xy || yz, k2 = !xz || !yz;
+
+    float x1 = x0 - i1 + G3, y1 = y0 - j1 + G3, z1 = z0 - k1 + G3;
+    float x2 = x0 - i2 + 2.0f * G3, y2 = y0 - j2 + 2.0f * G3, z2 = z0 - k2 + 2.0f * G3;
+    float x3 = x0 - 1.0f + 3.0f * G3, y3 = y0 - 1.0f + 3.0f * G3, z3 = z0 - 1.0f + 3.0f * G3;
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
+    float n0 = corner3(perm[ii + perm[jj + perm[kk]]], x0, y0, z0);
+    float n1 = corner3(perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]], x1, y1, z1);
+    float n2 = corner3(perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]], x2, y2, z2);
+    float n3 = corner3(perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]], x3, y3, z3);
+    return 32.0f * (n0 + n1 + n2 + n3);
+}
+
+#if defined(__SSE2__)
+
+// the hashes are looked up per lane, everything else runs four wide
+
+static inline __m128 fastFloor4(__m128 x)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmple_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 falloff4(__m128 t)
+{
+    t = _mm_max_ps(t, _mm_setzero_ps());
+    t = _mm_mul_ps(t, t);
+    return _mm_mul_ps(t, t);
+}
+
+static inline __m128 dot2(const int *hash, __m128 x, __m128 y)
+{
+    const float *g0 = grad2[hash[0] & 7], *g1 = grad2[hash[1] & 7], *g2 = grad2[hash[2] & 7], *g3 = grad2[hash[3] & 7];
+    __m128 gx = _mm_setr_ps(g0[0], g1[0], g2[0], g3[0]);
+    __m128 gy = _mm_setr_ps(g0[1], g1[1], g2[1], g3[1]);
+    return _mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y));
+}
+
+static inline __m128 dot3(const int *hash, __m128 x, __m128 y, __m128 z)
+{
+    const float *g0 = grad3[hash[0] & 15], *g1 = grad3[hash[1] & 15], *g2 = grad3[hash[2] & 15], *g3 = grad3[hash[3] & 15];
+    __m128 gx = _mm_setr_ps(g0[0], g1[0], g2[0], g3[0]);
+    __m128 gy = _mm_setr_ps(g0[1], g1[1], g2[1], g3[1]);
+    __m128 gz = _mm_setr_ps(g0[2], g1[2], g2[2], g3[2]);
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y)), _mm_mul_ps(gz, z));
+}
+
+#endif
+
+void Noise::simplex1(int n, const float *x, float *out)
+{
+    int p = 0;
+#if defined(__SSE2__)
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; p + 4 <= n; p += 4)
+    {
+        __m128 xv = _mm_loadu_ps(x + p);
+        __m128 i0 = fastFloor4(xv);
+        __m128 x0 = _mm_sub_ps(xv, i0);
+        __m128 x1 = _mm_sub_ps(x0, one);
+        __m128 t0 = _mm_sub_ps(one, _mm_mul_ps(x0, x0));
+        __m128 t1 = _mm_sub_ps(one, _mm_mul_ps(x1, x1));
+        t0 = _mm_mul_ps(t0, t0);
+        t1 = _mm_mul_ps(t1, t1);
+
+        int ii[4];
+        _mm_storeu_si128((__m128i *) ii, _mm_cvttps_epi32(i0));
+        __m128 g0 = _mm_setr_ps(grad1[perm[ii[0] & 0xff] & 15], grad1[perm[ii[1] & 0xff] & 15], grad1[perm[ii[2] & 0xff] & 15], grad1[perm[ii[3] & 0xff] & 15]);
+        __m128 g1 = _mm_setr_ps(grad1[perm[(ii[0] + 1) & 0xff] & 15], grad1[perm[(ii[1] + 1) & 0xff] & 15], grad1[perm[(ii[2] + 1) & 0xff] & 15], grad1[perm[(ii[3] + 1) & 0xff] & 15]);
+        __m128 n0 = _mm_mul_ps(_mm_mul_ps(t0, t0), _mm_mul_ps(g0, x0));
+        __m128 n1 = _mm_mul_ps(_mm_mul_ps(t1, t1), _mm_mul_ps(g1, x1));
+        _mm_storeu_ps(out + p, _mm_mul_ps(_mm_set1_ps(0.25f), _mm_add_ps(n0, n1)));
+    }
+#endif
+    for (; p < n; p++) {
+        out[p] = noise1(x[p]);
+    }
+}
+
+void Noise::simplex2(int n, const float *x, const float *y, float *out)
+{
+    int p = 0;
+#if defined(__SSE2__)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 g2 = _mm_set1_ps(G2);
+    const __m128 g22 = _mm_set1_ps(2.0f * G2);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; p + 4 <= n; p += 4)
+    {
+        __m128 xv = _mm_loadu_ps(x + p);
+        __m128 yv = _mm_loadu_ps(y + p);
+        __m128 s = _mm_mul_ps(_mm_add_ps(xv, yv), _mm_set1_ps(F2));
+        __m128 i = fastFloor4(_mm_add_ps(xv, s));
+        __m128 j = fastFloor4(_mm_add_ps(yv, s));
+        __m128 t = _mm_mul_ps(_mm_add_ps(i, j), g2);
+        __m128 x0 = _mm_sub_ps(xv, _mm_sub_ps(i, t));
+        __m128 y0 = _mm_sub_ps(yv, _mm_sub_ps(j, t));
+        __m128 i1 = _mm_and_ps(_mm_cmpgt_ps(x0, y0), one);
+        __m128 j1 = _mm_sub_ps(one, i1);
+        __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+        __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+        __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), g22);
+        __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), g22);
+
+        int ii[4], jj[4], ii1[4];
+        _mm_storeu_si128((__m128i *) ii, _mm_cvttps_epi32(i));
+        _mm_storeu_si128((__m128i *) jj, _mm_cvttps_epi32(j));
+        _mm_storeu_si128((__m128i *) ii1, _mm_cvttps_epi32(i1));
+        int h0[4], h1[4], h2[4];
+        for (int l = 0; l < 4; l++)
+        {
+            int a = ii[l] & 0xff, b = jj[l] & 0xff;
+            h0[l] = perm[a + perm[b]];
+            h1[l] = perm[a + ii1[l] + perm[b + 1 - ii1[l]]];
+            h2[l] = perm[a + 1 + perm[b + 1]];
+        }
+
+        __m128 n0 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0))), dot2(h0, x0, y0));
+        __m128 n1 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1))), dot2(h1, x1, y1));
+        __m128 n2 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2))), dot2(h2, x2, y2));
+        _mm_storeu_ps(out + p, _mm_mul_ps(_mm_set1_ps(40.0f), _mm_add_ps(_mm_add_ps(n0, n1), n2)));
+    }
+#endif
+    for (; p < n; p++) {
+        out[p] = noise2(x[p], y[p]);
+    }
+}
+
+void Noise::simplex3(int n, const float *x, const float *y, const float *z, float *out)
+{
+    int p = 0;
+#if defined(__SSE2__)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 g3 = _mm_set1_ps(G3);
+    const __m128 g32 = _mm_set1_ps(2.0f * G3);
+    const __m128 g33 = _mm_set1_ps(3.0f * G3);
+    const __m128 radius = _mm_set1_ps(0.6f);
+    for (; p + 4 <= n; p += 4)
+    {
+        __m128 xv = _mm_loadu_ps(x + p);
+        __m128 yv = _mm_loadu_ps(y + p);
+        __m128 zv = _mm_loadu_ps(z + p);
+        __m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(xv, yv), zv), _mm_set1_ps(F3));
+        __m128 i = fastFloor4(_mm_add_ps(xv, s));
+        __m128 j = fastFloor4(_mm_add_ps(yv, s));
+        __m128 k = fastFloor4(_mm_add_ps(zv, s));
+        __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(i, j), k), g3);
+        __m128 x0 = _mm_sub_ps(xv, _mm_sub_ps(i, t));
+        __m128 y0 = _mm_sub_ps(yv, _mm_sub_ps(j, t));
+        __m128 z0 = _mm_sub_ps(zv, _mm_sub_ps(k, t));
+
+        __m128 xy = _mm_cmpge_ps(x0, y0), yz = _mm_cmpge_ps(y0, z0), xz = _mm_cmpge_ps(x0, z0);
+        __m128 i1 = _mm_and_ps(_mm_and_ps(xy, xz), one);
+        __m128 j1 = _mm_and_ps(_mm_andnot_ps(xy, yz), one);
+        __m128 k1 = _mm_andnot_ps(_mm_or_ps(xz, yz), one);
+        __m128 i2 = _mm_and_ps(_mm_or_ps(xy, xz), one);
+        __m128 j2 = _mm_sub_ps(one, _mm_and_ps(_mm_andnot_ps(yz, xy), one));
+        __m128 k2 = _mm_sub_ps(one, _mm_and_ps(_mm_and_ps(xz, yz), one));
+
+        __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g3), y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g3), z1 = _mm_add_ps(_mm_sub_ps(z0, k1), g3);
+        __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, i2), g32), y2 = _mm_add_ps(_mm_sub_ps(y0, j2), g32), z2 = _mm_add_ps(_mm_sub_ps(z0, k2), g32);
+        __m128 x3 = _mm_add_ps(_mm_sub_ps(x0, one), g33), y3 = _mm_add_ps(_mm_sub_ps(y0, one), g33), z3 = _mm_add_ps(_mm_sub_ps(z0, one), g33);
+
+        int ii[4], jj[4], kk[4];
+        _mm_storeu_si128((__m128i *) ii, _mm_cvttps_epi32(i));
+        _mm_storeu_si128((__m128i *) jj, _mm_cvttps_epi32(j));
+        _mm_storeu_si128((__m128i *) kk, _mm_cvttps_epi32(k));
+        int m1 = _mm_movemask_ps(_mm_cmpgt_ps(i1, _mm_setzero_ps())) | _mm_movemask_ps(_mm_cmpgt_ps(j1, _mm_setzero_ps())) << 4 | _mm_movemask_ps(_mm_cmpgt_ps(k1, _mm_setzero_ps())) << 8;
+        int m2 = _mm_movemask_ps(_mm_cmpgt_ps(i2, _mm_setzero_ps())) | _mm_movemask_ps(_mm_cmpgt_ps(j2, _mm_setzero_ps())) << 4 | _mm_movemask_ps(_mm_cmpgt_ps(k2, _mm_setzero_ps())) << 8;
+        int h0[4], h1[4], h2[4], h3[4];
+        for (int l = 0; l < 4; l++)
+        {
+            int a = ii[l] & 0xff, b = jj[l] & 0xff, c = kk[l] & 0xff;
+            int a1 = m1 >> l & 1, b1 = m1 >> (l + 4) & 1, c1 = m1 >> (l + 8) & 1;
+            int a2 = m2 >> l & 1, b2 = m2 >> (l + 4) & 1, c2 = m2 >> (l + 8) & 1;
+            h0[l] = perm[a + perm[b + perm[c]]];
+            h1[l] = perm[a + a1 + perm[b + b1 + perm[c + c1]]];
+            h2[l] = perm[a + a2 + perm[b + b2 + perm[c + c2]]];
+            h3[l] = perm[a + 1 + perm[b + 1 + perm[c + 1]]];
+        }
+
+        __m128 n0 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0)), _mm_mul_ps(z0, z0))), dot3(h0, x0, y0, z0));
+        __m128 n1 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1)), _mm_mul_ps(z1, z1))), dot3(h1, x1, y1, z1));
+        __m128 n2 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x2, x2)), _mm_mul_ps(y2, y2)), _mm_mul_ps(z2, z2))), dot3(h2, x2, y2, z2));
+        __m128 n3 = _mm_mul_ps(falloff4(_mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x3, x3)), _mm_mul_ps(y3, y3)), _mm_mul_ps(z3, z3))), dot3(h3, x3, y3, z3));
+        _mm_storeu_ps(out + p, _mm_mul_ps(_mm_set1_ps(32.0f), _mm_add_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), n3)));
+    }
+#endif
+    for (; p < n; p++) {
+        out[p] = noise3(x[p], y[p], z[p]);
+    }
+}
+
+void Noise::evaluate(int n, const float *x, const float *y, const float *z, float *out, float scale, float offset)
+{
+    if (z != NULL)      simplex3(n, x, y, z, out);
+    else if (y != NULL) simplex2(n, x, y, out);
+    else                simplex1(n, x, out);
+
+    int p = 0;
+#if defined(__SSE2__)
+    __m128 a = _mm_set1_ps(scale), b = _mm_set1_ps(offset);
+    for (; p + 4 <= n; p += 4) {
+        _mm_storeu_ps(out + p, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(out + p), a), b));
+    }
+#endif
+    for (; p < n; p++) {
+        out[p] = out[p] * scale + offset;
+    }
+}
+
+void Noise::evaluateLine(int dimensions, int n, const ofVec3f &start, const ofVec3f &step, float *out, float scale, float offset)
+{
+    float x[NOISE_BLOCK], y[NOISE_BLOCK], z[NOISE_BLOCK];
+    for (int first = 0; first < n; first += NOISE_BLOCK)
+    {
+        int count = min(n - first, NOISE_BLOCK);
+        for (int p = 0; p < count; p++)
+        {
+            x[p] = start.x + step.x * (first + p);
+            y[p] = start.y + step.y * (first + p);
+            z[p] = start.z + step.z * (first + p);
+        }
+        evaluate(count, x, dimensions > 1 ? y : NULL, dimensions > 2 ? z : NULL, out + first, scale, offset);
+    }
+}
+
+NoiseField::NoiseField()
+{
+    cols = 0;
+    rows = 0;
+    nextRow = 0;
+    rowsPerSlice = 1;
+    textureDirty = false;
+}
+
+void NoiseField::setup(int cols, int rows)
+{
+    this->cols = max(cols, 1);
+    this->rows = max(rows, 1);
+    front.assign(this->cols * this->rows, 0.5f);
+    back.assign(front.size(), 0.5f);
+    nextRow = this->rows;
+    textureDirty = true;
+}
+
+void NoiseField::setSteps(const ofVec3f &colStep, const ofVec3f &rowStep)
+{
+    this->colStep = colStep;
+    this->rowStep = rowStep;
+}
+
+void NoiseField::begin(const ofVec3f &origin, int numSlices)
+{
+    this->origin = origin;
+    numSlices = ofClamp(numSlices, 1, rows);
+    rowsPerSlice = (rows + numSlices - 1) / numSlices;
+    nextRow = 0;
+}
+
+void NoiseField::update()
+{
+    if (isFinished()) return;
+    int last = min(nextRow + rowsPerSlice, rows);
+    for (; nextRow < last; nextRow++) {
+        Noise::noiseLine(cols, origin + nextRow * rowStep, colStep, &back[nextRow * cols]);
+    }
+    if (isFinished())
+    {
+        front.swap(back);
+        textureDirty = true;
+    }
+}
+
+void NoiseField::finish()
+{
+    while (!isFinished()) {
+        update();
+    }
+}
+
+ofTexture & NoiseField::getTexture()
+{
+    if (textureDirty)
+    {
+        if (texture.getWidth() != cols || texture.getHeight() != rows) {
+            texture.allocate(cols, rows, GL_LUMINANCE32F_ARB);
+        }
+        texture.loadData(&front[0], cols, rows, GL_LUMINANCE);
+        textureDirty = false;
+    }
+    return texture;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ofMain.h"
+
+#define NOISE_BLOCK 256     // samples per block of generated coordinates
+
+
+// Batched simplex noise, the same function ofNoise and ofSignedNoise
+// evaluate (apart from negative cells, which are wrapped instead of read
+// out of bounds), four samples at a time with SSE where available. The
+// line versions sample start, start + step, start + 2 * step, ... which
+// covers the usual noise(a + b * i, t) pattern without filling arrays.
+
+class Noise
+{
+public:
+
+    // [0, 1] like ofNoise
+    static void noise(int n, const float *x, float *out) {evaluate(n, x, NULL, NULL, out, 0.5f, 0.5f);}
+    static void noise(int n, const float *x, const float *y, float *out) {evaluate(n, x, y, NULL, out, 0.5f, 0.5f);}
+    static void noise(int n, const float *x, const float *y, const float *z, float *out) {evaluate(n, x, y, z, out, 0.5f, 0.5f);}
+    static void noiseLine(int n, float start, float step, float *out) {evaluateLine(1, n, ofVec3f(start, 0, 0), ofVec3f(step, 0, 0), out, 0.5f, 0.5f);}
+    static void noiseLine(int n, const ofVec2f &start, const ofVec2f &step, float *out) {evaluateLine(2, n, start, step, out, 0.5f, 0.5f);}
+    static void noiseLine(int n, const ofVec3f &start, const ofVec3f &step, float *out) {evaluateLine(3, n, start, step, out, 0.5f, 0.5f);}
+
+    // [-1, 1] like ofSignedNoise
+    static void signedNoise(int n, const float *x, float *out) {evaluate(n, x, NULL, NULL, out, 1.0f, 0.0f);}
+    static void signedNoise(int n, const float *x, const float *y, float *out) {evaluate(n, x, y, NULL, out, 1.0f, 0.0f);}
+    static void signedNoise(int n, const float *x, const float *y, const float *z, float *out) {evaluate(n, x, y, z, out, 1.0f, 0.0f);}
+    static void signedNoiseLine(int n, float start, float step, float *out) {evaluateLine(1, n, ofVec3f(start, 0, 0), ofVec3f(step, 0, 0), out, 1.0f, 0.0f);}
+    static void signedNoiseLine(int n, const ofVec2f &start, const ofVec2f &step, float *out) {evaluateLine(2, n, start, step, out, 1.0f, 0.0f);}
+    static void signedNoiseLine(int n, const ofVec3f &start, const ofVec3f &step, float *out) {evaluateLine(3, n, start, step, out, 1.0f, 0.0f);}
+
+    // out = offset + scale * noise, y and z are NULL for fewer dimensions
+    static void evaluate(int n, const float *x, const float *y, const float *z, float *out, float scale, float offset);
+    static void evaluateLine(int dimensions, int n, const ofVec3f &start, const ofVec3f &step, float *out, float scale, float offset);
+
+private:
+
+    static void simplex1(int n, const float *x, float *out);
+    static void simplex2(int n, const float *x, const float *y, float *out);
+    static void simplex3(int n, const float *x, const float *y, const float *z, float *out);
+};
+
+
+// Grid of noise cached between refreshes, cell (col, row) holding
+// ofNoise(origin + col * colStep + row * rowStep). A refresh can be spread
+// over several calls to update, a slice of rows each, while get keeps
+// returning the last complete grid; the texture holds the same values.
+
+class NoiseField
+{
+public:
+    NoiseField();
+
+    void setup(int cols, int rows);
+    void setSteps(const ofVec3f &colStep, const ofVec3f &rowStep);
+
+    // start refreshing the grid at origin over numSlices calls to update
+    void begin(const ofVec3f &origin, int numSlices=1);
+    void update();
+    void finish();
+    bool isFinished() {return nextRow >= rows;}
+
+    int getCols() {return cols;}
+    int getRows() {return rows;}
+    float get(int col, int row) {return front[row * cols + col];}
+    const float * getData() {return &front[0];}
+    ofTexture & getTexture();
+
+private:
+
+    int cols, rows;
+    ofVec3f origin, colStep, rowStep;
+    int nextRow, rowsPerSlice;
+
+    vector<float> front, back;
+    ofTexture texture;
+    bool textureDirty;
+};
@@ -26,41 +26,58 @@ void EvenPointsGenerator::setNumberCandidates(int numberCandidates)
 
 void EvenPointsGenerator::addPoints(int n)
 {
-    vector<ofPoint>::iterator it;
     ofPoint newPoint, candidate;
     float thisMinDist, currMinDist;
-    bool done;
+
+    // about one point per cell once all are in
+    ofRectangle rect = getBoundingBox();
+    setupGrid(sqrt(rect.getArea() / max((int) points.size() + n, 1)));
     
     for (int i=0; i<n; i++)
     {
-        done = false;
-        while (!done)
+        currMinDist = 0;
+        for (int j=0; j<numberCandidates; j++)
         {
-            done = true;
-            currMinDist = 0;
-            for (int j=0; j<numberCandidates; j++)
+            newPoint = samplePointWithinBounds();
+            thisMinDist = ofGetWidth();
+            for (int b=0; b<bounds.size(); b++) {
+                thisMinDist = min(thisMinDist, ofDist(newPoint.x, newPoint.y, bounds[b].x, bounds[b].y));
+            }
+            thisMinDist = getNearestDistance(newPoint, thisMinDist);
+            if (thisMinDist > currMinDist)
             {
-                thisMinDist = ofGetWidth();
-                newPoint = samplePointWithinBounds();
-                for(it = points.begin(); it != points.end(); ++it)
-                {
-                    float dist = ofDist(newPoint.x, newPoint.y, it->x, it->y);
-                    thisMinDist = min(dist, thisMinDist);
-                }
-                for(it = bounds.begin(); it != bounds.end(); ++it)
-                {
-                    float dist = ofDist(newPoint.x, newPoint.y, it->x, it->y);
-                    thisMinDist = min(dist, thisMinDist);
-                }
-                if (thisMinDist > currMinDist)
-                {
-                    candidate.set(newPoint.x, newPoint.y);
-                    currMinDist = thisMinDist;
-                }
+                candidate.set(newPoint.x, newPoint.y);
+                currMinDist = thisMinDist;
             }
         }
         points.push_back(ofPoint(candidate.x, candidate.y));
+        addToGrid(points.size() - 1);
+    }
+}
+
+float EvenPointsGenerator::getNearestDistance(const ofPoint &p, float maxDist)
+{
+    // rings of cells around p, until the ring is farther than the nearest point found
+    int cell = getCell(p.x, p.y);
+    int cx = cell % numCols, cy = cell / numCols;
+    float nearest = maxDist;
+    int maxRing = max(numCols, numRows);
+    for (int ring=0; ring<=maxRing && (ring - 1) * cellSize < nearest; ring++)
+    {
+        for (int y=cy-ring; y<=cy+ring; y++)
+        {
+            if (y < 0 || y >= numRows) continue;
+            int step = (y == cy-ring || y == cy+ring) ? 1 : max(2*ring, 1);
+            for (int x=cx-ring; x<=cx+ring; x+=step)
+            {
+                if (x < 0 || x >= numCols) continue;
+                for (int i=cellHead[y * numCols + x]; i != -1; i=nextInCell[i]) {
+                    nearest = min(nearest, ofDist(p.x, p.y, points[i].x, points[i].y));
+                }
+            }
+        }
     }
+    return nearest;
 }
 
 ofPoint PointGenerator::samplePointWithinBounds()
@@ -92,38 +109,109 @@ ofPoint PointGenerator::samplePointWithinBounds()
 
 void CirclePackGenerator::addPoints(int n)
 {
-    vector<ofPoint>::iterator it;
     ofPoint candidate;
     float radius, currMinDist;
-    bool done;    
+    
+    // a circle matters to a candidate when its edge is closer than minDist
+    float maxRadius = minDist;
+    for (int i=0; i<points.size(); i++) {
+        maxRadius = max(maxRadius, points[i].z);
+    }
+    float reach = minDist + maxRadius;
+    setupGrid(reach);
+    
     for (int i=0; i<n; i++)
     {
-        done = false;
-        while (!done)
+        bool done = false;
+        for (int attempt=0; attempt<CIRCLEPACK_MAX_ATTEMPTS && !done; attempt++)
         {
             done = true;
             candidate = samplePointWithinBounds();
-            radius = 0;
             currMinDist = minDist;
-            for(it = points.begin(); it != points.end(); ++it)
+            int cx = getCell(candidate.x, candidate.y) % numCols;
+            int cy = getCell(candidate.x, candidate.y) / numCols;
+            for (int y=max(cy-1, 0); y<=min(cy+1, numRows-1) && done; y++)
             {
-                float dist = ofDist(candidate.x, candidate.y, it->x, it->y) - it->z;
-                if (dist < 0)
+                for (int x=max(cx-1, 0); x<=min(cx+1, numCols-1) && done; x++)
                 {
-                    done = false;
-                    break;
-                }
-                else if (dist < currMinDist) {
-                    currMinDist = dist;
+                    for (int j=cellHead[y * numCols + x]; j != -1; j=nextInCell[j])
+                    {
+                        float dist = ofDist(candidate.x, candidate.y, points[j].x, points[j].y) - points[j].z;
+                        if (dist < 0)
+                        {
+                            done = false;
+                            break;
+                        }
+                        else if (dist < currMinDist) {
+                            currMinDist = dist;
+                        }
+                    }
                 }
             }
             radius = currMinDist;
         }
+        if (!done) {
+            return;
+        }
         points.push_back(ofPoint(candidate.x, candidate.y, radius));
+        addToGrid(points.size() - 1);
     }
 }
 
-void Triangulator::triangulate(vector<ofPoint> &points)
+ofRectangle PointGenerator::getBoundingBox()
+{
+    ofRectangle rect;
+    if (!bounds.empty()) {
+        rect.set(bounds[0], 0, 0);
+    }
+    else if (!points.empty()) {
+        rect.set(points[0], 0, 0);
+    }
+    for (int i=0; i<bounds.size(); i++) {
+        rect.growToInclude(bounds[i]);
+    }
+    for (int i=0; i<points.size(); i++) {
+        rect.growToInclude(points[i]);
+    }
+    return rect;
+}
+
+void PointGenerator::setupGrid(float cellSize)
+{
+    gridRect = getBoundingBox();
+    float extent = max(max(gridRect.width, gridRect.height), 1.0f);
+    this->cellSize = max(cellSize, extent / POINTGENERATOR_MAX_GRID);
+    numCols = (int) (gridRect.width / this->cellSize) + 1;
+    numRows = (int) (gridRect.height / this->cellSize) + 1;
+    cellHead.assign(numCols * numRows, -1);
+    nextInCell.clear();
+    for (int i=0; i<points.size(); i++) {
+        addToGrid(i);
+    }
+}
+
+void PointGenerator::addToGrid(int i)
+{
+    int cell = getCell(points[i].x, points[i].y);
+    nextInCell.resize(points.size(), -1);
+    nextInCell[i] = cellHead[cell];
+    cellHead[cell] = i;
+}
+
+int PointGenerator::getCell(float x, float y)
+{
+    int cx = ofClamp((int) ((x - gridRect.x) / cellSize), 0, numCols - 1);
+    int cy = ofClamp((int) ((y - gridRect.y) / cellSize), 0, numRows - 1);
+    return cy * numCols + cx;
+}
+
+Triangulator::Triangulator()
+{
+    numFlips = 0;
+    numRebuilds = 0;
+}
+
+void Triangulator::triangulate(const vector<ofPoint> &points)
 {
     triangulation.reset();
     for (int i=0; i<points.size(); i++) {
@@ -132,4 +220,348 @@ void Triangulator::triangulate(vector<ofPoint> &points)
     triangulation.triangulate();
     triangles = triangulation.getTriangles();
     vertices = triangulation.getVertices();
+    numRebuilds++;
+
+    // the vertices may come back reordered, match them to the input by position
+    vector<int> byPoint(points.size()), byVertex(vertices.size());
+    for (int i=0; i<byPoint.size(); i++) byPoint[i] = i;
+    for (int i=0; i<byVertex.size(); i++) byVertex[i] = i;
+    sort(byPoint.begin(), byPoint.end(), [&points](int a, int b) {
+        return points[a].x < points[b].x || (points[a].x == points[b].x && points[a].y < points[b].y);
+    });
+    sort(byVertex.begin(), byVertex.end(), [this](int a, int b) {
+        return vertices[a].x < vertices[b].x || (vertices[a].x == vertices[b].x && vertices[a].y < vertices[b].y);
+    });
+    vertexIndex.assign(points.size(), -1);
+    for (int i=0, j=0; i<byPoint.size() && j<byVertex.size(); )
+    {
+        const ofPoint &p = points[byPoint[i]];
+        const XYZ &v = vertices[byVertex[j]];
+        if ((float) v.x == p.x && (float) v.y == p.y) {
+            vertexIndex[byPoint[i++]] = byVertex[j++];
+        }
+        else if (v.x < p.x || (v.x == p.x && v.y < p.y)) {
+            j++;
+        }
+        else {
+            i++;
+        }
+    }
+
+    // counter-clockwise throughout, so the predicates have a fixed sign
+    for (int t=0; t<triangles.size(); t++)
+    {
+        if (orient(triangles[t].p1, triangles[t].p2, triangles[t].p3) < 0) {
+            swap(triangles[t].p2, triangles[t].p3);
+        }
+    }
+    setupNeighbours();
+}
+
+void Triangulator::update(const vector<ofPoint> &points)
+{
+    if (points.size() != vertexIndex.size() || triangles.empty() ||
+        find(vertexIndex.begin(), vertexIndex.end(), -1) != vertexIndex.end())
+    {
+        triangulate(points);
+        return;
+    }
+
+    vector<int> movedVertices;
+    vector<ofVec2f> from, to;
+    vector<bool> changed(vertices.size(), false);
+    for (int i=0; i<points.size(); i++)
+    {
+        const XYZ &v = vertices[vertexIndex[i]];
+        if (v.x != points[i].x || v.y != points[i].y)
+        {
+            movedVertices.push_back(vertexIndex[i]);
+            from.push_back(ofVec2f(v.x, v.y));
+            to.push_back(ofVec2f(points[i].x, points[i].y));
+            changed[vertexIndex[i]] = true;
+        }
+    }
+
+    // move in steps small enough that no triangle folds over, and make the
+    // triangulation Delaunay again after each one
+    numFlips = 0;
+    float done = 0, step = 1;
+    while (done < 1)
+    {
+        float f = min(done + step, 1.0f);
+        for (int i=0; i<movedVertices.size(); i++)
+        {
+            ofVec2f p = f < 1 ? from[i].getInterpolated(to[i], f) : to[i];
+            vertices[movedVertices[i]].x = p.x;
+            vertices[movedVertices[i]].y = p.y;
+        }
+        if (!removeFolded(changed))
+        {
+            step *= 0.5;
+            if (step < 1.0 / TRIANGULATOR_MAX_SUBSTEPS)
+            {
+                triangulate(points);
+                return;
+            }
+            continue;
+        }
+
+        // only edges of triangles with a moved corner can have become non-Delaunay
+        pendingEdges.clear();
+        for (int t=0; t<triangles.size(); t++)
+        {
+            const ITRIANGLE &tri = triangles[t];
+            if (!changed[tri.p1] && !changed[tri.p2] && !changed[tri.p3]) continue;
+            for (int k=0; k<3; k++) {
+                pendingEdges.push_back(3*t+k);
+            }
+        }
+        if (!fillHull() || !restoreDelaunay())
+        {
+            triangulate(points);
+            return;
+        }
+        done = f;
+        step *= 2;
+    }
+}
+
+bool Triangulator::removeFolded(const vector<bool> &changed)
+{
+    // a triangle on the hull folds when its inner corner crosses the hull edge;
+    // the corner then joins the hull and the triangle goes. Any other fold
+    // means the points moved too far in one step
+    vector<int> folded;
+    for (int t=0; t<triangles.size(); t++)
+    {
+        const ITRIANGLE &tri = triangles[t];
+        if (!changed[tri.p1] && !changed[tri.p2] && !changed[tri.p3]) continue;
+        if (orient(tri.p1, tri.p2, tri.p3) > 0) continue;
+        int numHullEdges = (neighbours[3*t] == -1) + (neighbours[3*t+1] == -1) + (neighbours[3*t+2] == -1);
+        if (numHullEdges != 1) return false;
+        folded.push_back(t);
+    }
+    if (folded.empty()) return true;
+
+    // the hull edge's ends must stay in some other triangle
+    vector<int> degree(vertices.size(), 0);
+    for (int t=0; t<triangles.size(); t++)
+    {
+        degree[triangles[t].p1]++;
+        degree[triangles[t].p2]++;
+        degree[triangles[t].p3]++;
+    }
+    for (int i=0; i<folded.size(); i++)
+    {
+        const ITRIANGLE &tri = triangles[folded[i]];
+        if (--degree[tri.p1] == 0 || --degree[tri.p2] == 0 || --degree[tri.p3] == 0) {
+            return false;
+        }
+    }
+
+    for (int i=folded.size()-1; i>=0; i--)
+    {
+        int t = folded[i];
+        for (int k=0; k<3; k++)
+        {
+            int u = neighbours[3*t+k];
+            if (u != -1) replace(neighbours.begin() + 3*u, neighbours.begin() + 3*u + 3, t, -1);
+        }
+        int last = triangles.size() - 1;
+        if (t != last)
+        {
+            triangles[t] = triangles[last];
+            for (int k=0; k<3; k++)
+            {
+                int u = neighbours[3*last+k];
+                neighbours[3*t+k] = u;
+                if (u != -1) replace(neighbours.begin() + 3*u, neighbours.begin() + 3*u + 3, last, t);
+            }
+        }
+        triangles.pop_back();
+        neighbours.resize(3 * triangles.size());
+    }
+    return true;
+}
+
+bool Triangulator::fillHull()
+{
+    // hull edges run counter-clockwise from a to next[a]; edgeOf[a] is the triangle edge holding it
+    int n = vertices.size();
+    vector<int> next(n, -1), prev(n, -1), edgeOf(n, -1);
+    for (int t=0; t<triangles.size(); t++)
+    {
+        for (int k=0; k<3; k++)
+        {
+            if (neighbours[3*t+k] != -1) continue;
+            int a = corner(t, k), b = corner(t, (k+1)%3);
+            next[a] = b;
+            prev[b] = a;
+            edgeOf[a] = 3*t+k;
+        }
+    }
+
+    // a hull vertex that moved inwards leaves a notch, close it with a triangle
+    vector<int> pending;
+    for (int a=0; a<n; a++) {
+        if (next[a] != -1) pending.push_back(a);
+    }
+    while (!pending.empty())
+    {
+        int a = pending.back();
+        pending.pop_back();
+        if (next[a] == -1) continue;
+        int b = next[a], c = next[b];
+        if (c == a || orient(a, b, c) >= 0) continue;
+        if (prev[a] == c) return false;    // hull collapsed to a triangle
+
+        ITRIANGLE tri;
+        tri.p1 = a;
+        tri.p2 = c;
+        tri.p3 = b;
+        int t = triangles.size();
+        triangles.push_back(tri);
+        neighbours.push_back(-1);
+        neighbours.push_back(edgeOf[b] / 3);
+        neighbours.push_back(edgeOf[a] / 3);
+        neighbours[edgeOf[b]] = t;
+        neighbours[edgeOf[a]] = t;
+        pendingEdges.push_back(3*t+1);
+        pendingEdges.push_back(3*t+2);
+
+        next[a] = c;
+        prev[c] = a;
+        edgeOf[a] = 3*t;
+        next[b] = prev[b] = edgeOf[b] = -1;
+        pending.push_back(prev[a]);
+        pending.push_back(a);
+    }
+
+    // the triangles around every inner vertex must wind once, and those at a hull
+    // vertex fill its hull angle, otherwise something overlaps
+    vector<double> angle(n, 0);
+    for (int t=0; t<triangles.size(); t++)
+    {
+        for (int k=0; k<3; k++)
+        {
+            int a = corner(t, k), b = corner(t, (k+1)%3), c = corner(t, (k+2)%3);
+            angle[a] += atan2(orient(a, b, c), (vertices[b].x - vertices[a].x) * (vertices[c].x - vertices[a].x) +
+                                                (vertices[b].y - vertices[a].y) * (vertices[c].y - vertices[a].y));
+        }
+    }
+    for (int i=0; i<vertexIndex.size(); i++)
+    {
+        int a = vertexIndex[i];
+        double expected = TWO_PI;
+        if (next[a] != -1)
+        {
+            int b = next[a], c = prev[a];
+            expected = atan2(orient(a, b, c), (vertices[b].x - vertices[a].x) * (vertices[c].x - vertices[a].x) +
+                                              (vertices[b].y - vertices[a].y) * (vertices[c].y - vertices[a].y));
+        }
+        if (abs(angle[a] - expected) > 1e-3) return false;
+    }
+    return true;
+}
+
+bool Triangulator::restoreDelaunay()
+{
+    // Lawson flips, bounded in case rounding makes them cycle
+    int numStepFlips = 0;
+    int maxFlips = 10 * triangles.size() + 100;
+    while (!pendingEdges.empty())
+    {
+        int e = pendingEdges.back();
+        pendingEdges.pop_back();
+        if (flip(e / 3, e % 3) && ++numStepFlips > maxFlips) {
+            return false;
+        }
+    }
+    numFlips += numStepFlips;
+    return true;
+}
+
+bool Triangulator::flip(int t, int k)
+{
+    int u = neighbours[3*t+k];
+    if (u == -1) return false;
+    int a = corner(t, k), b = corner(t, (k+1)%3), c = corner(t, (k+2)%3);
+    int m = 0;
+    while (m < 3 && corner(u, m) != b) m++;
+    if (m == 3 || corner(u, (m+1)%3) != a) return false;
+    int d = corner(u, (m+2)%3);
+    if (inCircle(a, b, c, d) <= 0) return false;
+    if (orient(c, a, d) <= 0 || orient(d, b, c) <= 0) return false;
+
+    int tB = neighbours[3*t+(k+1)%3], tC = neighbours[3*t+(k+2)%3];
+    int uA = neighbours[3*u+(m+1)%3], uB = neighbours[3*u+(m+2)%3];
+
+    // t = (c, a, d), u = (d, b, c), sharing the new edge c-d
+    triangles[t].p1 = c;
+    triangles[t].p2 = a;
+    triangles[t].p3 = d;
+    neighbours[3*t] = tC;
+    neighbours[3*t+1] = uA;
+    neighbours[3*t+2] = u;
+    triangles[u].p1 = d;
+    triangles[u].p2 = b;
+    triangles[u].p3 = c;
+    neighbours[3*u] = uB;
+    neighbours[3*u+1] = tB;
+    neighbours[3*u+2] = t;
+    if (uA != -1) replace(neighbours.begin() + 3*uA, neighbours.begin() + 3*uA + 3, u, t);
+    if (tB != -1) replace(neighbours.begin() + 3*tB, neighbours.begin() + 3*tB + 3, t, u);
+
+    pendingEdges.push_back(3*t);
+    pendingEdges.push_back(3*t+1);
+    pendingEdges.push_back(3*u);
+    pendingEdges.push_back(3*u+1);
+    return true;
+}
+
+void Triangulator::setupNeighbours()
+{
+    // pair up each edge with its reverse by sorting on the undirected key
+    vector<pair<int64_t, int> > edges;
+    edges.reserve(3 * triangles.size());
+    for (int t=0; t<triangles.size(); t++)
+    {
+        for (int k=0; k<3; k++)
+        {
+            int64_t a = corner(t, k), b = corner(t, (k+1)%3);
+            edges.push_back(make_pair(min(a, b) << 32 | max(a, b), 3*t+k));
+        }
+    }
+    sort(edges.begin(), edges.end());
+    neighbours.assign(3 * triangles.size(), -1);
+    for (int i=0; i+1<edges.size(); i++)
+    {
+        if (edges[i].first != edges[i+1].first) continue;
+        neighbours[edges[i].second] = edges[i+1].second / 3;
+        neighbours[edges[i+1].second] = edges[i].second / 3;
+        i++;
+    }
+}
+
+int & Triangulator::corner(int t, int k)
+{
+    return k == 0 ? triangles[t].p1 : (k == 1 ? triangles[t].p2 : triangles[t].p3);
+}
+
+double Triangulator::orient(int a, int b, int c)
+{
+    const XYZ &pa = vertices[a], &pb = vertices[b], &pc = vertices[c];
+    return (pb.x - pa.x) * (pc.y - pa.y) - (pb.y - pa.y) * (pc.x - pa.x);
+}
+
+double Triangulator::inCircle(int a, int b, int c, int d)
+{
+    // positive when d lies inside the circumcircle of the counter-clockwise a, b, c
+    const XYZ &pd = vertices[d];
+    double ax = vertices[a].x - pd.x, ay = vertices[a].y - pd.y;
+    double bx = vertices[b].x - pd.x, by = vertices[b].y - pd.y;
+    double cx = vertices[c].x - pd.x, cy = vertices[c].y - pd.y;
+    return (ax*ax + ay*ay) * (bx*cy - cx*by)
+         - (bx*bx + by*by) * (ax*cy - cx*ay)
+         + (cx*cx + cy*cy) * (ax*by - bx*ay);
 }
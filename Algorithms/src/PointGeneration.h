@@ -3,6 +3,13 @@
 #include "ofMain.h"
 #include "ofxDelaunay.h"
 
+#define TRIANGULATOR_MAX_SUBSTEPS 64
+#define CIRCLEPACK_MAX_ATTEMPTS 1000
+#define POINTGENERATOR_MAX_GRID 1024   // cells along the longer side
+
+
+// Points are also bucketed in a uniform grid over the bounding box of the
+// bounds, so the generators only look at points near a candidate.
 
 class PointGenerator
 {
@@ -15,21 +22,40 @@ public:
 
 protected:
     ofPoint samplePointWithinBounds();
+    ofRectangle getBoundingBox();
+    void setupGrid(float cellSize);
+    void addToGrid(int i);
+    int getCell(float x, float y);
     vector<ofPoint> bounds;
     vector<ofPoint> points;
+
+    ofRectangle gridRect;
+    float cellSize;
+    int numCols, numRows;
+    vector<int> cellHead;       // first point in each cell, -1 if empty
+    vector<int> nextInCell;     // next point in the same cell
 };
 
 
+// Mitchell's best candidate: of numberCandidates random samples, keep the one
+// farthest from all points so far. Nearest points are found by searching the
+// grid outwards ring by ring.
+
 class EvenPointsGenerator : public PointGenerator
 {
 public:
     void addPoints(int n);
     void setNumberCandidates(int numberCandidates);
 private:
+    float getNearestDistance(const ofPoint &p, float maxDist);
     int numberCandidates;
 };
 
 
+// Circles of radius up to minDist, placed at random outside all previous
+// ones. Gives up after CIRCLEPACK_MAX_ATTEMPTS misses in a row, when the
+// bounds are full.
+
 class CirclePackGenerator : public PointGenerator
 {
 public:
@@ -40,15 +66,39 @@ private:
 };
 
 
+// Delaunay triangulation of a point set. triangulate() rebuilds it from
+// scratch; update() keeps the topology of the previous call for points that
+// moved, fills in the convex hull where it changed and flips the edges that
+// no longer meet the Delaunay condition. Points that would fold a triangle
+// over are moved in smaller steps; it falls back to a rebuild when the number
+// of points changes or that takes more than TRIANGULATOR_MAX_SUBSTEPS.
+
 class Triangulator
 {
 public:
-    void triangulate(vector<ofPoint> &points);
-    vector<ITRIANGLE> getTriangles() { return triangles; }
-    vector<XYZ> getVertices() { return vertices; }
-private:    
+    Triangulator();
+    void triangulate(const vector<ofPoint> &points);
+    void update(const vector<ofPoint> &points);
+    const vector<ITRIANGLE> & getTriangles() { return triangles; }
+    const vector<XYZ> & getVertices() { return vertices; }
+    int getNumFlips() { return numFlips; }
+    int getNumRebuilds() { return numRebuilds; }
+private:
+    bool removeFolded(const vector<bool> &changed);
+    bool restoreDelaunay();
+    bool fillHull();
+    bool flip(int t, int k);
+    void setupNeighbours();
+    int & corner(int t, int k);
+    double orient(int a, int b, int c);
+    double inCircle(int a, int b, int c, int d);
+
     ofxDelaunay         triangulation;
     vector<ITRIANGLE>   triangles;
     vector<XYZ>         vertices;
+    vector<int>         vertexIndex;    // input point -> vertex
+    vector<int>         neighbours;     // 3 per triangle, across edge k = (corner k, corner k+1), -1 on the hull
+    vector<int>         pendingEdges;   // triangle edges to check, 3*t+k
+    int numFlips;
+    int numRebuilds;
 };
-
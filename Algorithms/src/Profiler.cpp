@@ -0,0 +1,398 @@
+#include "Profiler.h"
+#include <fstream>
+
+
+static bool hasTimerQueries()
+{
+#ifdef TARGET_OPENGLES
+    return false;
+#else
+    return GLEW_ARB_timer_query;
+#endif
+}
+
+static string escapeJson(const string &s)
+{
+    string escaped;
+    for (auto c : s)
+    {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+ProfilerHistogram::ProfilerHistogram()
+{
+    setSize(PROFILER_HISTORY);
+}
+
+void ProfilerHistogram::setSize(int size)
+{
+    cpu.assign(max(size, 1), 0);
+    gpu.assign(max(size, 1), -1);
+    next = 0;
+    count = 0;
+    gpuCount = 0;
+    cpuSum = 0;
+    gpuSum = 0;
+    for (int i = 0; i < PROFILER_HISTOGRAM_BINS; i++)
+    {
+        cpuBins[i] = 0;
+        gpuBins[i] = 0;
+    }
+}
+
+void ProfilerHistogram::add(float cpuTime, float gpuTime)
+{
+    // the oldest value leaves the window
+    if (count == cpu.size())
+    {
+        cpuSum -= cpu[next];
+        cpuBins[getBin(cpu[next])]--;
+        if (gpu[next] >= 0)
+        {
+            gpuSum -= gpu[next];
+            gpuBins[getBin(gpu[next])]--;
+            gpuCount--;
+        }
+        count--;
+    }
+
+    cpu[next] = cpuTime;
+    gpu[next] = gpuTime;
+    cpuSum += cpuTime;
+    cpuBins[getBin(cpuTime)]++;
+    if (gpuTime >= 0)
+    {
+        gpuSum += gpuTime;
+        gpuBins[getBin(gpuTime)]++;
+        gpuCount++;
+    }
+    count++;
+    next = (next + 1) % cpu.size();
+}
+
+float ProfilerHistogram::getCpuMax()
+{
+    float m = 0;
+    for (int i = 0; i < count; i++) {
+        m = max(m, cpu[i]);
+    }
+    return m;
+}
+
+float ProfilerHistogram::getGpuMax()
+{
+    float m = -1;
+    for (int i = 0; i < count; i++) {
+        m = max(m, gpu[i]);
+    }
+    return m;
+}
+
+int ProfilerHistogram::getBin(float time)
+{
+    if (time < 32) {
+        return 0;
+    }
+    return min((int) log2f(time / 16), PROFILER_HISTOGRAM_BINS - 1);
+}
+
+float ProfilerHistogram::getBinLimit(int bin)
+{
+    return 32 * powf(2, bin);
+}
+
+Profiler & Profiler::getShared()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+{
+    enabled = false;
+    gpuTiming = false;
+    historySize = PROFILER_HISTORY;
+    frameOpen = false;
+    depth = 0;
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    if (!enabled && frameOpen) {
+        closeFrame();
+    }
+    this->enabled = enabled;
+}
+
+void Profiler::setGpuTiming(bool gpuTiming)
+{
+    this->gpuTiming = gpuTiming && hasTimerQueries();
+}
+
+void Profiler::setHistorySize(int historySize)
+{
+    this->historySize = max(historySize, 1);
+    while (frames.size() > this->historySize) {
+        frames.pop_front();
+    }
+    for (auto & h : histograms) {
+        h.setSize(this->historySize);
+    }
+}
+
+int Profiler::getStage(const string &name)
+{
+    map<string, int>::iterator it = stageIndex.find(name);
+    if (it != stageIndex.end()) {
+        return it->second;
+    }
+    stageIndex[name] = stages.size();
+    stages.push_back(name);
+    return stages.size() - 1;
+}
+
+void Profiler::push(int stage)
+{
+    unsigned long long now = ofGetElapsedTimeMicros();
+    if (!frameOpen || current.frame.number != ofGetFrameNum())
+    {
+        if (frameOpen) {
+            closeFrame();
+        }
+        current.frame.number = ofGetFrameNum();
+        current.frame.start = now;
+        current.frame.samples.clear();
+        current.queries.clear();
+        current.last = 0;
+        frameOpen = true;
+        depth = 0;
+    }
+
+    // too deep stages are balanced but not recorded
+    if (depth >= PROFILER_MAX_DEPTH)
+    {
+        depth++;
+        return;
+    }
+
+    ProfilerSample sample;
+    sample.stage = stage;
+    sample.depth = depth;
+    sample.start = now - current.frame.start;
+    sample.cpu = 0;
+    sample.gpu = -1;
+    sample.gpuStart = -1;
+    open[depth++] = current.frame.samples.size();
+    current.frame.samples.push_back(sample);
+
+    GLuint query = 0;
+    if (gpuTiming)
+    {
+        query = getQuery();
+        glQueryCounter(query, GL_TIMESTAMP);
+        current.last = query;
+    }
+    current.queries.push_back(query);
+    current.queries.push_back(0);
+}
+
+void Profiler::pop()
+{
+    if (!frameOpen || depth == 0) {
+        return;
+    }
+    if (--depth >= PROFILER_MAX_DEPTH) {
+        return;
+    }
+
+    int i = open[depth];
+    ProfilerSample &sample = current.frame.samples[i];
+    sample.cpu = (ofGetElapsedTimeMicros() - current.frame.start) - sample.start;
+
+    if (gpuTiming && current.queries[2 * i] != 0)
+    {
+        GLuint query = getQuery();
+        glQueryCounter(query, GL_TIMESTAMP);
+        current.queries[2 * i + 1] = query;
+        current.last = query;
+    }
+}
+
+void Profiler::closeFrame()
+{
+    current.frame.duration = ofGetElapsedTimeMicros() - current.frame.start;
+    pending.push_back(current);
+    frameOpen = false;
+    depth = 0;
+    collect(false);
+}
+
+void Profiler::collect(bool wait)
+{
+    while (!pending.empty())
+    {
+        PendingFrame &frame = pending.front();
+        vector<GLuint> &queries = frame.queries;
+
+        // timestamps finish in order, so the last one decides
+        if (!wait && frame.last != 0)
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(frame.last, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                break;
+            }
+        }
+
+        GLuint64 origin = 0;
+        float originStart = 0;
+        for (int i = 0; i < frame.frame.samples.size(); i++)
+        {
+            ProfilerSample &sample = frame.frame.samples[i];
+            GLuint begin = queries[2 * i];
+            GLuint end = queries[2 * i + 1];
+            if (begin != 0 && end != 0)
+            {
+                GLuint64 t0, t1;
+                glGetQueryObjectui64v(begin, GL_QUERY_RESULT, &t0);
+                glGetQueryObjectui64v(end, GL_QUERY_RESULT, &t1);
+                if (origin == 0)
+                {
+                    origin = t0;
+                    originStart = sample.start;
+                }
+                sample.gpu = (t1 - t0) / 1000.0f;
+                sample.gpuStart = originStart + (int64_t) (t0 - origin) / 1000.0f;
+            }
+            if (begin != 0) {
+                freeQueries.push_back(begin);
+            }
+            if (end != 0) {
+                freeQueries.push_back(end);
+            }
+        }
+
+        addToHistograms(frame.frame);
+        frames.push_back(frame.frame);
+        while (frames.size() > historySize) {
+            frames.pop_front();
+        }
+        pending.pop_front();
+    }
+}
+
+void Profiler::addToHistograms(const ProfilerFrame &frame)
+{
+    while (histograms.size() < stages.size())
+    {
+        histograms.push_back(ProfilerHistogram());
+        histograms.back().setSize(historySize);
+    }
+    cpuTotals.resize(stages.size());
+    gpuTotals.resize(stages.size());
+
+    // a stage may run several times a frame, it counts once with the sum
+    for (auto & s : frame.samples)
+    {
+        cpuTotals[s.stage] = 0;
+        gpuTotals[s.stage] = 0;
+    }
+    for (auto & s : frame.samples)
+    {
+        cpuTotals[s.stage] += s.cpu;
+        gpuTotals[s.stage] = (gpuTotals[s.stage] < 0 || s.gpu < 0) ? -1 : gpuTotals[s.stage] + s.gpu;
+    }
+    for (auto & s : frame.samples)
+    {
+        if (cpuTotals[s.stage] < 0)     continue;
+        histograms[s.stage].add(cpuTotals[s.stage], gpuTotals[s.stage]);
+        cpuTotals[s.stage] = -1;
+    }
+}
+
+const deque<ProfilerFrame> & Profiler::getFrames()
+{
+    collect(false);
+    return frames;
+}
+
+ProfilerHistogram & Profiler::getHistogram(int stage)
+{
+    collect(false);
+    while (histograms.size() <= stage)
+    {
+        histograms.push_back(ProfilerHistogram());
+        histograms.back().setSize(historySize);
+    }
+    return histograms[stage];
+}
+
+bool Profiler::saveTrace(string path)
+{
+    ofstream file(path.c_str());
+    if (!file.is_open())
+    {
+        ofLog(OF_LOG_ERROR, "Can't write trace to "+path);
+        return false;
+    }
+
+    // complete events on a CPU and a GPU track, times in microseconds
+    collect(false);
+    file << fixed;
+    file.precision(1);
+    file << "{\"traceEvents\": [" << endl;
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}}," << endl;
+    file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+    for (auto & f : frames)
+    {
+        file << "," << endl << "{\"name\": \"frame " << f.number << "\", \"cat\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+             << ", \"ts\": " << f.start << ", \"dur\": " << f.duration << "}";
+        for (auto & s : f.samples)
+        {
+            string name = escapeJson(stages[s.stage]);
+            file << "," << endl << "{\"name\": \"" << name << "\", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+                 << ", \"ts\": " << (double) f.start + s.start << ", \"dur\": " << s.cpu << "}";
+            if (s.gpu >= 0)
+            {
+                file << "," << endl << "{\"name\": \"" << name << "\", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": 2"
+                     << ", \"ts\": " << (double) f.start + s.gpuStart << ", \"dur\": " << s.gpu << "}";
+            }
+        }
+    }
+    file << endl << "]}" << endl;
+    return true;
+}
+
+void Profiler::flush()
+{
+    if (frameOpen) {
+        closeFrame();
+    }
+    collect(true);
+}
+
+void Profiler::clear()
+{
+    flush();
+    frames.clear();
+    for (auto & h : histograms) {
+        h.setSize(historySize);
+    }
+}
+
+GLuint Profiler::getQuery()
+{
+    if (freeQueries.empty())
+    {
+        freeQueries.resize(16);
+        glGenQueries(16, &freeQueries[0]);
+    }
+    GLuint query = freeQueries.back();
+    freeQueries.pop_back();
+    return query;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "ofMain.h"
+
+#define PROFILER_HISTORY 120        // complete frames kept by default
+#define PROFILER_MAX_DEPTH 16       // nested stages
+#define PROFILER_HISTOGRAM_BINS 16  // log2 bins of stage times
+
+
+// One stage of a frame in microseconds, start relative to the frame's
+// start. gpu is -1 without timer queries; gpuStart lines the GPU work up
+// with the frame, the first stage's starting where its CPU side did.
+
+struct ProfilerSample
+{
+    int stage;
+    int depth;
+    float start;
+    float cpu;
+    float gpu;
+    float gpuStart;
+};
+
+struct ProfilerFrame
+{
+    int number;
+    unsigned long long start;
+    float duration;
+    vector<ProfilerSample> samples;
+};
+
+
+// Rolling distribution of a stage's total time per frame over the last
+// frames it ran in. Bin 0 is below 32 us and every next bin is twice as
+// wide as the last.
+
+class ProfilerHistogram
+{
+public:
+    ProfilerHistogram();
+
+    void setSize(int size);
+    void add(float cpu, float gpu);
+
+    int getCount() {return count;}
+    float getCpuMean() {return count == 0 ? 0 : cpuSum / count;}
+    float getGpuMean() {return gpuCount == 0 ? -1 : gpuSum / gpuCount;}
+    float getCpuMax();
+    float getGpuMax();
+    int getCpuBin(int bin) {return cpuBins[bin];}
+    int getGpuBin(int bin) {return gpuBins[bin];}
+
+    static int getBin(float time);
+    static float getBinLimit(int bin);
+
+private:
+
+    vector<float> cpu, gpu;
+    int next, count, gpuCount;
+    double cpuSum, gpuSum;
+    int cpuBins[PROFILER_HISTOGRAM_BINS];
+    int gpuBins[PROFILER_HISTOGRAM_BINS];
+};
+
+
+// Per-stage timings of whole frames. begin and end bracket a stage on the
+// render thread and may nest; the first stage of a new ofGetFrameNum
+// closes the last frame. With GPU timing each stage also gets a pair of GL
+// timestamp queries which are read back frames later, when ready, so the
+// CPU never waits on them; a frame is complete once they are in, and goes
+// to the history and the stage histograms. The history can be saved in
+// Chrome's trace event format, for chrome://tracing or Perfetto. While
+// disabled, begin and end return straight away.
+
+class Profiler
+{
+public:
+    Profiler();
+
+    // the one Canvas and Scene report to
+    static Profiler & getShared();
+
+    void setEnabled(bool enabled);
+    bool getEnabled() {return enabled;}
+
+    // only has an effect where GL timer queries are supported
+    void setGpuTiming(bool gpuTiming);
+    bool getGpuTiming() {return gpuTiming;}
+
+    void setHistorySize(int historySize);
+
+    int getStage(const string &name);
+    const string & getStageName(int stage) {return stages[stage];}
+    int getNumStages() {return stages.size();}
+
+    void begin(int stage) {if (enabled) push(stage);}
+    void begin(const string &name) {if (enabled) push(getStage(name));}
+    void end() {if (enabled) pop();}
+
+    // complete frames, oldest first
+    const deque<ProfilerFrame> & getFrames();
+    ProfilerHistogram & getHistogram(int stage);
+
+    bool saveTrace(string path);
+
+    // close the current frame and wait for all outstanding GPU timings
+    void flush();
+    void clear();
+
+private:
+
+    struct PendingFrame
+    {
+        ProfilerFrame frame;
+        vector<GLuint> queries;     // begin and end of each sample
+        GLuint last;                // issued last
+    };
+
+    void push(int stage);
+    void pop();
+    void closeFrame();
+    void collect(bool wait);
+    void addToHistograms(const ProfilerFrame &frame);
+    GLuint getQuery();
+
+    bool enabled;
+    bool gpuTiming;
+    int historySize;
+
+    vector<string> stages;
+    map<string, int> stageIndex;
+
+    bool frameOpen;
+    PendingFrame current;
+    int open[PROFILER_MAX_DEPTH];
+    int depth;
+
+    deque<PendingFrame> pending;
+    deque<ProfilerFrame> frames;
+    vector<ProfilerHistogram> histograms;
+    vector<float> cpuTotals, gpuTotals;
+    vector<GLuint> freeQueries;
+};
+
+
+// Times the enclosing block.
+
+class ProfilerScope
+{
+public:
+    ProfilerScope(int stage) {Profiler::getShared().begin(stage);}
+    ProfilerScope(const string &name) {Profiler::getShared().begin(name);}
+    ~ProfilerScope() {Profiler::getShared().end();}
+};
@@ -1,21 +1,15 @@
 #include "Subdivision.h"
 
 
-void SubdividingPolygon::setup(vector<ofPoint> points, ofColor color)
+void SubdividingPolygon::setup(const vector<ofPoint> &points, ofColor color)
 {
-    this->points = points;
-    pointDist.resize(points.size());
-    totalDist = 0;
-    for (int i=0; i<points.size(); i++)
-    {
-        float d = ofDist(points[i].x, points[i].y, points[(i+1)%points.size()].x, points[(i+1)%points.size()].y);
-        pointDist[i] = d;
-        totalDist += d;
-    }
-    this->color = color;
+    nodes.clear();
+    vertices.assign(points.begin(), points.end());
+    addNode(0, points.size(), color);
+    setupMesh();
 }
 
-ofColor SubdividingPolygon::perturbColor(float dr, float dg, float db)
+ofColor SubdividingPolygon::perturbColor(ofColor color, float dr, float dg, float db)
 {
     return ofColor((int) (color.r + ofRandom(-dr, dr)) % 255,
                    (int) (color.g + ofRandom(-dg, dg)) % 255,
@@ -23,10 +17,33 @@ ofColor SubdividingPolygon::perturbColor(float dr, float dg, float db)
 }
 
 void SubdividingPolygon::subdivide(int n)
+{
+    // regenerate from the root outline
+    if (nodes.empty()) return;
+    Node root = nodes[0];
+    root.child1 = root.child2 = -1;
+    nodes.clear();
+    nodes.push_back(root);
+    vertices.resize(root.count);
+    subdivide(0, n);
+    setupMesh();
+}
+
+void SubdividingPolygon::subdivide(int node, int n)
 {
     if (n==0)   return;
     
-    vector<ofPoint> points1, points2;
+    int first = nodes[node].first;
+    int count = nodes[node].count;
+    
+    pointDist.resize(count);
+    float totalDist = 0;
+    for (int i=0; i<count; i++)
+    {
+        const ofPoint &p = vertices[first + i], &q = vertices[first + (i+1)%count];
+        pointDist[i] = ofDist(p.x, p.y, q.x, q.y);
+        totalDist += pointDist[i];
+    }
     
     float r1=0;
     float r2=0;
@@ -39,77 +56,101 @@ void SubdividingPolygon::subdivide(int n)
     float div1 = min(r1, r2) * totalDist;
     float div2 = max(r1, r2) * totalDist;
     
+    // find the two cut points, then write both halves after the existing outlines
+    int i1 = -1, i2 = -1;
+    ofPoint sub1, sub2;
     float currDist = 0;
-    int section = 0;
-    for (int i=0; i<points.size(); i++)
+    for (int i=0; i<count && i2 == -1; i++)
     {
-        if (section == 0)
+        const ofPoint &p = vertices[first + i], &q = vertices[first + (i+1)%count];
+        if (i1 == -1 && currDist + pointDist[i] > div1)
         {
-            points1.push_back(points[i]);
-            if (currDist + pointDist[i] > div1)
-            {
-                section = 1;
-                float r = (div1 - currDist) / pointDist[i];
-                ofPoint subPoint = ofPoint(ofLerp(points[i].x, points[(i+1)%points.size()].x, r),
-                                           ofLerp(points[i].y, points[(i+1)%points.size()].y, r));
-                points1.push_back(subPoint);
-                points2.push_back(subPoint);
-            }
+            float r = (div1 - currDist) / pointDist[i];
+            sub1.set(ofLerp(p.x, q.x, r), ofLerp(p.y, q.y, r));
+            i1 = i;
         }
-        else if (section == 1)
+        if (i1 != -1 && currDist + pointDist[i] > div2)
         {
-            points2.push_back(points[i]);
-            if (currDist + pointDist[i] > div2)
-            {
-                section = 2;
-                float r = (div2 - currDist) / pointDist[i];
-                ofPoint subPoint = ofPoint(ofLerp(points[i].x, points[(i+1)%points.size()].x, r),
-                                           ofLerp(points[i].y, points[(i+1)%points.size()].y, r));
-                points1.push_back(subPoint);
-                points2.push_back(subPoint);
-                
-            }
-        }
-        else if (section == 2) {
-            points1.push_back(points[i]);
+            float r = (div2 - currDist) / pointDist[i];
+            sub2.set(ofLerp(p.x, q.x, r), ofLerp(p.y, q.y, r));
+            i2 = i;
         }
         currDist += pointDist[i];
     }
+    if (i2 == -1) return;
+
+    // first half: 0..i1, sub1, sub2, i2+1..end
+    int first1 = vertices.size();
+    for (int i=0; i<=i1; i++) {
+        vertices.push_back(vertices[first + i]);
+    }
+    vertices.push_back(sub1);
+    vertices.push_back(sub2);
+    for (int i=i2+1; i<count; i++) {
+        vertices.push_back(vertices[first + i]);
+    }
+    int count1 = vertices.size() - first1;
+    
+    // second half: sub1, i1+1..i2, sub2
+    int first2 = vertices.size();
+    vertices.push_back(sub1);
+    for (int i=i1+1; i<=i2; i++) {
+        vertices.push_back(vertices[first + i]);
+    }
+    vertices.push_back(sub2);
+    int count2 = vertices.size() - first2;
     
-    if (points1.size() > 2)
+    if (count1 > 2)
     {
-        ofColor color1 = perturbColor(24, 24, 24);
-        SubdividingPolygon *p1 = new SubdividingPolygon();
-        p1->setup(points1, color1);
-        p1->subdivide(n-1);
-        children.push_back(p1);
+        int child = addNode(first1, count1, perturbColor(nodes[node].color, 24, 24, 24));
+        nodes[node].child1 = child;
+        subdivide(child, n-1);
     }
-    if (points2.size() > 2)
+    if (count2 > 2)
     {
-        ofColor color2 = perturbColor(24, 24, 24);
-        SubdividingPolygon *p2 = new SubdividingPolygon();
-        p2->setup(points2, color2);
-        p2->subdivide(n-1);
-        children.push_back(p2);
+        int child = addNode(first2, count2, perturbColor(nodes[node].color, 24, 24, 24));
+        nodes[node].child2 = child;
+        subdivide(child, n-1);
     }
 }
 
-void SubdividingPolygon::draw()
+int SubdividingPolygon::addNode(int first, int count, ofColor color)
 {
-    if (children.size() > 0)
+    Node node;
+    node.first = first;
+    node.count = count;
+    node.child1 = node.child2 = -1;
+    node.color = color;
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+void SubdividingPolygon::setupMesh()
+{
+    // leaves are convex pieces of the root, so a fan per leaf covers them
+    mesh.clear();
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    for (int i=0; i<nodes.size(); i++)
     {
-        for (int i=0; i<children.size(); i++) {
-            children[i]->draw();
+        const Node &node = nodes[i];
+        if (node.child1 != -1 || node.child2 != -1) continue;
+        int base = mesh.getNumVertices();
+        for (int j=0; j<node.count; j++)
+        {
+            mesh.addVertex(vertices[node.first + j]);
+            mesh.addColor(node.color);
         }
-    }
-    else
-    {
-        ofSetColor(color);
-        ofFill();
-        ofBeginShape();
-        for (int i=0; i<points.size(); i++) {
-            ofVertex(points[i].x, points[i].y);
+        for (int j=1; j+1<node.count; j++)
+        {
+            mesh.addIndex(base);
+            mesh.addIndex(base + j);
+            mesh.addIndex(base + j + 1);
         }
-        ofEndShape(close);
     }
 }
+
+void SubdividingPolygon::draw()
+{
+    ofSetColor(255);
+    mesh.draw();
+}
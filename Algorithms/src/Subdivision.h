@@ -3,18 +3,37 @@
 #include "ofMain.h"
 
 
+// A polygon split recursively along random chords. The tree lives in one
+// node array, children linked by index, and every node's outline is a run
+// in one shared vertex array, so regenerating just clears both. The leaves
+// are triangulated into a single mesh for drawing.
+
 class SubdividingPolygon
 {
 public:
-    void setup(vector<ofPoint> points, ofColor color);
-    ofColor perturbColor(float dr, float dg, float db);
+    void setup(const vector<ofPoint> &points, ofColor color);
     void subdivide(int n);
     void draw();
     
+    int getNumNodes() {return nodes.size();}
+    const ofMesh & getMesh() {return mesh;}
+    
 private:
-    vector<ofPoint> points;
-    vector<SubdividingPolygon *> children;
-    float totalDist;
+    
+    struct Node
+    {
+        int first, count;       // outline in vertices
+        int child1, child2;     // -1 for none
+        ofColor color;
+    };
+    
+    ofColor perturbColor(ofColor color, float dr, float dg, float db);
+    void subdivide(int node, int n);
+    int addNode(int first, int count, ofColor color);
+    void setupMesh();
+    
+    vector<Node> nodes;
+    vector<ofPoint> vertices;
     vector<float> pointDist;
-    ofColor color;
+    ofVboMesh mesh;
 };
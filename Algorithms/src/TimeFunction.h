@@ -1,248 +1,176 @@
 #pragma once
 
 #include "ofMain.h"
+#include "TimeFunctionBank.h"
 
 
+// One function of a TimeFunctionBank. Standalone instances live in a bank
+// shared by all TimeFunctions of the same type and update mode, so the
+// auto-updating ones advance together on a single listener; the bank
+// constructor gives a view into a function of an existing bank instead.
+
 template <typename T>
 class TimeFunction
 {
 public:
     TimeFunction(bool autoUpdate)
     {
+        bank = NULL;
         setup(autoUpdate);
     }
-    
+
     TimeFunction()
     {
+        bank = NULL;
         setup(true);
     }
-    
+
+    TimeFunction(TimeFunctionBank<T> *bank, int index)
+    {
+        this->bank = bank;
+        this->index = index;
+        shared = false;
+    }
+
     ~TimeFunction()
     {
-        setAutoUpdate(false);
+        release();
     }
-    
+
     void setup(bool autoUpdate)
     {
-        setAutoUpdate(autoUpdate);
-        noiseOffset = ofVec3f(ofRandom(100), ofRandom(100), ofRandom(100));
-        sinePhase = ofVec3f(ofRandom(TWO_PI), ofRandom(TWO_PI), ofRandom(TWO_PI));
-        delTime = 1.0;
-        reset();
+        release();
+        bank = &TimeFunctionBank<T>::getShared(autoUpdate);
+        index = bank->add();
+        shared = true;
     }
-    
+
+    // a view changes the update mode of its whole bank
     void setAutoUpdate(bool autoUpdate)
     {
-        this->autoUpdate = autoUpdate;
-        if (autoUpdate) {
-            ofAddListener(ofEvents().update, this, &TimeFunction::update);
-        }
-        else {
-            ofRemoveListener(ofEvents().update, this, &TimeFunction::update);
+        if (!shared)
+        {
+            bank->setAutoUpdate(autoUpdate);
+            return;
         }
+        if (autoUpdate == bank->getAutoUpdate()) return;
+        TimeFunctionBank<T> *target = &TimeFunctionBank<T>::getShared(autoUpdate);
+        int targetIndex = target->add();
+        target->copy(targetIndex, *bank, index);
+        bank->remove(index);
+        bank = target;
+        index = targetIndex;
     }
-    
-    void reset();
-    
+
+    void reset() { bank->reset(index); }
+
+    TimeFunctionBank<T> * getBank() { return bank; }
+    int getIndex() { return index; }
+
     /* getters */
-    T getConstant() { return constant; }
-    T getTimeCoefficient() { return timeCoefficient; }
-	T getRandMin() { return randMin; }
-	T getRandMax() { return randMax; }
-	T getNoiseMin() { return noiseMin; }
-	T getNoiseMax() { return noiseMax; }
-	T getNoiseSpeed() { return noiseSpeed; }
-	ofVec3f getNoiseOffset() { return noiseOffset; }
-	T getSineMin() { return sineMin; }
-	T getSineMax() { return sineMax; }
-	T getSineFreq() { return sineFreq; }
-	ofVec3f getSinePhase() { return sinePhase; }
-	T getDelTime() { return delTime; }
-	
-	/* reference getters */
-    T & getConstantRef() { return constant; }
-    T & getTimeCoefficientRef() { return timeCoefficient; }
-    T & getRandMinRef() { return randMin; }
-    T & getRandMaxRef() { return randMax; }
-    T & getNoiseMinRef() { return noiseMin; }
-    T & getNoiseMaxRef() { return noiseMax; }
-    T & getNoiseSpeedRef() { return noiseSpeed; }
-    ofVec3f & getNoiseOffsetRef() { return noiseOffset; }
-    T & getSineMinRef() { return sineMin; }
-    T & getSineMaxRef() { return sineMax; }
-    T & getSineFreqRef() { return sineFreq; }
-    ofVec3f & getSinePhaseRef() { return sinePhase; }
-    T & getDelTimeRef() { return delTime; }
-    
+    T getConstant() { return bank->get(TIMEFUNCTION_CONSTANT, index); }
+    T getTimeCoefficient() { return bank->get(TIMEFUNCTION_TIME_COEFFICIENT, index); }
+	T getRandMin() { return bank->get(TIMEFUNCTION_RAND_MIN, index); }
+	T getRandMax() { return bank->get(TIMEFUNCTION_RAND_MAX, index); }
+	T getNoiseMin() { return bank->get(TIMEFUNCTION_NOISE_MIN, index); }
+	T getNoiseMax() { return bank->get(TIMEFUNCTION_NOISE_MAX, index); }
+	T getNoiseSpeed() { return bank->get(TIMEFUNCTION_NOISE_SPEED, index); }
+	ofVec3f getNoiseOffset() { return bank->getOffset(TIMEFUNCTION_NOISE_OFFSET, index); }
+	T getSineMin() { return bank->get(TIMEFUNCTION_SINE_MIN, index); }
+	T getSineMax() { return bank->get(TIMEFUNCTION_SINE_MAX, index); }
+	T getSineFreq() { return bank->get(TIMEFUNCTION_SINE_FREQ, index); }
+	ofVec3f getSinePhase() { return bank->getOffset(TIMEFUNCTION_SINE_PHASE, index); }
+	float getDelTime() { return bank->getDelTime(index); }
+
+	/* reference getters, valid until functions are added to the bank */
+    T & getConstantRef() { return bank->getRef(TIMEFUNCTION_CONSTANT, index); }
+    T & getTimeCoefficientRef() { return bank->getRef(TIMEFUNCTION_TIME_COEFFICIENT, index); }
+    T & getRandMinRef() { return bank->getRef(TIMEFUNCTION_RAND_MIN, index); }
+    T & getRandMaxRef() { return bank->getRef(TIMEFUNCTION_RAND_MAX, index); }
+    T & getNoiseMinRef() { return bank->getRef(TIMEFUNCTION_NOISE_MIN, index); }
+    T & getNoiseMaxRef() { return bank->getRef(TIMEFUNCTION_NOISE_MAX, index); }
+    T & getNoiseSpeedRef() { return bank->getRef(TIMEFUNCTION_NOISE_SPEED, index); }
+    T & getSineMinRef() { return bank->getRef(TIMEFUNCTION_SINE_MIN, index); }
+    T & getSineMaxRef() { return bank->getRef(TIMEFUNCTION_SINE_MAX, index); }
+    T & getSineFreqRef() { return bank->getRef(TIMEFUNCTION_SINE_FREQ, index); }
+    float & getDelTimeRef() { return bank->getDelTimeRef(index); }
+
     /* setters */
-	void setConstant(T z) { this->constant = z; }
-	void setTimeCoefficient(T z) { this->timeCoefficient = z; }
-	void setRandMin(T z) { this->randMin = z; }
-	void setRandMax(T z) { this->randMax = z; }
-	void setNoiseMin(T z) { this->noiseMin = z; }
-	void setNoiseMax(T z) { this->noiseMax = z; }
-	void setNoiseSpeed(T z) { this->noiseSpeed = z; }
-	void setNoiseOffset(ofVec3f z) { this->noiseOffset = z; }
-	void setSineMin(T z) { this->sineMin = z; }
-	void setSineMax(T z) { this->sineMax = z; }
-	void setSineFreq(T z) { this->sineFreq = z; }
-	void setSinePhase(ofVec3f z) { this->sinePhase = z; }
-	void setTime(T z) { this->time = z; }
-	void setDelTime(float z) { this->delTime = z; }
-    
+	void setConstant(T z) { bank->set(TIMEFUNCTION_CONSTANT, index, z); }
+	void setTimeCoefficient(T z) { bank->set(TIMEFUNCTION_TIME_COEFFICIENT, index, z); }
+	void setRandMin(T z) { bank->set(TIMEFUNCTION_RAND_MIN, index, z); }
+	void setRandMax(T z) { bank->set(TIMEFUNCTION_RAND_MAX, index, z); }
+	void setNoiseMin(T z) { bank->set(TIMEFUNCTION_NOISE_MIN, index, z); }
+	void setNoiseMax(T z) { bank->set(TIMEFUNCTION_NOISE_MAX, index, z); }
+	void setNoiseSpeed(T z) { bank->set(TIMEFUNCTION_NOISE_SPEED, index, z); }
+	void setNoiseOffset(ofVec3f z) { bank->setOffset(TIMEFUNCTION_NOISE_OFFSET, index, z); }
+	void setSineMin(T z) { bank->set(TIMEFUNCTION_SINE_MIN, index, z); }
+	void setSineMax(T z) { bank->set(TIMEFUNCTION_SINE_MAX, index, z); }
+	void setSineFreq(T z) { bank->set(TIMEFUNCTION_SINE_FREQ, index, z); }
+	void setSinePhase(ofVec3f z) { bank->setOffset(TIMEFUNCTION_SINE_PHASE, index, z); }
+	void setTime(T z) { bank->set(TIMEFUNCTION_TIME_FACTOR, index, z); }
+	void setDelTime(float z) { bank->setDelTime(index, z); }
+
     /* main function setters */
 	void setFunctionRandom(T randMin, T randMax)
     {
-	    this->randMin = randMin;
-	    this->randMax = randMax;
+	    setRandMin(randMin);
+	    setRandMax(randMax);
 	}
-	
+
     void setFunctionNoise(T noiseMin, T noiseMax, T noiseSpeed, ofVec3f noiseOffset)
     {
-	    this->noiseMin = noiseMin;
-	    this->noiseMax = noiseMax;
-	    this->noiseSpeed = noiseSpeed;
-	    this->noiseOffset = noiseOffset;
+	    setNoiseMin(noiseMin);
+	    setNoiseMax(noiseMax);
+	    setNoiseSpeed(noiseSpeed);
+	    setNoiseOffset(noiseOffset);
 	}
-	
+
     void setFunctionNoise(T noiseMin, T noiseMax, T noiseSpeed)
     {
         setFunctionNoise(noiseMin, noiseMax, noiseSpeed,
                          ofVec3f(ofRandom(100), ofRandom(100), ofRandom(100)));
     }
-	
+
     void setFunctionSine(T sineMin, T sineMax, T sineFreq, ofVec3f sinePhase)
     {
-	    this->sineMin = sineMin;
-	    this->sineMax = sineMax;
-	    this->sineFreq = sineFreq;
-	    this->sinePhase = sinePhase;
+	    setSineMin(sineMin);
+	    setSineMax(sineMax);
+	    setSineFreq(sineFreq);
+	    setSinePhase(sinePhase);
 	}
-    
+
     void setFunctionSine(T sineMin, T sineMax, T sineFreq)
     {
         setFunctionSine(sineMin, sineMax, sineFreq,
                         ofVec3f(ofRandom(TWO_PI), ofRandom(TWO_PI), ofRandom(TWO_PI)));
     }
-    
+
     /* update time factors */
-    void update()
-    {
-        timeFactor += (delTime * timeCoefficient);
-        noiseFactor += (delTime * noiseSpeed);
-        sineFactor += (delTime * sineFreq);
-    }
-    
+    void update() { bank->update(index); }
+
     /* sample current value */
-    T getRef() { return &value; }
-    T get();
-    
-private:
-    
-    void update(ofEventArgs &data)
+    T & getRef() { return bank->getRef(TIMEFUNCTION_VALUE, index); }
+    T get()
     {
-        update();
+        bank->evaluate(index);
+        return bank->getValue(index);
     }
-    
-    T constant;
-    T timeCoefficient;
-    T randMin, randMax;
-    T noiseMin, noiseMax, noiseSpeed;
-    T sineMin, sineMax, sineFreq;
-    T value;
- 	float delTime;
-    ofVec3f noiseOffset, sinePhase;
-    
-    T noiseFactor;
-    T sineFactor;
-    T timeFactor;
-    
-    bool autoUpdate;
-};
 
+private:
 
-template<> inline void TimeFunction<int>::reset()
-{
-    setConstant(0);
-    setTimeCoefficient(0);
-    setFunctionNoise(0, 0, 0);
-    setFunctionRandom(0, 0);
-    setFunctionSine(0, 0, 0);
-}
-template<> inline void TimeFunction<float>::reset()
-{
-    setConstant(0.0);
-    setTimeCoefficient(0.0);
-    setFunctionNoise(0.0, 0.0, 0.0);
-    setFunctionRandom(0.0, 0.0);
-    setFunctionSine(0.0, 0.0, 0.0);
-}
-template<> inline void TimeFunction<ofVec3f>::reset()
-{
-    setConstant(ofVec3f(0, 0, 0));
-    setTimeCoefficient(ofVec3f(0, 0, 0));
-    setFunctionNoise(ofVec3f(0, 0, 0), ofVec3f(0, 0, 0), ofVec3f(0, 0, 0));
-    setFunctionRandom(ofVec3f(0, 0, 0), ofVec3f(0, 0, 0));
-    setFunctionSine(ofVec3f(0, 0, 0), ofVec3f(0, 0, 0), ofVec3f(0, 0, 0));
-}
-template<> inline void TimeFunction<ofVec2f>::reset()
-{
-    setConstant(ofVec2f(0, 0));
-    setTimeCoefficient(ofVec2f(0, 0));
-    setFunctionNoise(ofVec2f(0, 0), ofVec2f(0, 0), ofVec2f(0, 0));
-    setFunctionRandom(ofVec2f(0, 0), ofVec2f(0, 0));
-    setFunctionSine(ofVec2f(0, 0), ofVec2f(0, 0), ofVec2f(0, 0));
-}
+    TimeFunction(const TimeFunction &) = delete;
+    TimeFunction & operator=(const TimeFunction &) = delete;
 
+    void release()
+    {
+        if (bank != NULL && shared) {
+            bank->remove(index);
+        }
+        bank = NULL;
+    }
 
-template<> inline int TimeFunction<int>::get()
-{
-    value = constant +
-              timeFactor +
-              ofRandom(randMin, randMax) +
-              ofMap(ofNoise(noiseFactor, noiseOffset.x), 0, 1, noiseMin, noiseMax) +
-              ofMap(sin(sineFactor + sinePhase.x), -1, 1, sineMin, sineMax) ;
-    return value;
-}
-
-template<> inline float TimeFunction<float>::get()
-{
-    value = constant +
-              timeFactor +
-              ofRandom(randMin, randMax) +
-              ofMap(ofNoise(noiseFactor, noiseOffset.x), 0, 1, noiseMin, noiseMax) +
-              ofMap(sin(sineFactor + sinePhase.x), -1, 1, sineMin, sineMax) ;
-    return value;
-}
-
-template<> inline ofVec3f TimeFunction<ofVec3f>::get()
-{
-    value.set(constant +
-              ofVec3f(timeFactor.x,
-                      timeFactor.y,
-                      timeFactor.z) +
-              ofVec3f(ofRandom(randMin.x, randMax.x),
-                      ofRandom(randMin.y, randMax.y),
-                      ofRandom(randMin.z, randMax.z)) +
-              ofVec3f(ofMap(ofNoise(noiseFactor.x, noiseOffset.x), 0, 1, noiseMin.x, noiseMax.x),
-                      ofMap(ofNoise(noiseFactor.y, noiseOffset.y), 0, 1, noiseMin.y, noiseMax.y),
-                      ofMap(ofNoise(noiseFactor.z, noiseOffset.z), 0, 1, noiseMin.z, noiseMax.z)) +
-              ofVec3f(ofMap(sin(sineFactor.x + sinePhase.x), -1, 1, sineMin.x, sineMax.x),
-                      ofMap(sin(sineFactor.y + sinePhase.y), -1, 1, sineMin.y, sineMax.y),
-                      ofMap(sin(sineFactor.z + sinePhase.z), -1, 1, sineMin.z, sineMax.z)) );
-    return value;
-}
-
-template<> inline ofVec2f TimeFunction<ofVec2f>::get()
-{
-    value.set(constant +
-              ofVec2f(timeFactor.x,
-                      timeFactor.y) +
-              ofVec2f(ofRandom(randMin.x, randMax.x),
-                      ofRandom(randMin.y, randMax.y))+
-              ofVec2f(ofMap(ofNoise(noiseFactor.x, noiseOffset.x), 0, 1, noiseMin.x, noiseMax.x),
-                      ofMap(ofNoise(noiseFactor.y, noiseOffset.y), 0, 1, noiseMin.y, noiseMax.y))+
-              ofVec2f(ofMap(sin(sineFactor.x + sinePhase.x), -1, 1, sineMin.x, sineMax.x),
-                      ofMap(sin(sineFactor.y + sinePhase.y), -1, 1, sineMin.y, sineMax.y)) );
-    return value;
-}
+    TimeFunctionBank<T> *bank;
+    int index;
+    bool shared;
+};
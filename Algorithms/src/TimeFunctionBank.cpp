@@ -0,0 +1,269 @@
+#include "TimeFunctionBank.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+#if defined(__SSE2__)
+
+// Cephes sinf: reduce to [-pi/4, pi/4] by multiples of pi/4, then the sine
+// or cosine polynomial depending on the octant
+static inline __m128 sin4(__m128 x)
+{
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    __m128 sign = _mm_and_ps(x, signMask);
+    x = _mm_andnot_ps(signMask, x);
+
+    __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+    j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+    __m128 y = _mm_cvtepi32_ps(j);
+    sign = _mm_xor_ps(sign, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29)));
+    __m128 useSine = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+    __m128 z = _mm_mul_ps(x, x);
+
+    __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), z), _mm_set1_ps(-1.388731625493765e-3f));
+    c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+    c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), z), _mm_set1_ps(8.3321608736e-3f));
+    s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+    __m128 r = _mm_or_ps(_mm_and_ps(useSine, s), _mm_andnot_ps(useSine, c));
+    return _mm_xor_ps(r, sign);
+}
+
+#endif
+
+TimeFunctionBankBase::TimeFunctionBankBase(int dimensions, bool autoUpdate)
+{
+    this->dimensions = dimensions;
+    numFunctions = 0;
+    this->autoUpdate = false;
+    random.setSeed(ofRandom(1, 2147483647.0f));
+    setAutoUpdate(autoUpdate);
+}
+
+TimeFunctionBankBase::~TimeFunctionBankBase()
+{
+    setAutoUpdate(false);
+}
+
+void TimeFunctionBankBase::setAutoUpdate(bool autoUpdate)
+{
+    if (autoUpdate == this->autoUpdate) return;
+    this->autoUpdate = autoUpdate;
+    if (autoUpdate) {
+        ofAddListener(ofEvents().update, this, &TimeFunctionBankBase::update);
+    }
+    else {
+        ofRemoveListener(ofEvents().update, this, &TimeFunctionBankBase::update);
+    }
+}
+
+int TimeFunctionBankBase::add()
+{
+    int i;
+    if (!removed.empty())
+    {
+        i = removed.back();
+        removed.pop_back();
+        reset(i);
+    }
+    else
+    {
+        i = numFunctions;
+        resize(numFunctions + 1);
+    }
+    fill(&data[TIMEFUNCTION_TIME_FACTOR][i * dimensions], &data[TIMEFUNCTION_TIME_FACTOR][i * dimensions] + dimensions, 0.0f);
+    fill(&data[TIMEFUNCTION_NOISE_FACTOR][i * dimensions], &data[TIMEFUNCTION_NOISE_FACTOR][i * dimensions] + dimensions, 0.0f);
+    fill(&data[TIMEFUNCTION_SINE_FACTOR][i * dimensions], &data[TIMEFUNCTION_SINE_FACTOR][i * dimensions] + dimensions, 0.0f);
+    delTimes[i] = 1.0;
+    return i;
+}
+
+void TimeFunctionBankBase::remove(int i)
+{
+    // kept in the arrays, but constant zero until reused
+    for (int p = 0; p < TIMEFUNCTION_NUM_PARAMETERS; p++) {
+        fill(&data[p][i * dimensions], &data[p][i * dimensions] + dimensions, 0.0f);
+    }
+    delTimes[i] = 0.0;
+    removed.push_back(i);
+}
+
+void TimeFunctionBankBase::resize(int n)
+{
+    int previous = numFunctions;
+    numFunctions = max(n, 0);
+    for (int p = 0; p < TIMEFUNCTION_NUM_PARAMETERS; p++) {
+        data[p].resize(numFunctions * dimensions, 0.0f);
+    }
+    delTimes.resize(numFunctions, 1.0f);
+    for (int i = previous; i < numFunctions; i++) {
+        reset(i);
+    }
+    removed.erase(std::remove_if(removed.begin(), removed.end(), [n](int i) { return i >= n; }), removed.end());
+}
+
+void TimeFunctionBankBase::reset(int i)
+{
+    const TimeFunctionParameter zeroed[] = {
+        TIMEFUNCTION_CONSTANT, TIMEFUNCTION_TIME_COEFFICIENT, TIMEFUNCTION_RAND_MIN, TIMEFUNCTION_RAND_MAX,
+        TIMEFUNCTION_NOISE_MIN, TIMEFUNCTION_NOISE_MAX, TIMEFUNCTION_NOISE_SPEED,
+        TIMEFUNCTION_SINE_MIN, TIMEFUNCTION_SINE_MAX, TIMEFUNCTION_SINE_FREQ};
+    for (int p = 0; p < sizeof(zeroed) / sizeof(zeroed[0]); p++) {
+        fill(&data[zeroed[p]][i * dimensions], &data[zeroed[p]][i * dimensions] + dimensions, 0.0f);
+    }
+    setOffset(TIMEFUNCTION_NOISE_OFFSET, i, ofVec3f(ofRandom(100), ofRandom(100), ofRandom(100)));
+    setOffset(TIMEFUNCTION_SINE_PHASE, i, ofVec3f(ofRandom(TWO_PI), ofRandom(TWO_PI), ofRandom(TWO_PI)));
+}
+
+void TimeFunctionBankBase::copy(int i, TimeFunctionBankBase &source, int j)
+{
+    for (int p = 0; p < TIMEFUNCTION_NUM_PARAMETERS; p++) {
+        std::copy(&source.data[p][j * dimensions], &source.data[p][j * dimensions] + dimensions, &data[p][i * dimensions]);
+    }
+    delTimes[i] = source.delTimes[j];
+}
+
+void TimeFunctionBankBase::setDelTime(float delTime)
+{
+    fill(delTimes.begin(), delTimes.end(), delTime);
+}
+
+ofVec3f TimeFunctionBankBase::getOffset(TimeFunctionParameter p, int i)
+{
+    ofVec3f offset;
+    for (int c = 0; c < dimensions; c++) {
+        offset[c] = data[p][i * dimensions + c];
+    }
+    return offset;
+}
+
+void TimeFunctionBankBase::setOffset(TimeFunctionParameter p, int i, const ofVec3f &offset)
+{
+    for (int c = 0; c < dimensions; c++) {
+        data[p][i * dimensions + c] = offset[c];
+    }
+}
+
+void TimeFunctionBankBase::update(ofEventArgs &args)
+{
+    update();
+}
+
+void TimeFunctionBankBase::update()
+{
+    for (int i = 0; i < numFunctions; i++) {
+        update(i);
+    }
+}
+
+void TimeFunctionBankBase::update(int i)
+{
+    float *time = &data[TIMEFUNCTION_TIME_FACTOR][i * dimensions];
+    float *noise = &data[TIMEFUNCTION_NOISE_FACTOR][i * dimensions];
+    float *sine = &data[TIMEFUNCTION_SINE_FACTOR][i * dimensions];
+    const float *timeCoefficient = &data[TIMEFUNCTION_TIME_COEFFICIENT][i * dimensions];
+    const float *noiseSpeed = &data[TIMEFUNCTION_NOISE_SPEED][i * dimensions];
+    const float *sineFreq = &data[TIMEFUNCTION_SINE_FREQ][i * dimensions];
+    for (int c = 0; c < dimensions; c++)
+    {
+        time[c] += delTimes[i] * timeCoefficient[c];
+        noise[c] += delTimes[i] * noiseSpeed[c];
+        sine[c] += delTimes[i] * sineFreq[c];
+
+        // keep the sine argument within a period so it keeps its precision over a long show
+        if (abs(sine[c]) > TWO_PI) {
+            sine[c] = fmod(sine[c], (float) TWO_PI);
+        }
+    }
+}
+
+void TimeFunctionBankBase::evaluate()
+{
+    int n = numFunctions * dimensions;
+    if (n == 0) return;
+    randoms.resize(n);
+    noises.resize(n);
+    sines.resize(n);
+    for (int k = 0; k < n; k++) {
+        randoms[k] = random.random(1.0f);
+    }
+    Noise::noise(n, &data[TIMEFUNCTION_NOISE_FACTOR][0], &data[TIMEFUNCTION_NOISE_OFFSET][0], &noises[0]);
+
+    const float *sineFactor = &data[TIMEFUNCTION_SINE_FACTOR][0];
+    const float *sinePhase = &data[TIMEFUNCTION_SINE_PHASE][0];
+    int k = 0;
+#if defined(__SSE2__)
+    for (; k + 4 <= n; k += 4) {
+        _mm_storeu_ps(&sines[k], sin4(_mm_add_ps(_mm_loadu_ps(sineFactor + k), _mm_loadu_ps(sinePhase + k))));
+    }
+#endif
+    for (; k < n; k++) {
+        sines[k] = sin(sineFactor[k] + sinePhase[k]);
+    }
+    combine(0, n);
+}
+
+void TimeFunctionBankBase::evaluate(int i)
+{
+    int first = i * dimensions;
+    randoms.resize(max((int) randoms.size(), first + dimensions));
+    noises.resize(randoms.size());
+    sines.resize(randoms.size());
+    for (int k = first; k < first + dimensions; k++)
+    {
+        randoms[k] = random.random(1.0f);
+        sines[k] = sin(data[TIMEFUNCTION_SINE_FACTOR][k] + data[TIMEFUNCTION_SINE_PHASE][k]);
+    }
+    Noise::noise(dimensions, &data[TIMEFUNCTION_NOISE_FACTOR][first], &data[TIMEFUNCTION_NOISE_OFFSET][first], &noises[first]);
+    combine(first, dimensions);
+}
+
+void TimeFunctionBankBase::combine(int first, int count)
+{
+    const float *constant = &data[TIMEFUNCTION_CONSTANT][first];
+    const float *time = &data[TIMEFUNCTION_TIME_FACTOR][first];
+    const float *randMin = &data[TIMEFUNCTION_RAND_MIN][first];
+    const float *randMax = &data[TIMEFUNCTION_RAND_MAX][first];
+    const float *noiseMin = &data[TIMEFUNCTION_NOISE_MIN][first];
+    const float *noiseMax = &data[TIMEFUNCTION_NOISE_MAX][first];
+    const float *sineMin = &data[TIMEFUNCTION_SINE_MIN][first];
+    const float *sineMax = &data[TIMEFUNCTION_SINE_MAX][first];
+    const float *r = &randoms[first];
+    const float *n = &noises[first];
+    const float *s = &sines[first];
+    float *value = &data[TIMEFUNCTION_VALUE][first];
+
+    int k = 0;
+#if defined(__SSE2__)
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; k + 4 <= count; k += 4)
+    {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(constant + k), _mm_loadu_ps(time + k));
+        __m128 lo = _mm_loadu_ps(randMin + k);
+        v = _mm_add_ps(v, _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(r + k), _mm_sub_ps(_mm_loadu_ps(randMax + k), lo))));
+        lo = _mm_loadu_ps(noiseMin + k);
+        v = _mm_add_ps(v, _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(n + k), _mm_sub_ps(_mm_loadu_ps(noiseMax + k), lo))));
+        lo = _mm_loadu_ps(sineMin + k);
+        __m128 t = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s + k), _mm_set1_ps(1.0f)), half);
+        v = _mm_add_ps(v, _mm_add_ps(lo, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(sineMax + k), lo))));
+        _mm_storeu_ps(value + k, v);
+    }
+#endif
+    for (; k < count; k++)
+    {
+        value[k] = constant[k] + time[k] +
+                   randMin[k] + r[k] * (randMax[k] - randMin[k]) +
+                   noiseMin[k] + n[k] * (noiseMax[k] - noiseMin[k]) +
+                   sineMin[k] + 0.5f * (s[k] + 1.0f) * (sineMax[k] - sineMin[k]);
+    }
+}
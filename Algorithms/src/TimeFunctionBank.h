@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ofMain.h"
+#include "FastRandom.h"
+#include "Noise.h"
+
+
+enum TimeFunctionParameter
+{
+    TIMEFUNCTION_CONSTANT,
+    TIMEFUNCTION_TIME_COEFFICIENT,
+    TIMEFUNCTION_RAND_MIN,
+    TIMEFUNCTION_RAND_MAX,
+    TIMEFUNCTION_NOISE_MIN,
+    TIMEFUNCTION_NOISE_MAX,
+    TIMEFUNCTION_NOISE_SPEED,
+    TIMEFUNCTION_NOISE_OFFSET,
+    TIMEFUNCTION_SINE_MIN,
+    TIMEFUNCTION_SINE_MAX,
+    TIMEFUNCTION_SINE_FREQ,
+    TIMEFUNCTION_SINE_PHASE,
+    TIMEFUNCTION_TIME_FACTOR,
+    TIMEFUNCTION_NOISE_FACTOR,
+    TIMEFUNCTION_SINE_FACTOR,
+    TIMEFUNCTION_VALUE,
+    TIMEFUNCTION_NUM_PARAMETERS
+};
+
+
+// Parameters of many time functions stored as one float array per
+// parameter, the components of each function next to each other. Each
+// function is
+//
+//   constant + time + random(randMin, randMax)
+//            + map(noise(noiseFactor, noiseOffset), noiseMin, noiseMax)
+//            + map(sin(sineFactor + sinePhase), sineMin, sineMax)
+//
+// per component, where the factors advance by delTime times their speed on
+// every update. evaluate() computes all of them in one pass with the
+// batched noise and a vectorized sine.
+
+class TimeFunctionBankBase
+{
+public:
+    TimeFunctionBankBase(int dimensions, bool autoUpdate);
+    virtual ~TimeFunctionBankBase();
+
+    // advance every function on ofEvents().update
+    void setAutoUpdate(bool autoUpdate);
+    bool getAutoUpdate() {return autoUpdate;}
+
+    // a new function is reset with delTime 1, removed ones are reused
+    int add();
+    void remove(int i);
+    void resize(int n);
+    void setSeed(unsigned int seed) {random.setSeed(seed);}
+    int size() {return numFunctions;}
+    int getDimensions() {return dimensions;}
+
+    // zero all parameters, with a new noise offset and sine phase
+    void reset(int i);
+    void copy(int i, TimeFunctionBankBase &source, int j);
+
+    void setDelTime(int i, float delTime) {delTimes[i] = delTime;}
+    void setDelTime(float delTime);
+    float getDelTime(int i) {return delTimes[i];}
+    float & getDelTimeRef(int i) {return delTimes[i];}
+
+    // noise offset and sine phase are ofVec3f for every type
+    ofVec3f getOffset(TimeFunctionParameter p, int i);
+    void setOffset(TimeFunctionParameter p, int i, const ofVec3f &offset);
+
+    float * getData(TimeFunctionParameter p) {return data[p].empty() ? NULL : &data[p][0];}
+
+    void update();
+    void update(int i);
+
+    // values are stored as TIMEFUNCTION_VALUE
+    void evaluate();
+    void evaluate(int i);
+
+protected:
+
+    void update(ofEventArgs &args);
+    void combine(int first, int count);
+
+    int dimensions;
+    int numFunctions;
+    bool autoUpdate;
+
+    vector<float> data[TIMEFUNCTION_NUM_PARAMETERS];
+    vector<float> delTimes;
+    vector<int> removed;
+
+    vector<float> randoms, noises, sines;
+    FastRandom random;
+};
+
+
+template <typename T> struct TimeFunctionTraits { };
+
+template<> struct TimeFunctionTraits<int>
+{
+    enum {size = 1};
+    static int load(const float *p) {return p[0];}
+    static void store(const int &v, float *p) {p[0] = v;}
+};
+
+template<> struct TimeFunctionTraits<float>
+{
+    enum {size = 1};
+    static float load(const float *p) {return p[0];}
+    static void store(const float &v, float *p) {p[0] = v;}
+    static float & ref(float *p) {return *p;}
+};
+
+template<> struct TimeFunctionTraits<ofVec2f>
+{
+    enum {size = 2};
+    static ofVec2f load(const float *p) {return ofVec2f(p[0], p[1]);}
+    static void store(const ofVec2f &v, float *p) {p[0] = v.x; p[1] = v.y;}
+    static ofVec2f & ref(float *p) {return *reinterpret_cast<ofVec2f *>(p);}
+};
+
+template<> struct TimeFunctionTraits<ofVec3f>
+{
+    enum {size = 3};
+    static ofVec3f load(const float *p) {return ofVec3f(p[0], p[1], p[2]);}
+    static void store(const ofVec3f &v, float *p) {p[0] = v.x; p[1] = v.y; p[2] = v.z;}
+    static ofVec3f & ref(float *p) {return *reinterpret_cast<ofVec3f *>(p);}
+};
+
+
+// Typed access to a bank. References stay valid until functions are added.
+
+template <typename T>
+class TimeFunctionBank : public TimeFunctionBankBase
+{
+public:
+    TimeFunctionBank(bool autoUpdate=false) : TimeFunctionBankBase(TimeFunctionTraits<T>::size, autoUpdate) { }
+
+    T get(TimeFunctionParameter p, int i) {return TimeFunctionTraits<T>::load(&data[p][i * dimensions]);}
+    T & getRef(TimeFunctionParameter p, int i) {return TimeFunctionTraits<T>::ref(&data[p][i * dimensions]);}
+    void set(TimeFunctionParameter p, int i, const T &v) {TimeFunctionTraits<T>::store(v, &data[p][i * dimensions]);}
+
+    void setAll(TimeFunctionParameter p, const T &v)
+    {
+        for (int i = 0; i < numFunctions; i++) {
+            set(p, i, v);
+        }
+    }
+
+    // from the last evaluate
+    T getValue(int i) {return get(TIMEFUNCTION_VALUE, i);}
+    const T * getValues() {return numFunctions == 0 ? NULL : &getRef(TIMEFUNCTION_VALUE, 0);}
+
+    // functions of standalone TimeFunctions
+    static TimeFunctionBank<T> & getShared(bool autoUpdate)
+    {
+        static TimeFunctionBank<T> updated(true);
+        static TimeFunctionBank<T> manual(false);
+        return autoUpdate ? updated : manual;
+    }
+};
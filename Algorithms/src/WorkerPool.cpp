@@ -0,0 +1,115 @@
+#include "WorkerPool.h"
+#include <thread>
+
+
+WorkerPool::WorkerPool()
+{
+    count = 0;
+    chunkSize = 1;
+    nextChunk = 0;
+    numBusy = 0;
+    generation = 0;
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+void WorkerPool::setup(int numThreads)
+{
+    stop();
+    if (numThreads <= 0) {
+        numThreads = max((int) std::thread::hardware_concurrency(), 1);
+    }
+    for (int i = 1; i < numThreads; i++)
+    {
+        workers.push_back(new Worker(this, i));
+        workers.back()->startThread(true, false);
+    }
+}
+
+void WorkerPool::stop()
+{
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i]->stopThread();
+    }
+    {
+        std::lock_guard<std::mutex> poolLock(poolMutex);
+    }
+    startCondition.notify_all();
+    for (int i = 0; i < workers.size(); i++)
+    {
+        workers[i]->waitForThread(false);
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+void WorkerPool::parallelFor(int count, int chunkSize, std::function<void(int, int, int)> job)
+{
+    chunkSize = max(chunkSize, 1);
+    if (workers.empty() || count <= chunkSize)
+    {
+        if (count > 0) {
+            job(0, count, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> poolLock(poolMutex);
+        this->job = job;
+        this->count = count;
+        this->chunkSize = chunkSize;
+        nextChunk = 0;
+        numBusy = workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> poolLock(poolMutex);
+    doneCondition.wait(poolLock, [this] { return numBusy == 0; });
+}
+
+void WorkerPool::runChunks(int thread)
+{
+    int numChunks = (count + chunkSize - 1) / chunkSize;
+    for (int chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+    {
+        int begin = chunk * chunkSize;
+        job(begin, min(begin + chunkSize, count), thread);
+    }
+}
+
+WorkerPool::Worker::Worker(WorkerPool *pool, int index)
+{
+    this->pool = pool;
+    this->index = index;
+    generation = pool->generation;
+}
+
+void WorkerPool::Worker::threadedFunction()
+{
+    while (isThreadRunning())
+    {
+        {
+            std::unique_lock<std::mutex> poolLock(pool->poolMutex);
+            pool->startCondition.wait(poolLock, [this] { return pool->generation != generation || !isThreadRunning(); });
+            if (pool->generation == generation) {
+                continue;
+            }
+            generation = pool->generation;
+        }
+
+        pool->runChunks(index);
+
+        {
+            std::lock_guard<std::mutex> poolLock(pool->poolMutex);
+            pool->numBusy--;
+        }
+        pool->doneCondition.notify_all();
+    }
+}
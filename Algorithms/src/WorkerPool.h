@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+
+// Fixed set of threads that split a range of indices between them. The
+// range is cut into chunks of a fixed size which the workers, and the
+// calling thread, take in turn until none are left; parallelFor returns
+// once every chunk is done. Each call passes the index of the thread
+// running the chunk, 0 being the caller, so jobs can keep per-thread state.
+
+class WorkerPool
+{
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    // numThreads includes the calling thread, 0 for one per core
+    void setup(int numThreads=0);
+    void stop();
+
+    int getNumThreads() {return workers.size() + 1;}
+
+    void parallelFor(int count, int chunkSize, std::function<void(int, int, int)> job);
+
+private:
+
+    class Worker : public ofThread
+    {
+    public:
+        Worker(WorkerPool *pool, int index);
+        void threadedFunction();
+        WorkerPool *pool;
+        int index;
+        int64_t generation;     // last job taken
+    };
+
+    void runChunks(int thread);
+
+    vector<Worker*> workers;
+
+    std::function<void(int, int, int)> job;
+    int count, chunkSize;
+    std::atomic<int> nextChunk;
+    int numBusy;
+    int64_t generation;
+
+    std::mutex poolMutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+};
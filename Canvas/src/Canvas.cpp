@@ -34,8 +34,20 @@ void Canvas::setup(string name, int width, int height)
     this->width = width;
     this->height = height;
     this->creator = NULL;
+    
+    viewIndex = 0;
+    tapView = false;
+    guiVisible = true;
+    profiling = false;
+
+    graph.setup(name, width, height);
+    
+    Profiler &profiler = Profiler::getShared();
+    stageUpdate = profiler.getStage(name + "/creator update");
+    stageMask = profiler.getStage(name + "/mask");
+    stageDraw = profiler.getStage(name + "/draw");
+    stageMapping = profiler.getStage(name + "/mapping");
 
-    createNewFbo();
     mapping.addQuad(width, height);
     
     // Control panel
@@ -45,6 +57,7 @@ void Canvas::setup(string name, int width, int height)
 
     menuView = metaPanel.addMenu("View modifier", this, &Canvas::eventViewLayer);
     menuView->addToggle("Creator");
+    metaPanel.addToggle("Tap view", &tapView);
 
     menuAddMod = metaPanel.addMenu("Add modifier", this, &Canvas::eventCreateModifier);
     menuAddMod->addToggle("Shader");
@@ -66,6 +79,10 @@ void Canvas::setup(string name, int width, int height)
     widgetMapping->addButton("Load", this, &Canvas::eventLoadCalibration)->setActive(pmEnabled);
     metaPanel.addToggle("Mask enabled", &maskEnabled);
     
+    widgetProfiler = metaPanel.addWidget("Profiler");
+    widgetProfiler->addToggle("Enabled", &profiling, this, &Canvas::eventToggleProfiler);
+    widgetProfiler->addButton("Save trace", this, &Canvas::eventSaveTrace);
+    
     // Creator panel
     creatorPanel.setName("Creator");
     menuCreator = creatorPanel.addMenu("Creator", this, &Canvas::eventSelectCreator);
@@ -86,25 +103,23 @@ void Canvas::setup(string name, int width, int height)
 
 void Canvas::update()
 {
-    checkFboSize();
     updatePanels();
     
     if (creator == NULL)    return;
+    
+    Profiler &profiler = Profiler::getShared();
+    profiler.begin(stageUpdate);
     creator->update();
+    profiler.end();
     
-    fbo[0].begin();
-    creator->draw(0, 0);
-    fbo[0].end();
-    
-    for (int i = 0; i < modifiers.size(); i++)
-    {
-        fbo[i+1].begin();
-        modifiers[i]->render(&fbo[i]);
-        fbo[i+1].end();
-    }
+    // recompiled every frame, modifiers turn pass-through from their panels
+    bool tap = tapView && canvasView == CONDENSED;
+    graph.compile(modifiers, tap ? viewIndex : (int) modifiers.size());
+    graph.render(creator);
     
     if (maskEnabled)
     {
+        ProfilerScope scope(stageMask);
         mask.begin();
         ofClear(0, 0);
         ofSetColor(255);
@@ -137,15 +152,17 @@ void Canvas::draw(int x, int y)
 {
     if (pmEnabled)
     {
+        ProfilerScope scope(stageMapping);
         mapping.begin(0);
         if (maskEnabled)
         {
+            ProfilerScope maskScope(stageMask);
             maskResult.begin();
             ofClear(0, 0);
             maskShader.begin();
             maskShader.setUniformTexture("maskTex", mask.getTextureReference(), 1);
 
-            fbo[fbo.size()-1].draw(0, 0);
+            graph.getOutput().draw(0, 0);
             
             maskShader.end();
             maskResult.end();
@@ -154,16 +171,80 @@ void Canvas::draw(int x, int y)
         }
         else
         {
-            fbo[fbo.size()-1].draw(0, 0);
+            graph.getOutput().draw(0, 0);
         }
         mapping.end(0);
     }
     else
     {
-        fbo[fbo.size()-1].draw(x, y);
+        ProfilerScope scope(stageDraw);
+        graph.getOutput().draw(x, y);
+    }
+    
+    if (profiling && guiVisible) {
+        drawProfiler();
     }
 }
 
+void Canvas::drawProfiler()
+{
+    Profiler &profiler = Profiler::getShared();
+    
+    vector<int> stages;
+    for (int i = 0; i < profiler.getNumStages(); i++)
+    {
+        if (profiler.getHistogram(i).getCount() > 0) {
+            stages.push_back(i);
+        }
+    }
+    float frameTime = 0;
+    const deque<ProfilerFrame> & frames = profiler.getFrames();
+    for (auto & f : frames) {
+        frameTime += f.duration / frames.size();
+    }
+    
+    // one row per stage: mean times over the history and a histogram,
+    // CPU in white and GPU in orange, bins doubling from 32 us
+    ofRectangle rect = metaPanel.getRectangle();
+    int x = rect.x;
+    int y = rect.y + rect.height + 10;
+    int barsX = x + CANVAS_PROFILER_WIDTH - 4 * PROFILER_HISTOGRAM_BINS - 6;
+    
+    ofPushStyle();
+    ofFill();
+    ofSetColor(0, 200);
+    ofRect(x, y, CANVAS_PROFILER_WIDTH, 22 + 14 * stages.size());
+    ofSetColor(255);
+    ofDrawBitmapString("frame "+ofToString(frameTime / 1000.0f, 2)+" ms", x + 4, y + 14);
+    for (int i = 0; i < stages.size(); i++)
+    {
+        ProfilerHistogram &h = profiler.getHistogram(stages[i]);
+        int ry = y + 18 + 14 * i;
+        string text = profiler.getStageName(stages[i]).substr(0, 24);
+        text += string(26 - text.size(), ' ') + ofToString(h.getCpuMean() / 1000.0f, 2);
+        if (h.getGpuMean() >= 0) {
+            text += " / " + ofToString(h.getGpuMean() / 1000.0f, 2);
+        }
+        ofSetColor(255);
+        ofDrawBitmapString(text, x + 4, ry + 10);
+        
+        int maxBin = 1;
+        for (int b = 0; b < PROFILER_HISTOGRAM_BINS; b++) {
+            maxBin = max(maxBin, max(h.getCpuBin(b), h.getGpuBin(b)));
+        }
+        for (int b = 0; b < PROFILER_HISTOGRAM_BINS; b++)
+        {
+            float cpuHeight = 12.0f * h.getCpuBin(b) / maxBin;
+            float gpuHeight = 12.0f * h.getGpuBin(b) / maxBin;
+            ofSetColor(255);
+            ofRect(barsX + 4 * b, ry + 12 - cpuHeight, 2, cpuHeight);
+            ofSetColor(255, 140, 0);
+            ofRect(barsX + 4 * b + 2, ry + 12 - gpuHeight, 2, gpuHeight);
+        }
+    }
+    ofPopStyle();
+}
+
 void Canvas::addCreator(Scene *creator)
 {
     creators[creator->getName()] = creator;
@@ -262,6 +343,17 @@ void Canvas::eventLoadCalibration(GuiButtonEventArgs &evt)
     mapping.loadPreset("Mapping.xml");
 }
 
+void Canvas::eventToggleProfiler(GuiButtonEventArgs &evt)
+{
+    Profiler::getShared().setGpuTiming(profiling);
+    Profiler::getShared().setEnabled(profiling);
+}
+
+void Canvas::eventSaveTrace(GuiButtonEventArgs &evt)
+{
+    Profiler::getShared().saveTrace(ofToDataPath("trace-"+ofGetTimestampString()+".json"));
+}
+
 void Canvas::eventCreateModifier(GuiMenuEventArgs &evt)
 {
     if      (evt.index == 0) addShaderModifier();
@@ -278,6 +370,9 @@ void Canvas::eventRemoveModifier(GuiMenuEventArgs &evt)
     menuView->removeToggle(evt.toggle->getName());
     modifiers[evt.index]->setActive(false);
     modifiers.erase(modifiers.begin() + evt.index);
+    if (viewIndex > evt.index) {
+        viewIndex--;
+    }
     resetGuiPositions();
 }
 
@@ -299,6 +394,7 @@ void Canvas::eventSelectCreator(GuiMenuEventArgs &e)
 
 void Canvas::eventViewLayer(GuiMenuEventArgs &evt)
 {
+    viewIndex = evt.index;
     if (canvasView != CONDENSED)    return;
 
     creatorPanel.setAutoUpdate(false);
@@ -320,26 +416,6 @@ void Canvas::eventViewLayer(GuiMenuEventArgs &evt)
     }
 }
 
-void Canvas::createNewFbo()
-{
-    int idx = fbo.size();
-    fbo.resize(fbo.size() + 1);
-    fbo[idx].allocate(width, height);
-    fbo[idx].begin();
-    ofClear(0, 0);
-    fbo[idx].end();
-}
-
-void Canvas::checkFboSize()
-{
-    while (modifiers.size() + 1 > fbo.size()) {
-        createNewFbo();
-    }
-    if (fbo.size() > modifiers.size() + 1) {
-        fbo.resize(modifiers.size() + 1);
-    }
-}
-
 void Canvas::refreshPresetMenu()
 {
     ofDirectory dir;
@@ -11,9 +11,11 @@
 #include "PostProcessing.h"
 #include "PostFX.h"
 #include "FilterLibrary.h"
+#include "RenderGraph.h"
 
 #include "ProjectionMapping.h"
 
+#define CANVAS_PROFILER_WIDTH 420   // width of the timing overlay
 
 
 class Canvas
@@ -41,17 +43,19 @@ public:
     void setGuiDisplayMode(CanvasView canvasView);
     void toggleGuiVisible();
     
+    int getWidth() {return width;}
+    int getHeight() {return height;}
+    
     GuiPanel & getControl() {return metaPanel;}
     GuiPanel & getCreatorPanel() {return creatorPanel;}
     
 private:
     
-    void createNewFbo();
-    void checkFboSize();
     void updatePanels();
     void refreshPresetMenu();
     void resetGuiPositions();
     void switchCreator(string name);
+    void drawProfiler();
 
     Modifier * addModifier(string type);
     Modifier * initializeModifier(Modifier *modifier, bool toSetup);
@@ -66,6 +70,8 @@ private:
     void eventToggleMappingCalibration(GuiButtonEventArgs &evt);
     void eventSaveCalibration(GuiButtonEventArgs &evt);
     void eventLoadCalibration(GuiButtonEventArgs &evt);
+    void eventToggleProfiler(GuiButtonEventArgs &evt);
+    void eventSaveTrace(GuiButtonEventArgs &evt);
     
     void setFromXml(ofXml &xml);
     void getXml(ofXml &xml);
@@ -80,7 +86,15 @@ private:
     Scene *creator;
     vector<Modifier*> availableModifiers;
     vector<Modifier*> modifiers;
-    vector<ofFbo> fbo;
+    RenderGraph graph;
+    
+    // show the chain up to the viewed layer, 0 is the creator
+    int viewIndex;
+    bool tapView;
+    
+    // Profiler stages
+    int stageUpdate, stageMask, stageDraw, stageMapping;
+    bool profiling;
 
     GuiPanel creatorPanel, metaPanel;
     GuiMenu *menuCreator;
@@ -89,6 +103,7 @@ private:
     GuiMenu *menuRemove;
     GuiMenu *menuView;
     GuiWidget *widgetMapping;
+    GuiWidget *widgetProfiler;
     
     ProjectionMapping mapping;
     bool pmEnabled;
@@ -0,0 +1,282 @@
+#include "CanvasBenchmark.h"
+#include <fstream>
+
+
+unsigned int CanvasBenchmark::seedValue = 0;
+
+static float percentile(const vector<float> &sorted, float p)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    int idx = min((int) sorted.size() - 1, (int) (p * (sorted.size() - 1) + 0.5f));
+    return sorted[idx];
+}
+
+static float mean(const vector<float> &values)
+{
+    if (values.empty()) {
+        return 0;
+    }
+    double sum = 0;
+    for (auto v : values) {
+        sum += v;
+    }
+    return sum / values.size();
+}
+
+static string escapeJson(const string &s)
+{
+    string escaped;
+    for (auto c : s)
+    {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+CanvasBenchmark::CanvasBenchmark()
+{
+    canvas = NULL;
+    scene = NULL;
+    width = 0;
+    height = 0;
+    numFrames = 0;
+    numWarmup = 0;
+    frame = 0;
+    frameMean = 0;
+    frameMax = 0;
+}
+
+void CanvasBenchmark::seed(unsigned int seed)
+{
+    seedValue = seed;
+
+    // the shared banks draw their own seeds from ofRandom when created
+    TimeFunctionBank<int>::getShared(true).setSeed(seed);
+    TimeFunctionBank<int>::getShared(false).setSeed(seed + 1);
+    TimeFunctionBank<float>::getShared(true).setSeed(seed + 2);
+    TimeFunctionBank<float>::getShared(false).setSeed(seed + 3);
+    TimeFunctionBank<ofVec2f>::getShared(true).setSeed(seed + 4);
+    TimeFunctionBank<ofVec2f>::getShared(false).setSeed(seed + 5);
+    TimeFunctionBank<ofVec3f>::getShared(true).setSeed(seed + 6);
+    TimeFunctionBank<ofVec3f>::getShared(false).setSeed(seed + 7);
+    ofSeedRandom(seed);
+}
+
+void CanvasBenchmark::setup(Canvas *canvas, int numFrames, int numWarmup)
+{
+    this->canvas = canvas;
+    this->scene = NULL;
+    this->width = canvas->getWidth();
+    this->height = canvas->getHeight();
+    this->numFrames = numFrames;
+    this->numWarmup = numWarmup;
+    frame = 0;
+}
+
+void CanvasBenchmark::setup(Scene *scene, int width, int height, int numFrames, int numWarmup)
+{
+    this->canvas = NULL;
+    this->scene = scene;
+    this->width = width;
+    this->height = height;
+    this->numFrames = numFrames;
+    this->numWarmup = numWarmup;
+    frame = 0;
+
+    fbo.allocate(width, height);
+    fbo.begin();
+    ofClear(0, 0);
+    fbo.end();
+
+    Profiler &profiler = Profiler::getShared();
+    stageUpdate = profiler.getStage(scene->getName() + "/update");
+    stageDraw = profiler.getStage(scene->getName() + "/draw");
+}
+
+void CanvasBenchmark::update()
+{
+    if (isFinished())   return;
+    if (frame == numWarmup) {
+        start();
+    }
+
+    if (canvas != NULL) {
+        canvas->update();
+    }
+    else if (scene != NULL)
+    {
+        ProfilerScope scope(stageUpdate);
+        scene->update();
+    }
+}
+
+void CanvasBenchmark::draw()
+{
+    if (isFinished())   return;
+
+    if (canvas != NULL) {
+        canvas->draw(0, 0);
+    }
+    else if (scene != NULL)
+    {
+        {
+            ProfilerScope scope(stageDraw);
+            fbo.begin();
+            scene->draw(0, 0);
+            fbo.end();
+        }
+        fbo.draw(0, 0);
+    }
+
+    if (++frame == numWarmup + numFrames) {
+        finish();
+    }
+}
+
+void CanvasBenchmark::start()
+{
+    Profiler &profiler = Profiler::getShared();
+    profiler.clear();
+    profiler.setHistorySize(numFrames);
+    profiler.setGpuTiming(true);
+    profiler.setEnabled(true);
+}
+
+void CanvasBenchmark::finish()
+{
+    Profiler &profiler = Profiler::getShared();
+    profiler.flush();
+    const deque<ProfilerFrame> &frames = profiler.getFrames();
+    results.assign(frames.begin(), frames.end());
+    profiler.setEnabled(false);
+    summarize();
+}
+
+void CanvasBenchmark::summarize()
+{
+    Profiler &profiler = Profiler::getShared();
+    int numStages = profiler.getNumStages();
+
+    // per frame totals of each stage, gpu only where every sample has one
+    vector<vector<float> > cpu(numStages), gpu(numStages);
+    vector<float> durations;
+    for (auto & f : results)
+    {
+        vector<float> cpuTotal(numStages, 0), gpuTotal(numStages, 0);
+        vector<int> count(numStages, 0);
+        vector<bool> hasGpu(numStages, true);
+        for (auto & s : f.samples)
+        {
+            cpuTotal[s.stage] += s.cpu;
+            gpuTotal[s.stage] += s.gpu;
+            hasGpu[s.stage] = hasGpu[s.stage] && s.gpu >= 0;
+            count[s.stage]++;
+        }
+        for (int i = 0; i < numStages; i++)
+        {
+            if (count[i] == 0)  continue;
+            cpu[i].push_back(cpuTotal[i]);
+            if (hasGpu[i]) {
+                gpu[i].push_back(gpuTotal[i]);
+            }
+        }
+        durations.push_back(f.duration);
+    }
+
+    summary.clear();
+    for (int i = 0; i < numStages; i++)
+    {
+        if (cpu[i].empty())     continue;
+        sort(cpu[i].begin(), cpu[i].end());
+        sort(gpu[i].begin(), gpu[i].end());
+        StageSummary s;
+        s.name = profiler.getStageName(i);
+        s.frames = cpu[i].size();
+        s.cpuMean = mean(cpu[i]);
+        s.cpuMedian = percentile(cpu[i], 0.5f);
+        s.cpuP95 = percentile(cpu[i], 0.95f);
+        s.cpuMax = cpu[i].back();
+        s.gpuMean = gpu[i].empty() ? -1 : mean(gpu[i]);
+        s.gpuMedian = gpu[i].empty() ? -1 : percentile(gpu[i], 0.5f);
+        s.gpuP95 = gpu[i].empty() ? -1 : percentile(gpu[i], 0.95f);
+        s.gpuMax = gpu[i].empty() ? -1 : gpu[i].back();
+        summary.push_back(s);
+    }
+    frameMean = mean(durations);
+    frameMax = durations.empty() ? 0 : *max_element(durations.begin(), durations.end());
+}
+
+bool CanvasBenchmark::saveCsv(string path)
+{
+    ofstream file(path.c_str());
+    if (!file.is_open())
+    {
+        ofLog(OF_LOG_ERROR, "Can't write benchmark to "+path);
+        return false;
+    }
+    Profiler &profiler = Profiler::getShared();
+    file << "frame,stage,depth,start_us,cpu_us,gpu_us" << endl;
+    for (int i = 0; i < results.size(); i++)
+    {
+        for (auto & s : results[i].samples)
+        {
+            file << i << ",\"" << profiler.getStageName(s.stage) << "\"," << s.depth << ","
+                 << s.start << "," << s.cpu << "," << s.gpu << endl;
+        }
+    }
+    return true;
+}
+
+bool CanvasBenchmark::saveJson(string path)
+{
+    ofstream file(path.c_str());
+    if (!file.is_open())
+    {
+        ofLog(OF_LOG_ERROR, "Can't write benchmark to "+path);
+        return false;
+    }
+    const char *renderer = (const char *) glGetString(GL_RENDERER);
+    file << "{" << endl;
+    file << "  \"width\": " << width << "," << endl;
+    file << "  \"height\": " << height << "," << endl;
+    file << "  \"frames\": " << results.size() << "," << endl;
+    file << "  \"warmup\": " << numWarmup << "," << endl;
+    file << "  \"seed\": " << seedValue << "," << endl;
+    file << "  \"renderer\": \"" << escapeJson(renderer != NULL ? renderer : "") << "\"," << endl;
+    file << "  \"gpuTiming\": " << (Profiler::getShared().getGpuTiming() ? "true" : "false") << "," << endl;
+    file << "  \"frameMeanUs\": " << frameMean << "," << endl;
+    file << "  \"frameMaxUs\": " << frameMax << "," << endl;
+    file << "  \"stages\": [" << endl;
+    for (int i = 0; i < summary.size(); i++)
+    {
+        StageSummary &s = summary[i];
+        file << "    {\"name\": \"" << escapeJson(s.name) << "\", \"frames\": " << s.frames
+             << ", \"cpuMeanUs\": " << s.cpuMean << ", \"cpuMedianUs\": " << s.cpuMedian
+             << ", \"cpuP95Us\": " << s.cpuP95 << ", \"cpuMaxUs\": " << s.cpuMax
+             << ", \"gpuMeanUs\": " << s.gpuMean << ", \"gpuMedianUs\": " << s.gpuMedian
+             << ", \"gpuP95Us\": " << s.gpuP95 << ", \"gpuMaxUs\": " << s.gpuMax << "}"
+             << (i + 1 < summary.size() ? "," : "") << endl;
+    }
+    file << "  ]" << endl;
+    file << "}" << endl;
+    return true;
+}
+
+void CanvasBenchmark::printSummary()
+{
+    cout << "benchmark " << width << "x" << height << ", " << results.size() << " frames, mean frame "
+         << frameMean / 1000.0f << " ms, max " << frameMax / 1000.0f << " ms" << endl;
+    for (auto & s : summary)
+    {
+        cout << "  " << s.name << ": cpu " << s.cpuMean / 1000.0f << " ms (p95 " << s.cpuP95 / 1000.0f << ")";
+        if (s.gpuMean >= 0) {
+            cout << ", gpu " << s.gpuMean / 1000.0f << " ms (p95 " << s.gpuP95 / 1000.0f << ")";
+        }
+        cout << endl;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Profiler.h"
+#include "TimeFunctionBank.h"
+#include "Scene.h"
+#include "Canvas.h"
+
+#define CANVASBENCHMARK_WARMUP 30       // frames rendered before timing
+
+
+// Runs a Canvas, or a Scene on its own, for a fixed number of frames with
+// the shared Profiler on, GPU timing where available, and saves the
+// timings of every stage: one CSV row per frame and stage, and per stage
+// statistics as JSON. Call update and draw from the app's; frames go as
+// fast as the loop does, so with vertical sync off it runs the same in a
+// virtual display with software GL. seed fixes ofRandom and the shared
+// time functions, it has to come before the scenes are set up.
+
+class CanvasBenchmark
+{
+public:
+    CanvasBenchmark();
+
+    static void seed(unsigned int seed);
+
+    void setup(Canvas *canvas, int numFrames, int numWarmup=CANVASBENCHMARK_WARMUP);
+    void setup(Scene *scene, int width, int height, int numFrames, int numWarmup=CANVASBENCHMARK_WARMUP);
+
+    void update();
+    void draw();
+    bool isFinished() {return frame >= numWarmup + numFrames;}
+
+    bool saveCsv(string path);
+    bool saveJson(string path);
+    void printSummary();
+
+private:
+
+    struct StageSummary
+    {
+        string name;
+        int frames;
+        float cpuMean, cpuMedian, cpuP95, cpuMax;
+        float gpuMean, gpuMedian, gpuP95, gpuMax;
+    };
+
+    void start();
+    void finish();
+    void summarize();
+
+    Canvas *canvas;
+    Scene *scene;
+    ofFbo fbo;
+    int stageUpdate, stageDraw;
+
+    int width, height;
+    int numFrames, numWarmup, frame;
+    static unsigned int seedValue;
+
+    vector<ProfilerFrame> results;
+    vector<StageSummary> summary;
+    float frameMean, frameMax;
+};
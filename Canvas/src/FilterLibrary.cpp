@@ -12,7 +12,7 @@ void FilterLibrary::setup(int width, int height)
     _currentFilter = 0;
     
     fboInner = new ofFbo();
-    fboInner->allocate(1280, 720);
+    fboInner->allocate(width, height);
     fboInner->begin();
     ofClear(0, 0);
     fboInner->end();
@@ -38,8 +38,8 @@ void FilterLibrary::setup(int width, int height)
     _filters.push_back(new ZoomBlurFilter());
     _filters.push_back(new EmbossFilter(width, height, 2.f));
     _filters.push_back(new SmoothToonFilter(width, height));
-    _filters.push_back(new TiltShiftFilter(fboInner->getTextureReference()));
-    _filters.push_back(new VoronoiFilter(fboInner->getTextureReference()));
+    addInputFilter(new TiltShiftFilter(fboInner->getTextureReference()));
+    addInputFilter(new VoronoiFilter(fboInner->getTextureReference()));
     _filters.push_back(new CGAColorspaceFilter());
     _filters.push_back(new ErosionFilter(width, height));
     _filters.push_back(new LookupFilter(width, height, "img/lookup_amatorka.png"));
@@ -49,8 +49,8 @@ void FilterLibrary::setup(int width, int height)
     _filters.push_back(new PosterizeFilter(8));
     _filters.push_back(new LaplacianFilter(width, height, ofVec2f(1, 1)));
     _filters.push_back(new PixelateFilter(width, height));
-    _filters.push_back(new HarrisCornerDetectionFilter(fboInner->getTextureReference()));
-    _filters.push_back(new MotionDetectionFilter(fboInner->getTextureReference()));
+    addInputFilter(new HarrisCornerDetectionFilter(fboInner->getTextureReference()));
+    addInputFilter(new MotionDetectionFilter(fboInner->getTextureReference()));
     _filters.push_back(new LowPassFilter(width, height, 0.9));
     
     // blending examples
@@ -112,6 +112,12 @@ void FilterLibrary::setup(int width, int height)
     }
 }
 
+void FilterLibrary::addInputFilter(AbstractFilter *filter)
+{
+    _filters.push_back(filter);
+    _inputFilters.insert(filter);
+}
+
 GuiPanel & FilterLibrary::getControl()
 {
     return panel;
@@ -119,11 +125,20 @@ GuiPanel & FilterLibrary::getControl()
 
 void FilterLibrary::render(ofFbo *fbo)
 {
+    AbstractFilter *filter = _filters[_currentFilter];
+    if (_inputFilters.count(filter) == 0)
+    {
+        filter->begin();
+        fbo->draw(0, 0);
+        filter->end();
+        return;
+    }
+    
     fboInner->begin();
     fbo->draw(0, 0);
     fboInner->end();
     
-    _filters[_currentFilter]->begin();
+    filter->begin();
     fboInner->draw(0, 0);
-    _filters[_currentFilter]->end();
+    filter->end();
 }
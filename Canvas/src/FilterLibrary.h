@@ -32,8 +32,12 @@ public:
     
     GuiPanel & getControl();
     
+    // filters which read the input from fboInner's texture
+    void addInputFilter(AbstractFilter *filter);
+    
     int                         _currentFilter;
     vector<AbstractFilter *>    _filters;
+    set<AbstractFilter *>       _inputFilters;
 
     GuiPanel panel;
     
@@ -44,6 +44,12 @@ public:
     
     virtual void render(ofFbo *fbo) { }
     
+    // renders its input unchanged, so it can be skipped
+    virtual bool getPassThrough() {return false;}
+    
+    // render writes the result back into fbo instead of the bound target
+    virtual bool getInPlace() {return false;}
+    
     string getType() {return type;}
     
     int width, height;
@@ -20,7 +20,7 @@ void PostFX::setup(int width, int height)
         
     loadLutLookup();
 
-    active = 0;
+    activeLut = 0;
     pass = true;
 }
 
@@ -59,8 +59,8 @@ void PostFX::loadLutLookup()
 
 void PostFX::chooseLut(GuiMenuEventArgs &e)
 {
-    active = e.index;
-    pass = active == 0;
+    activeLut = e.index;
+    pass = activeLut == 0;
 }
 
 void PostFX::setLutLookup(vector<ofxLUT*> lut)
@@ -77,19 +77,19 @@ void PostFX::render(ofFbo *fbo)
 {
     if (!pass)
     {
-        lut[active]->setTexture(fbo->getTextureReference());
-        lut[active]->update();
+        lut[activeLut]->setTexture(fbo->getTextureReference());
+        lut[activeLut]->update();
     }
     
     if (selection == "none")
     {
         if (pass)   fbo->draw(0, 0);
-        else        lut[active]->draw();
+        else        lut[activeLut]->draw();
     }
     else if (selection == "bloom")
     {
         if (pass)   bloom << fbo->getTextureReference();
-        else        bloom << *lut[active];
+        else        bloom << *lut[activeLut];
         bloom.update();
         bloom.draw();
     }
@@ -97,7 +97,7 @@ void PostFX::render(ofFbo *fbo)
     {
         gaussianBlur.setRadius(radius);
         if (pass)   gaussianBlur << fbo->getTextureReference();
-        else        gaussianBlur << *lut[active];
+        else        gaussianBlur << *lut[activeLut];
         gaussianBlur.update();
         gaussianBlur.draw();
     }
@@ -105,7 +105,7 @@ void PostFX::render(ofFbo *fbo)
     {
         bokeh.setRadius(radius);
         if (pass)   bokeh << fbo->getTextureReference();
-        else        bokeh << *lut[active];
+        else        bokeh << *lut[activeLut];
         bokeh.update();
         bokeh.draw();
     }
@@ -113,7 +113,7 @@ void PostFX::render(ofFbo *fbo)
     {
         glow.setRadius(radius);
         if (pass)   glow << fbo->getTextureReference();
-        else        glow << *lut[active];
+        else        glow << *lut[activeLut];
         glow.update();
         glow.draw();
     }
@@ -121,56 +121,56 @@ void PostFX::render(ofFbo *fbo)
     {
         blur.setFade(fade);
         if (pass)   blur << fbo->getTextureReference();
-        else        blur << *lut[active];
+        else        blur << *lut[activeLut];
         blur.update();
         blur.draw();
     }
     else if (selection == "median")
     {
         if (pass)   median << fbo->getTextureReference();
-        else        median << *lut[active];
+        else        median << *lut[activeLut];
         median.update();
         median.draw();
     }
     else if (selection == "oldtv")
     {
         if (pass)   oldtv << fbo->getTextureReference();
-        else        oldtv << *lut[active];
+        else        oldtv << *lut[activeLut];
         oldtv.update();
         oldtv.draw();
     }
     else if (selection == "inverse")
     {
         if (pass)   inverse << fbo->getTextureReference();
-        else        inverse << *lut[active];
+        else        inverse << *lut[activeLut];
         inverse.update();
         inverse.draw();
     }
     else if (selection == "barrelChromaAb")
     {
         if (pass)   barrelChromaAb << fbo->getTextureReference();
-        else        barrelChromaAb << *lut[active];
+        else        barrelChromaAb << *lut[activeLut];
         barrelChromaAb.update();
         barrelChromaAb.draw();
     }
     else if (selection == "chromaAb")
     {
         if (pass)   chromaAb << fbo->getTextureReference();
-        else        chromaAb << *lut[active];
+        else        chromaAb << *lut[activeLut];
         chromaAb.update();
         chromaAb.draw();
     }
     else if (selection == "chromaGlitch")
     {
         if (pass)   chromaGlitch << fbo->getTextureReference();
-        else        chromaGlitch << *lut[active];
+        else        chromaGlitch << *lut[activeLut];
         chromaGlitch.update();
         chromaGlitch.draw();
     }
     else if (selection == "grayscale")
     {
         if (pass)   grayscale << fbo->getTextureReference();
-        else        grayscale << *lut[active];
+        else        grayscale << *lut[activeLut];
         grayscale.update();
         grayscale.draw();
     }
@@ -41,6 +41,7 @@ public:
     void setLutLookup(vector<ofxLUT*> lut);
 
     void render(ofFbo *fbo);
+    bool getPassThrough() {return pass && selection == "none";}
 
     GuiPanel & getControl() {return panel;}
 
@@ -53,7 +54,7 @@ private:
     
     vector<string> lutChoices;
     vector<ofxLUT*> lut;
-    int active;
+    int activeLut;
     
     ofxBloom bloom;
     ofxGaussianBlur gaussianBlur;
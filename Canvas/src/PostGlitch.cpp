@@ -83,8 +83,14 @@ void PostGlitch::render(ofFbo *fbo)
      }*/
     
     post.generateFx();
-    fbo->draw(0, 0);
-    //fbo = *texLayer->getFbo();
+}
+
+bool PostGlitch::getPassThrough()
+{
+    return !(convergence || glow || shaker || cutslider || twist ||
+             outline || noise || slitscan || swell || invert ||
+             crHighContrast || crBlueRaise || crRedRaise || crGreenRaise ||
+             crBlueInvert || crRedInvert || crGreenInvert);
 }
 
 void PostGlitch::toggleEffects(GuiMenuEventArgs &evt)
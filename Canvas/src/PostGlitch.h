@@ -24,6 +24,9 @@ public:
     void setup(int width, int height);
     void render(ofFbo *fbo);
     
+    bool getPassThrough();
+    bool getInPlace() {return true;}
+    
     void toggleEffects(GuiMenuEventArgs &evt);
     void setDelayTime(GuiSliderEventArgs<float> &evt);
 
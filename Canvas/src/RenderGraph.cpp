@@ -0,0 +1,115 @@
+#include "RenderGraph.h"
+
+
+RenderGraph::RenderGraph()
+{
+    width = 0;
+    height = 0;
+    output = &source;
+}
+
+void RenderGraph::setup(string name, int width, int height)
+{
+    this->name = name;
+    this->width = width;
+    this->height = height;
+    allocate(source);
+    output = &source;
+    creatorStage = Profiler::getShared().getStage(name + "/creator draw");
+    copyStage = Profiler::getShared().getStage(name + "/copy");
+}
+
+void RenderGraph::compile(const vector<Modifier*> &modifiers, int tap)
+{
+    passes.clear();
+    ofFbo *current = &source;
+    int next = 0;
+
+    int numModifiers = min(tap, (int) modifiers.size());
+    for (int i = 0; i < numModifiers; i++)
+    {
+        Modifier *modifier = modifiers[i];
+        if (!modifier->getActive() || modifier->getPassThrough()) {
+            continue;
+        }
+
+        // in-place modifiers may not write over the creator's target
+        if (!modifier->getInPlace() || current == &source)
+        {
+            Pass pass;
+            pass.modifier = modifier->getInPlace() ? NULL : modifier;
+            pass.input = current;
+            pass.target = getTarget(next);
+            pass.stage = getStage(pass.modifier);
+            passes.push_back(pass);
+            current = pass.target;
+            next = 1 - next;
+        }
+        if (modifier->getInPlace())
+        {
+            Pass pass;
+            pass.modifier = modifier;
+            pass.input = current;
+            pass.target = current;
+            pass.stage = getStage(modifier);
+            passes.push_back(pass);
+        }
+    }
+    output = current;
+}
+
+void RenderGraph::render(Scene *creator)
+{
+    Profiler &profiler = Profiler::getShared();
+    
+    profiler.begin(creatorStage);
+    source.begin();
+    creator->draw(0, 0);
+    source.end();
+    profiler.end();
+
+    for (auto & pass : passes)
+    {
+        ProfilerScope scope(pass.stage);
+        if (pass.target == pass.input)
+        {
+            pass.modifier->render(pass.input);
+            continue;
+        }
+        pass.target->begin();
+        ofClear(0, 0);
+        if (pass.modifier == NULL) {
+            pass.input->draw(0, 0);
+        }
+        else {
+            pass.modifier->render(pass.input);
+        }
+        pass.target->end();
+    }
+}
+
+void RenderGraph::allocate(ofFbo &fbo)
+{
+    fbo.allocate(width, height);
+    fbo.begin();
+    ofClear(0, 0);
+    fbo.end();
+}
+
+int RenderGraph::getStage(Modifier *modifier)
+{
+    // names are only built while they are used
+    Profiler &profiler = Profiler::getShared();
+    if (modifier == NULL || !profiler.getEnabled()) {
+        return copyStage;
+    }
+    return profiler.getStage(name + "/" + modifier->getDisplayText());
+}
+
+ofFbo * RenderGraph::getTarget(int i)
+{
+    if (!pingPong[i].isAllocated()) {
+        allocate(pingPong[i]);
+    }
+    return &pingPong[i];
+}
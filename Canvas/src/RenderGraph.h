@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Scene.h"
+#include "Modifier.h"
+#include "Profiler.h"
+
+
+// A modifier chain compiled into passes over two ping-pong targets. The
+// creator keeps its own target since scenes which don't clear accumulate
+// into it; inactive and pass-through modifiers get no pass, and in-place
+// modifiers work on their input directly (after a copy if that input is
+// the creator's). Compiling up to a tap stops the chain after that many
+// modifiers, so the output shows an intermediate stage. Every pass is a
+// stage of the shared Profiler, named after the canvas and its modifier.
+
+class RenderGraph
+{
+public:
+    RenderGraph();
+
+    void setup(string name, int width, int height);
+    void compile(const vector<Modifier*> &modifiers, int tap);
+    void render(Scene *creator);
+
+    ofFbo & getOutput() {return *output;}
+    int getNumPasses() {return passes.size();}
+
+private:
+
+    // no modifier is a copy, target == input is in place
+    struct Pass
+    {
+        Modifier *modifier;
+        ofFbo *input;
+        ofFbo *target;
+        int stage;
+    };
+
+    void allocate(ofFbo &fbo);
+    ofFbo * getTarget(int i);
+    int getStage(Modifier *modifier);
+
+    string name;
+    int width, height;
+    int creatorStage, copyStage;
+
+    ofFbo source;
+    ofFbo pingPong[2];
+    vector<Pass> passes;
+    ofFbo *output;
+};
@@ -0,0 +1,172 @@
+#include "PointsBenchmark.h"
+#include <fstream>
+
+
+void FullScanEvenPointsGenerator::addPoints(int n)
+{
+    vector<ofPoint>::iterator it;
+    ofPoint newPoint, candidate;
+    float thisMinDist, currMinDist;
+
+    for (int i=0; i<n; i++)
+    {
+        currMinDist = 0;
+        for (int j=0; j<numberCandidates; j++)
+        {
+            thisMinDist = ofGetWidth();
+            newPoint = samplePointWithinBounds();
+            for(it = points.begin(); it != points.end(); ++it)
+            {
+                float dist = ofDist(newPoint.x, newPoint.y, it->x, it->y);
+                thisMinDist = min(dist, thisMinDist);
+            }
+            for(it = bounds.begin(); it != bounds.end(); ++it)
+            {
+                float dist = ofDist(newPoint.x, newPoint.y, it->x, it->y);
+                thisMinDist = min(dist, thisMinDist);
+            }
+            if (thisMinDist > currMinDist)
+            {
+                candidate.set(newPoint.x, newPoint.y);
+                currMinDist = thisMinDist;
+            }
+        }
+        points.push_back(ofPoint(candidate.x, candidate.y));
+    }
+}
+
+void FullScanCirclePackGenerator::addPoints(int n)
+{
+    vector<ofPoint>::iterator it;
+    ofPoint candidate;
+    float radius, currMinDist;
+    for (int i=0; i<n; i++)
+    {
+        bool done = false;
+        for (int attempt=0; attempt<CIRCLEPACK_MAX_ATTEMPTS && !done; attempt++)
+        {
+            done = true;
+            candidate = samplePointWithinBounds();
+            currMinDist = minDist;
+            for(it = points.begin(); it != points.end(); ++it)
+            {
+                float dist = ofDist(candidate.x, candidate.y, it->x, it->y) - it->z;
+                if (dist < 0)
+                {
+                    done = false;
+                    break;
+                }
+                else if (dist < currMinDist) {
+                    currMinDist = dist;
+                }
+            }
+            radius = currMinDist;
+        }
+        if (!done) {
+            return;
+        }
+        points.push_back(ofPoint(candidate.x, candidate.y, radius));
+    }
+}
+
+PointsBenchmark::PointsBenchmark()
+{
+    width = 0;
+    height = 0;
+    fullScanMax = POINTSBENCHMARK_FULL_SCAN_MAX;
+}
+
+void PointsBenchmark::setup(int width, int height, vector<int> counts, int fullScanMax)
+{
+    this->width = width;
+    this->height = height;
+    this->counts = counts;
+    this->fullScanMax = fullScanMax;
+}
+
+void PointsBenchmark::run(unsigned int seed)
+{
+    results.clear();
+    for (auto n : counts)
+    {
+        Result even;
+        even.generator = "even";
+        even.points = n;
+        EvenPointsGenerator evenGrid;
+        evenGrid.setBounds(0, 0, width, height);
+        evenGrid.setNumberCandidates(POINTSBENCHMARK_CANDIDATES);
+        even.gridMs = time(evenGrid, n, seed, even.gridPoints);
+        even.fullScanMs = -1;
+        even.fullScanPoints = 0;
+        if (n <= fullScanMax)
+        {
+            FullScanEvenPointsGenerator evenFull;
+            evenFull.setBounds(0, 0, width, height);
+            evenFull.setNumberCandidates(POINTSBENCHMARK_CANDIDATES);
+            even.fullScanMs = time(evenFull, n, seed, even.fullScanPoints);
+        }
+        results.push_back(even);
+
+        Result pack;
+        pack.generator = "packing";
+        pack.points = n;
+        CirclePackGenerator packGrid;
+        packGrid.setBounds(0, 0, width, height);
+        packGrid.setMinDist(POINTSBENCHMARK_MIN_DIST);
+        pack.gridMs = time(packGrid, n, seed, pack.gridPoints);
+        pack.fullScanMs = -1;
+        pack.fullScanPoints = 0;
+        if (n <= fullScanMax)
+        {
+            FullScanCirclePackGenerator packFull;
+            packFull.setBounds(0, 0, width, height);
+            packFull.setMinDist(POINTSBENCHMARK_MIN_DIST);
+            pack.fullScanMs = time(packFull, n, seed, pack.fullScanPoints);
+        }
+        results.push_back(pack);
+    }
+}
+
+float PointsBenchmark::time(PointGenerator &generator, int n, unsigned int seed, int &generated)
+{
+    ofSeedRandom(seed);
+    uint64_t start = ofGetElapsedTimeMicros();
+    generator.addPoints(n);
+    uint64_t duration = ofGetElapsedTimeMicros() - start;
+    generated = generator.getPoints().size();
+    return duration / 1000.0f;
+}
+
+bool PointsBenchmark::saveCsv(string path)
+{
+    ofstream file(path.c_str());
+    if (!file.is_open())
+    {
+        ofLog(OF_LOG_ERROR, "Can't write benchmark to "+path);
+        return false;
+    }
+    file << "generator,points,full_scan_points,full_scan_ms,grid_points,grid_ms" << endl;
+    for (auto & r : results)
+    {
+        file << r.generator << "," << r.points << "," << r.fullScanPoints << "," << r.fullScanMs << ","
+             << r.gridPoints << "," << r.gridMs << endl;
+    }
+    return true;
+}
+
+void PointsBenchmark::printSummary()
+{
+    cout << "point generation " << width << "x" << height << ", " << POINTSBENCHMARK_CANDIDATES
+         << " candidates, packing min dist " << POINTSBENCHMARK_MIN_DIST << endl;
+    for (auto & r : results)
+    {
+        cout << "  " << r.generator << " " << r.points << ": grid " << r.gridMs << " ms";
+        if (r.fullScanMs >= 0) {
+            cout << ", full scan " << r.fullScanMs << " ms";
+        }
+        if (r.gridPoints < r.points) {
+            cout << " (bounds full after " << r.gridPoints << ")";
+        }
+        cout << endl;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ofMain.h"
+#include "PointGeneration.h"
+
+#define POINTSBENCHMARK_CANDIDATES 10
+#define POINTSBENCHMARK_MIN_DIST 3
+#define POINTSBENCHMARK_FULL_SCAN_MAX 10000    // larger counts take minutes
+
+
+// The point generators as they were before the grid index: every candidate
+// is compared with every point so far. Kept as the baseline of the
+// benchmark; the packing also gives up after CIRCLEPACK_MAX_ATTEMPTS misses,
+// where it used to spin, so both finish when the bounds are full.
+
+class FullScanEvenPointsGenerator : public PointGenerator
+{
+public:
+    void addPoints(int n);
+    void setNumberCandidates(int numberCandidates) {this->numberCandidates = numberCandidates;}
+private:
+    int numberCandidates;
+};
+
+class FullScanCirclePackGenerator : public PointGenerator
+{
+public:
+    void addPoints(int n);
+    void setMinDist(float minDist) {this->minDist = minDist;}
+private:
+    float minDist;
+};
+
+
+// Times EvenPointsGenerator and CirclePackGenerator against the full scan
+// for each point count, in width x height bounds, from the same seed. The
+// full scan is skipped above fullScanMax points.
+
+class PointsBenchmark
+{
+public:
+    PointsBenchmark();
+
+    void setup(int width, int height, vector<int> counts, int fullScanMax=POINTSBENCHMARK_FULL_SCAN_MAX);
+    void run(unsigned int seed);
+
+    bool saveCsv(string path);
+    void printSummary();
+
+private:
+
+    struct Result
+    {
+        string generator;
+        int points;
+        int fullScanPoints, gridPoints;
+        float fullScanMs, gridMs;
+    };
+
+    float time(PointGenerator &generator, int n, unsigned int seed, int &generated);
+
+    int width, height;
+    vector<int> counts;
+    int fullScanMax;
+    vector<Result> results;
+};
@@ -0,0 +1,112 @@
+#include "StreakBatchCheck.h"
+
+
+StreakBatchCheck::StreakBatchCheck()
+{
+    maxThickness = 8;
+    streakAlpha = 200;
+    failures = 0;
+}
+
+void StreakBatchCheck::setupStreaks()
+{
+    // at the middle of its life, at birth, and never started
+    pos = {ofVec2f(10, 20), ofVec2f(100, 50), ofVec2f(0, 0)};
+    age = {5, 0, 0};
+    maxAge = {10, 10, 0};
+    color = {ofColor(255, 0, 0), ofColor(0, 255, 0), ofColor(0, 0, 255)};
+}
+
+bool StreakBatchCheck::run()
+{
+    failures = 0;
+    setupStreaks();
+
+    StreakBatch batch;
+    batch.resize(3);
+    batch.build(0, 3, pos, age, maxAge, color, maxThickness, streakAlpha);
+
+    expect(batch.getNumQuads() == 3, "3 quads");
+    expect(batch.getVertices().size() == 12, "4 vertices per quad");
+    expect(batch.getColors().size() == 12, "4 colours per quad");
+    expect(batch.getTexCoords().size() == 12, "4 texture coordinates per quad");
+    expect(batch.getIndices().size() == 18, "6 indices per quad");
+
+    // full size and alpha at half its age, centred on its position
+    const vector<ofVec2f> &vertices = batch.getVertices();
+    expect(near(vertices[0], 6, 16) && near(vertices[1], 14, 16) &&
+           near(vertices[2], 14, 24) && near(vertices[3], 6, 24), "quad 0 corners");
+    const vector<ofFloatColor> &colors = batch.getColors();
+    for (int v=0; v<4; v++) {
+        expect(near(colors[v], 1, 0, 0, streakAlpha / 255.0), "quad 0 colour");
+    }
+
+    // no size at birth, alpha starting from 1
+    for (int v=4; v<8; v++)
+    {
+        expect(near(vertices[v], 100, 50), "quad 1 collapsed on its position");
+        expect(near(colors[v], 0, 1, 0, 1 / 255.0), "quad 1 colour");
+    }
+
+    // a streak without a life is invisible
+    for (int v=8; v<12; v++) {
+        expect(near(vertices[v], 0, 0) && near(colors[v].a, 0), "quad 2 invisible");
+    }
+
+    const vector<ofVec2f> &texCoords = batch.getTexCoords();
+    expect(near(texCoords[4], 0, 0) && near(texCoords[5], 1, 0) &&
+           near(texCoords[6], 1, 1) && near(texCoords[7], 0, 1), "quad 1 texture coordinates");
+    const vector<ofIndexType> &indices = batch.getIndices();
+    expect(indices[6] == 4 && indices[7] == 5 && indices[8] == 6 &&
+           indices[9] == 4 && indices[10] == 6 && indices[11] == 7, "quad 1 indices");
+
+    // chunks, as on the pool, give the same arrays
+    StreakBatch chunked;
+    chunked.resize(3);
+    chunked.build(2, 3, pos, age, maxAge, color, maxThickness, streakAlpha);
+    chunked.build(0, 2, pos, age, maxAge, color, maxThickness, streakAlpha);
+    bool same = true;
+    for (int v=0; v<12; v++)
+    {
+        const ofVec2f &p = chunked.getVertices()[v];
+        const ofFloatColor &c = chunked.getColors()[v];
+        same = same && near(p, vertices[v].x, vertices[v].y) && near(c, colors[v].r, colors[v].g, colors[v].b, colors[v].a);
+    }
+    expect(same, "chunked build matches one pass");
+
+    // shrinking keeps the static arrays, growing extends them
+    batch.resize(2);
+    expect(batch.getNumQuads() == 2 && batch.getVertices().size() == 8, "shrink to 2 quads");
+    expect(batch.getIndices().size() == 18, "indices kept when shrinking");
+    batch.resize(5);
+    expect(batch.getIndices().size() == 30 && batch.getIndices()[29] == 19, "indices extended when growing");
+
+    if (failures == 0) {
+        cout << "StreakBatch: all checks passed" << endl;
+    }
+    return failures == 0;
+}
+
+void StreakBatchCheck::expect(bool condition, string what)
+{
+    if (!condition)
+    {
+        ofLog(OF_LOG_ERROR, "StreakBatch check failed: "+what);
+        failures++;
+    }
+}
+
+bool StreakBatchCheck::near(float a, float b)
+{
+    return abs(a - b) < STREAKBATCHCHECK_EPSILON;
+}
+
+bool StreakBatchCheck::near(const ofVec2f &a, float x, float y)
+{
+    return near(a.x, x) && near(a.y, y);
+}
+
+bool StreakBatchCheck::near(const ofFloatColor &a, float r, float g, float b, float alpha)
+{
+    return near(a.r, r) && near(a.g, g) && near(a.b, b) && near(a.a, alpha);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Rivers.h"
+
+#define STREAKBATCHCHECK_EPSILON 1e-5
+
+
+// Builds a StreakBatch from three fixed streaks, without a GL context, and
+// checks the quads through its getters: counts, corners, colours, texture
+// coordinates and indices, and that building in chunks as the worker pool
+// does gives the same arrays as one pass. Failures are logged.
+
+class StreakBatchCheck
+{
+public:
+    StreakBatchCheck();
+
+    bool run();
+
+private:
+
+    void setupStreaks();
+    void expect(bool condition, string what);
+    bool near(float a, float b);
+    bool near(const ofVec2f &a, float x, float y);
+    bool near(const ofFloatColor &a, float r, float g, float b, float alpha);
+
+    vector<ofVec2f> pos;
+    vector<float> age;
+    vector<float> maxAge;
+    vector<ofColor> color;
+    float maxThickness;
+    float streakAlpha;
+    int failures;
+};
@@ -0,0 +1,80 @@
+#include "ofMain.h"
+#include "ofApp.h"
+#include "StreakBatchCheck.h"
+
+// template_benchmark [--scene Rivers] [--modifiers PostGlitch,Shader]
+//     [--preset presets/name.xml] [--frames 600] [--warmup 30]
+//     [--size 800x600] [--seed 1] [--scene-only] [--out benchmark]
+//     [--uniforms 200] [--uniform-changes 10] [--uniform-block]
+//     [--points 1000,10000,100000] [--full-scan-max 10000]
+//     [--check-streaks]
+//
+// --uniforms runs a generated Shader with that many float parameters on its
+// own, instead of the scene, changing a few of them each frame; their upload
+// shows up as the stage Uniforms/uniforms. --uniform-block declares them in
+// the shader's parameter block, uploaded as one buffer.
+//
+// --points times the point generators against their old full scan at each
+// count instead, up to --full-scan-max points for the full scan, and
+// writes <out>.points.csv.
+//
+// --check-streaks builds a Rivers StreakBatch from fixed streaks and checks
+// its arrays, without opening a window; the exit code is 1 on failure.
+//
+// Writes <out>.csv, <out>.json and a Chrome trace <out>.trace.json, then
+// quits. Without a display, run it in a virtual one with software GL:
+//     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./template_benchmark --scene Rivers
+
+//========================================================================
+int main(int argc, char *argv[]){
+    ofApp *app = new ofApp();
+    bool checkStreaks = false;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+        if      (arg == "--scene")      {app->sceneName = value; i++;}
+        else if (arg == "--modifiers")  {app->modifierNames = ofSplitString(value, ",", true, true); i++;}
+        else if (arg == "--preset")     {app->preset = value; i++;}
+        else if (arg == "--frames")     {app->numFrames = ofToInt(value); i++;}
+        else if (arg == "--warmup")     {app->numWarmup = ofToInt(value); i++;}
+        else if (arg == "--seed")       {app->seed = ofToInt(value); i++;}
+        else if (arg == "--out")        {app->out = value; i++;}
+        else if (arg == "--scene-only") {app->sceneOnly = true;}
+        else if (arg == "--uniforms")   {app->numUniforms = ofToInt(value); i++;}
+        else if (arg == "--uniform-changes") {app->numUniformChanges = ofToInt(value); i++;}
+        else if (arg == "--uniform-block")   {app->uniformBlock = true;}
+        else if (arg == "--check-streaks")   {checkStreaks = true;}
+        else if (arg == "--full-scan-max")   {app->fullScanMax = ofToInt(value); i++;}
+        else if (arg == "--points")
+        {
+            for (auto & n : ofSplitString(value, ",", true, true)) {
+                app->pointCounts.push_back(ofToInt(n));
+            }
+            i++;
+        }
+        else if (arg == "--size")
+        {
+            vector<string> size = ofSplitString(value, "x");
+            if (size.size() == 2)
+            {
+                app->width = ofToInt(size[0]);
+                app->height = ofToInt(size[1]);
+            }
+            i++;
+        }
+        else {
+            ofLog(OF_LOG_WARNING, "Unknown argument "+arg);
+        }
+    }
+    
+    if (checkStreaks)
+    {
+        delete app;
+        return StreakBatchCheck().run() ? 0 : 1;
+    }
+    
+	ofSetupOpenGL(app->width, app->height, OF_WINDOW);			// <-------- setup the GL context
+	ofRunApp(app);
+}
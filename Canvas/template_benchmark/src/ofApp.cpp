@@ -0,0 +1,171 @@
+#include "ofApp.h"
+
+ofApp::ofApp()
+{
+    sceneName = "Rivers";
+    numFrames = 600;
+    numWarmup = CANVASBENCHMARK_WARMUP;
+    width = 800;
+    height = 600;
+    seed = 1;
+    sceneOnly = false;
+    out = "benchmark";
+    numUniforms = 0;
+    numUniformChanges = 0;
+    uniformBlock = false;
+    fullScanMax = POINTSBENCHMARK_FULL_SCAN_MAX;
+    scene = NULL;
+    uniformShader = NULL;
+    uniformCursor = 0;
+}
+
+void ofApp::setup()
+{
+    ofSetVerticalSync(false);
+    ofSetFrameRate(0);
+    
+    // shaders, fonts and presets of the simple template
+    ofSetDataPathRoot("../../template_simple/bin/data/");
+    
+    CanvasBenchmark::seed(seed);
+    
+    // point generation only needs the cpu, it runs here and quits
+    if (!pointCounts.empty())
+    {
+        PointsBenchmark points;
+        points.setup(width, height, pointCounts, fullScanMax);
+        points.run(seed);
+        points.saveCsv(out + ".points.csv");
+        points.printSummary();
+        ofExit();
+        return;
+    }
+    
+    scene = numUniforms > 0 ? createUniformShader() : createScene(sceneName);
+    if (scene == NULL)
+    {
+        ofLog(OF_LOG_ERROR, "No scene named "+sceneName);
+        ofExit(1);
+        return;
+    }
+    
+    if (sceneOnly || numUniforms > 0)
+    {
+        scene->setup(width, height);
+        benchmark.setup(scene, width, height, numFrames, numWarmup);
+        return;
+    }
+    
+    canvas.setup("Canvas", width, height);
+    canvas.addCreator(scene);
+    for (auto m : modifierNames)
+    {
+        if      (m == "Shader")          canvas.addShaderModifier();
+        else if (m == "PostProcessing")  canvas.addPostProcessing();
+        else if (m == "PostFX")          canvas.addPostFX();
+        else if (m == "PostGlitch")      canvas.addPostGlitch();
+        else if (m == "FilterLib")       canvas.addFilterLibrary();
+        else    ofLog(OF_LOG_WARNING, "No modifier named "+m);
+    }
+    if (preset != "") {
+        canvas.loadPreset(preset);
+    }
+    canvas.toggleGuiVisible();
+    benchmark.setup(&canvas, numFrames, numWarmup);
+}
+
+void ofApp::update()
+{
+    if (benchmark.isFinished())
+    {
+        benchmark.saveCsv(out + ".csv");
+        benchmark.saveJson(out + ".json");
+        Profiler::getShared().saveTrace(out + ".trace.json");
+        benchmark.printSummary();
+        ofExit();
+        return;
+    }
+    changeUniforms();
+    benchmark.update();
+}
+
+void ofApp::draw()
+{
+    benchmark.draw();
+}
+
+Scene * ofApp::createUniformShader()
+{
+    // a fragment shader reading numUniforms floats, plain or in the block
+    stringstream frag;
+    frag << "#version 120" << endl;
+    if (uniformBlock) {
+        frag << "#extension GL_ARB_uniform_buffer_object : require" << endl;
+    }
+    frag << "uniform float time;" << endl;
+    frag << "uniform vec2 resolution;" << endl;
+    if (uniformBlock) {
+        frag << "layout(std140) uniform " << SHADER_UNIFORM_BLOCK << " {" << endl;
+    }
+    for (int i = 0; i < numUniforms; i++) {
+        frag << (uniformBlock ? "    float p" : "uniform float p") << i << ";" << endl;
+    }
+    if (uniformBlock) {
+        frag << "};" << endl;
+    }
+    frag << "void main() {" << endl;
+    frag << "    float v = 0.0;" << endl;
+    for (int i = 0; i < numUniforms; i++) {
+        frag << "    v += p" << i << ";" << endl;
+    }
+    frag << "    gl_FragColor = vec4(vec3(fract(v + time)), 1.0);" << endl;
+    frag << "}" << endl;
+    
+    string fragPath = ofFilePath::getAbsolutePath(out + ".uniforms.frag", false);
+    ofBuffer buffer(frag.str());
+    if (!ofBufferToFile(fragPath, buffer))
+    {
+        ofLog(OF_LOG_ERROR, "Can't write "+fragPath);
+        return NULL;
+    }
+    
+    Shader *shader = new Shader(true);
+    shader->setName("Uniforms");
+    uniformShader = shader->createShader("Uniforms", "shaders_color/standard.vert", fragPath);
+    for (int i = 0; i < numUniforms; i++) {
+        uniformShader->addParameter("p" + ofToString(i), 0, 1);
+    }
+    shader->selectShader("Uniforms");
+    return shader;
+}
+
+void ofApp::changeUniforms()
+{
+    // a few parameters move each frame, as if from sliders or the sequencer
+    if (uniformShader == NULL)  return;
+    for (int i = 0; i < numUniformChanges; i++)
+    {
+        ShaderParameterBase *p = uniformShader->shaderParameters[uniformCursor];
+        float *value = ((ShaderParameter<float> *) p)->value;
+        *value = fmod(*value + 0.01f, 1.0f);
+        uniformCursor = (uniformCursor + 1) % numUniforms;
+    }
+}
+
+Scene * ofApp::createScene(string name)
+{
+    if      (name == "Agents")      return new Agents();
+    else if (name == "Amoeba")      return new Amoeba();
+    else if (name == "Bubbles")     return new Bubbles();
+    else if (name == "Cubes")       return new Cubes();
+    else if (name == "DebugScreen") return new DebugScreen();
+    else if (name == "GridFly")     return new GridFly();
+    else if (name == "Letters")     return new Letters();
+    else if (name == "Meshy")       return new Meshy();
+    else if (name == "MediaPlayer") return new MediaPlayer();
+    else if (name == "Polar")       return new Polar();
+    else if (name == "Rivers")      return new Rivers();
+    else if (name == "Shader")      return new Shader(true);
+    else if (name == "Subdivide")   return new Subdivide();
+    return NULL;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "Control.h"
+
+#include "Agents.h"
+#include "Amoeba.h"
+#include "Bubbles.h"
+#include "Cubes.h"
+#include "DebugScreen.h"
+#include "GridFly.h"
+#include "Letters.h"
+#include "Meshy.h"
+#include "MediaPlayer.h"
+#include "Polar.h"
+#include "Rivers.h"
+#include "Subdivide.h"
+#include "Shader.h"
+
+#include "Canvas.h"
+#include "CanvasBenchmark.h"
+#include "PointsBenchmark.h"
+
+
+class ofApp : public ofBaseApp
+{
+public:
+    ofApp();
+    
+    void setup();
+    void update();
+    void draw();
+    
+    Scene * createScene(string name);
+    Scene * createUniformShader();
+    void changeUniforms();
+    
+    // from the command line
+    string sceneName;
+    vector<string> modifierNames;
+    string preset;
+    int numFrames, numWarmup;
+    int width, height;
+    unsigned int seed;
+    bool sceneOnly;
+    string out;
+    int numUniforms, numUniformChanges;
+    bool uniformBlock;
+    vector<int> pointCounts;
+    int fullScanMax;
+    
+    Canvas canvas;
+    Scene *scene;
+    CanvasBenchmark benchmark;
+    Shader::ShaderData *uniformShader;
+    int uniformCursor;
+};
@@ -3,8 +3,26 @@
 Bpm::Bpm(float bpm,int beatPerBar) : beatPerBar(beatPerBar)
 {
     isPlaying = false;
-    isTick = false;
+    autoUpdate = false;
+    wakeup = false;
+    durationOfBeat = 0;
+    originTime = getTimeMicros();
+    countOfBeat = 0;
+    beatIndex = 0;
     setBpm(bpm);
+    resetJitter();
+    setAutoUpdate(true);
+}
+
+Bpm::~Bpm()
+{
+    stop();
+    setAutoUpdate(false);
+}
+
+int64_t Bpm::getTimeMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 void Bpm::start()
@@ -17,82 +35,160 @@ void Bpm::start()
 
 void Bpm::stop()
 {
-    waitForThread(true);
-    isPlaying = false;
     stopThread();
+    isPlaying = false;
+    wakeThread();
+    waitForThread(false);
 }
 
 void Bpm::reset()
 {
     if(lock())
     {
-        
-        remainderOfTick = 0;
-        countOfTick = -1;
-        preTime = ofGetElapsedTimeMicros();
-        totalTime = 0;
-        
+        originTime = getTimeMicros();
+        countOfBeat = 0;
+        beatIndex = 0;
         unlock();
     }
+    wakeThread();
+}
+
+void Bpm::resetJitter()
+{
+    jitterLast = 0;
+    jitterMean = 0;
+    jitterMax = 0;
+    jitterCount = 0;
+}
+
+void Bpm::wakeThread()
+{
+    {
+        std::lock_guard<std::mutex> sleepLock(sleepMutex);
+        wakeup = true;
+    }
+    sleepCondition.notify_all();
+}
+
+void Bpm::rebase(int64_t originTime)
+{
+    this->originTime = originTime;
+    countOfBeat = 1;
+}
+
+void Bpm::measureJitter(int64_t deadline, int64_t now)
+{
+    jitterLast = now - deadline;
+    jitterMax = max(jitterMax, jitterLast);
+    jitterCount++;
+    jitterMean += (jitterLast - jitterMean) / jitterCount;
 }
 
 void Bpm::threadedFunction()
 {
-    while (isThreadRunning() != 0)
+    while (isThreadRunning())
     {
-        if (lock())
+        int64_t deadline;
+        if (!lock()) continue;
+        deadline = originTime + (int64_t) (countOfBeat * durationOfBeat);
+        unlock();
+
         {
-            if (isPlaying)
+            std::unique_lock<std::mutex> sleepLock(sleepMutex);
+            std::chrono::steady_clock::time_point wakeTime(std::chrono::microseconds(deadline - BPM_SPIN_MICROS));
+            sleepCondition.wait_until(sleepLock, wakeTime, [this] { return wakeup; });
+            if (wakeup)
             {
-                long nowTime = ofGetElapsedTimeMicros();
-                long deltaTime = nowTime - preTime;
-                preTime = nowTime;
-                
-                if (totalTime + remainderOfTick >= durationOfTick)
-                {
-                    if ((countOfTick % (BPM_TICK / beatPerBar)) == 0)
-                    {
-                        ofNotifyEvent(beatEvent);
-                    }
-                    
-                    remainderOfTick = (totalTime + remainderOfTick) % durationOfTick;
-                    totalTime = 0.;
-                    isTick = true;
-                    
-                    countOfTick++;
-                    countOfTick %= BPM_TICK;
-                }
-                else
-                {
-                    isTick = false;
-                }
-                
-                totalTime += deltaTime;
-                
-                unlock();
-                yield();
+                // tempo changed, clock reset or stopped: reschedule
+                wakeup = false;
+                continue;
             }
         }
+
+        while (getTimeMicros() < deadline && isThreadRunning()) {
+            yield();
+        }
+
+        if (!lock()) continue;
+        int64_t now = getTimeMicros();
+        if (!isPlaying || now < originTime + (int64_t) (countOfBeat * durationOfBeat))
+        {
+            unlock();
+            continue;
+        }
+
+        // after a stall longer than a beat, drop the missed beats instead of
+        // firing them back to back
+        if (now - deadline > durationOfBeat) {
+            countOfBeat = (int64_t) ((now - originTime) / durationOfBeat);
+            deadline = originTime + (int64_t) (countOfBeat * durationOfBeat);
+        }
+        measureJitter(deadline, now);
+        countOfBeat++;
+        BpmEventArgs beat;
+        beat.beat = beatIndex++;
+        beat.time = deadline;
+        unlock();
+
+        beatQueue.push(beat);
     }
 }
 
-void Bpm::setBeatPerBar(int beatPerBar)
+void Bpm::setAutoUpdate(bool autoUpdate)
 {
-    if (lock())
-    {
-        beatPerBar = beatPerBar;
-        unlock();
+    if (autoUpdate == this->autoUpdate) return;
+    this->autoUpdate = autoUpdate;
+    if (autoUpdate) {
+        ofAddListener(ofEvents().update, this, &Bpm::eventUpdate);
+    }
+    else {
+        ofRemoveListener(ofEvents().update, this, &Bpm::eventUpdate);
+    }
+}
+
+void Bpm::eventUpdate(ofEventArgs &e)
+{
+    update();
+}
+
+void Bpm::update()
+{
+    BpmEventArgs beat;
+    while (beatQueue.pop(beat)) {
+        ofNotifyEvent(beatEvent, beat);
     }
 }
 
+bool Bpm::getNextBeat(BpmEventArgs & beat)
+{
+    return beatQueue.pop(beat);
+}
+
+void Bpm::setBeatPerBar(int beatPerBar)
+{
+    setTempo(bpm, beatPerBar);
+}
+
 void Bpm::setBpm(float bpm)
+{
+    setTempo(bpm, beatPerBar);
+}
+
+void Bpm::setTempo(float bpm, int beatPerBar)
 {
     if(lock())
     {
+        // keep the phase of the last beat so tempo changes don't jump
+        int64_t lastBeatTime = originTime + (int64_t) ((countOfBeat - 1) * durationOfBeat);
         this->bpm = bpm;
-        durationOfTick = 60. * 1000. * 1000. / (bpm * (BPM_TICK >> 2));
+        this->beatPerBar = beatPerBar;
+        durationOfBeat = 60. * 1000. * 1000. * (BPM_TICK / beatPerBar) / (bpm * (BPM_TICK >> 2));
+        if (countOfBeat > 0) {
+            rebase(lastBeatTime);
+        }
         unlock();
     }
+    wakeThread();
 }
 
 float Bpm::getBpm() const
@@ -5,41 +5,91 @@
 #pragma once
 
 #include "ofMain.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "LockFreeQueue.h"
+
+
+struct BpmEventArgs
+{
+    int64_t beat;   // beats since the clock was started or reset
+    int64_t time;   // scheduled time of the beat, see Bpm::getTimeMicros()
+};
 
 class Bpm : private ofThread
 {
 public:
     static const int BPM_TICK = 960;
-    
+
+    // the clock sleeps until this many microseconds before a deadline,
+    // then yields through the remainder to hit it precisely
+    static const int BPM_SPIN_MICROS = 1000;
+    static const int BPM_QUEUE_SIZE = 256;
+
     explicit Bpm(float bpm = 120.0, int beatPerBar = 4);
-    
+    ~Bpm();
+
     void start();
     void stop();
     void reset();
-    
+
     void setBpm(float bpm);
     float getBpm() const;
-    
+
     void setBeatPerBar(int beatPerBar);
-    
+
     bool getPlaying() const;
-    
-    ofEvent<void> beatEvent;
-    
+
+    // the clock thread only enqueues beats; they are delivered through
+    // beatEvent on whichever thread calls update(), by default the app's
+    // update loop. disable auto update to drain from another thread.
+    void setAutoUpdate(bool autoUpdate);
+    void update();
+    bool getNextBeat(BpmEventArgs & beat);
+    size_t getNumDroppedBeats() const {return beatQueue.getNumDropped();}
+
+    // jitter is the lateness of each beat against its deadline, in microseconds
+    float getJitter() const {return jitterLast;}
+    float getJitterMean() const {return jitterMean;}
+    float getJitterMax() const {return jitterMax;}
+    void resetJitter();
+
+    // monotonic microseconds shared by the clock and its listeners
+    static int64_t getTimeMicros();
+
+    ofEvent<BpmEventArgs> beatEvent;
+
 private:
-    
+
     void threadedFunction();
-    
-    inline int getCountOfTick() const;
-    
+    void eventUpdate(ofEventArgs &e);
+
+    void setTempo(float bpm, int beatPerBar);
+    void wakeThread();
+    void rebase(int64_t originTime);
+    void measureJitter(int64_t deadline, int64_t now);
+
     float bpm;
-    bool isTick;
     bool isPlaying;
-    int countOfTick;
-    long totalTime;
-    long durationOfTick;
-    long remainderOfTick;
-    
-    float preTime;
+    bool autoUpdate;
     int beatPerBar;
+
+    // beats are scheduled as origin + n * duration, so rounding errors and
+    // late wakeups never accumulate across beats
+    int64_t originTime;
+    int64_t countOfBeat;
+    double durationOfBeat;
+    int64_t beatIndex;
+
+    LockFreeQueue<BpmEventArgs, BPM_QUEUE_SIZE> beatQueue;
+
+    float jitterLast;
+    float jitterMean;
+    float jitterMax;
+    int64_t jitterCount;
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool wakeup;
 };
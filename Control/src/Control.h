@@ -26,6 +26,7 @@
 #include "GuiWidget.h"
 #include "GuiPanel.h"
 
+#include "LockFreeQueue.h"
 #include "Bpm.h"
 #include "Sequence.h"
 #include "Sequencer.h"
@@ -35,6 +36,7 @@
 #include "OscManager.h"
 #include "OscManagerPanel.h"
 
+#include "MidiNoteStore.h"
 #include "MidiSequencer.h"
 // midi sequencer?
 
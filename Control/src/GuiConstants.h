@@ -65,6 +65,8 @@ static int      MIDISEQUENCER_DEFAULT_TIMEBAR_HEIGHT    = 16;
 
 static int      MIDISEQUENCER_DEFAULT_BPM               = 360;
 static int      MIDISEQUENCER_DEFAULT_MEASURES          = 12;
+static int      MIDISEQUENCER_DEFAULT_LOOKAHEAD         = 100;
+static float    MIDISEQUENCER_DEFAULT_SWING             = 0.0;
 static int      MIDISEQUENCER_DEFAULT_NOTE_MIN          = 60;
 static int      MIDISEQUENCER_DEFAULT_NOTE_MAX          = 78;
 static float    MIDISEQUENCER_DEFAULT_START             = 0.0;
@@ -78,3 +80,5 @@ static ofColor  MIDISEQUENCER_DEFAULT_COLOR_ACTIVE      = ofColor(160, 240, 20);
 // OSC MANAGER
 
 static int      GUI_DEFAULT_OSCMANAGER_WIDTH            = 480;
+static int      GUI_DEFAULT_OSCMANAGER_SEND_INTERVAL    = 0;
+static int      GUI_DEFAULT_OSCMANAGER_MAX_BUNDLE_SIZE  = 1400;
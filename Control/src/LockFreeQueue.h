@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+
+// Fixed-capacity single-producer/single-consumer ring. push() may only be
+// called from one thread and pop() from one (other) thread; neither blocks.
+
+template <typename T, size_t N>
+class LockFreeQueue
+{
+public:
+    LockFreeQueue() : head(0), tail(0), dropped(0) { }
+
+    bool push(const T & item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) % (N + 1);
+        if (next == head.load(std::memory_order_acquire))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[t] = item;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T & item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[h];
+        head.store((h + 1) % (N + 1), std::memory_order_release);
+        return true;
+    }
+
+    bool peek(T & item) const
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[h];
+        return true;
+    }
+
+    bool empty() const {return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);}
+    size_t getCapacity() const {return N;}
+    size_t getNumDropped() const {return dropped.load(std::memory_order_relaxed);}
+
+private:
+    T items[N + 1];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<size_t> dropped;
+};
@@ -0,0 +1,156 @@
+#include "MidiNoteStore.h"
+#include <climits>
+
+
+MidiNote::MidiNote(int note, int velocity, int start, int end)
+{
+    this->note = note;
+    this->velocity = velocity;
+    this->start = start;
+    this->end = end;
+    this->offset = 0;
+}
+
+bool MidiNoteStore::Key::operator<(const Key &other) const
+{
+    return beat < other.beat || (beat == other.beat && id < other.id);
+}
+
+MidiNoteStore::MidiNoteStore()
+{
+}
+
+int MidiNoteStore::add(const MidiNote &note)
+{
+    int id;
+    if (freeIds.size() > 0)
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else
+    {
+        id = slots.size();
+        slots.push_back(-1);
+    }
+    slots[id] = notes.size();
+    notes.push_back(note);
+    ids.push_back(id);
+    byStart.insert(Key(note.start, id));
+    byEnd.insert(Key(note.end, id));
+    cover(id, note.start, note.end);
+    return id;
+}
+
+void MidiNoteStore::remove(int id)
+{
+    if (!contains(id)) return;
+    int slot = slots[id];
+    byStart.erase(Key(notes[slot].start, id));
+    byEnd.erase(Key(notes[slot].end, id));
+    uncover(id, notes[slot].start, notes[slot].end);
+
+    int last = notes.size() - 1;
+    notes[slot] = notes[last];
+    ids[slot] = ids[last];
+    slots[ids[slot]] = slot;
+    notes.pop_back();
+    ids.pop_back();
+
+    slots[id] = -1;
+    freeIds.push_back(id);
+}
+
+void MidiNoteStore::clear()
+{
+    notes.clear();
+    ids.clear();
+    slots.clear();
+    freeIds.clear();
+    byStart.clear();
+    byEnd.clear();
+    covering.clear();
+}
+
+void MidiNoteStore::setTiming(int id, int start, int end)
+{
+    MidiNote &note = notes[slots[id]];
+    if (note.start == start && note.end == end) return;
+    uncover(id, note.start, note.end);
+    cover(id, start, end);
+    if (note.start != start)
+    {
+        byStart.erase(Key(note.start, id));
+        byStart.insert(Key(start, id));
+        note.start = start;
+    }
+    if (note.end != end)
+    {
+        byEnd.erase(Key(note.end, id));
+        byEnd.insert(Key(end, id));
+        note.end = end;
+    }
+}
+
+void MidiNoteStore::getStartingAt(int beat, vector<int> &result) const
+{
+    getAt(byStart, beat, result);
+}
+
+void MidiNoteStore::getEndingAt(int beat, vector<int> &result) const
+{
+    getAt(byEnd, beat, result);
+}
+
+void MidiNoteStore::getInRange(int start, int end, vector<int> &result) const
+{
+    // a note overlapping [start, end] either spans start or begins after it,
+    // at its start beat or, when it was dragged backwards, at its end beat
+    map<int, vector<int> >::const_iterator c = covering.find(start);
+    if (c != covering.end()) {
+        result.insert(result.end(), c->second.begin(), c->second.end());
+    }
+    set<Key>::const_iterator it = byStart.upper_bound(Key(start, INT_MAX));
+    for (; it != byStart.end() && it->beat <= end; ++it)
+    {
+        const MidiNote &note = notes[slots[it->id]];
+        if (note.start <= note.end) {
+            result.push_back(it->id);
+        }
+    }
+    it = byEnd.upper_bound(Key(start, INT_MAX));
+    for (; it != byEnd.end() && it->beat <= end; ++it)
+    {
+        const MidiNote &note = notes[slots[it->id]];
+        if (note.end < note.start) {
+            result.push_back(it->id);
+        }
+    }
+}
+
+void MidiNoteStore::getAt(const set<Key> &index, int beat, vector<int> &result) const
+{
+    set<Key>::const_iterator it = index.lower_bound(Key(beat, INT_MIN));
+    for (; it != index.end() && it->beat == beat; ++it) {
+        result.push_back(it->id);
+    }
+}
+
+void MidiNoteStore::cover(int id, int start, int end)
+{
+    for (int beat = min(start, end); beat <= max(start, end); beat++) {
+        covering[beat].push_back(id);
+    }
+}
+
+void MidiNoteStore::uncover(int id, int start, int end)
+{
+    for (int beat = min(start, end); beat <= max(start, end); beat++)
+    {
+        vector<int> &ids = covering[beat];
+        ids.erase(find(ids.begin(), ids.end(), id));
+        if (ids.empty()) {
+            covering.erase(beat);
+        }
+    }
+}
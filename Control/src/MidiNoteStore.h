@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ofMain.h"
+
+
+struct MidiNote
+{
+    int note, velocity;
+    int start, end;
+    float offset;   // micro-timing in fractions of a beat
+    MidiNote(int note=0, int velocity=0, int start=0, int end=0);
+};
+
+
+// Notes are kept by value in one contiguous vector. Each note has a stable
+// id mapping to its slot, so removal swaps the last note into the hole.
+// Ordered sets by start and by end beat answer per-beat lookups in
+// O(log n + k). Every beat a note spans also lists it, so the notes
+// overlapping a range are the ones listed at its first beat plus the ones
+// beginning after it, also O(log n + k) however long the notes are. Adding,
+// moving and removing a note cost O(log n) plus its length in beats.
+
+class MidiNoteStore
+{
+public:
+    MidiNoteStore();
+
+    int add(const MidiNote &note);
+    void remove(int id);
+    void clear();
+
+    void setTiming(int id, int start, int end);
+    void setNote(int id, int note) {notes[slots[id]].note = note;}
+    void setVelocity(int id, int velocity) {notes[slots[id]].velocity = velocity;}
+    void setOffset(int id, float offset) {notes[slots[id]].offset = offset;}
+
+    const MidiNote & get(int id) const {return notes[slots[id]];}
+    bool contains(int id) const {return id >= 0 && id < slots.size() && slots[id] != -1;}
+    int size() const {return notes.size();}
+
+    void getStartingAt(int beat, vector<int> &result) const;
+    void getEndingAt(int beat, vector<int> &result) const;
+    void getInRange(int start, int end, vector<int> &result) const;
+
+private:
+
+    struct Key
+    {
+        int beat, id;
+        Key(int beat, int id) : beat(beat), id(id) { }
+        bool operator<(const Key &other) const;
+    };
+
+    void getAt(const set<Key> &index, int beat, vector<int> &result) const;
+    void cover(int id, int start, int end);
+    void uncover(int id, int start, int end);
+
+    vector<MidiNote> notes;
+    vector<int> ids;
+    vector<int> slots;
+    vector<int> freeIds;
+    set<Key> byStart;
+    set<Key> byEnd;
+    map<int, vector<int> > covering;
+};
@@ -1,31 +1,133 @@
 #include "MidiSequencer.h"
 
 
-MidiEventArgs::MidiEventArgs(int type, int note, int velocity)
+MidiEventArgs::MidiEventArgs(int type, int note, int velocity, int64_t time)
 {
     this->type = type;
     this->note = note;
     this->velocity = velocity;
+    this->time = time;
 }
 
-
-MidiSequencer::MidiSequencerEvent::MidiSequencerEvent(int note, int velocity, int start, int end) : GuiElement("midiEvent")
+MidiEventArgs::MidiEventArgs(int type, int note, int velocity)
 {
-    this->start = start;
-    this->end = end;
+    this->type = type;
     this->note = note;
     this->velocity = velocity;
-    
-    GuiElement::setAutoUpdate(false);
-    GuiElement::setAutoDraw(false);
+    this->time = Bpm::getTimeMicros();
 }
 
-void MidiSequencer::MidiSequencerEvent::draw()
+
+MidiSequencer::MidiScheduler::MidiScheduler(MidiSequencer *sequencer)
 {
-    ofRect(rectangle);
+    this->sequencer = sequencer;
+    pendingChanged = false;
+    startThread(true, false);
+}
+
+MidiSequencer::MidiScheduler::~MidiScheduler()
+{
+    stopThread();
+    {
+        std::lock_guard<std::mutex> pendingLock(pendingMutex);
+        pendingChanged = true;
+    }
+    pendingCondition.notify_all();
+    waitForThread(false);
 }
 
-MidiSequencer::MidiSequencer(string name) : GuiWidget(name)
+bool MidiSequencer::MidiScheduler::Later::operator()(const MidiEventArgs &a, const MidiEventArgs &b) const
+{
+    // note-offs go first when they coincide with a note-on
+    return a.time > b.time || (a.time == b.time && a.type > b.type);
+}
+
+void MidiSequencer::MidiScheduler::schedule(vector<MidiEventArgs> &events)
+{
+    if (events.size() == 0) return;
+    {
+        std::lock_guard<std::mutex> pendingLock(pendingMutex);
+        for (auto &e : events) {
+            pending.push(e);
+        }
+        pendingChanged = true;
+    }
+    pendingCondition.notify_all();
+}
+
+void MidiSequencer::MidiScheduler::send(MidiEventArgs &event)
+{
+    vector<MidiEventArgs> events(1, event);
+    schedule(events);
+}
+
+void MidiSequencer::MidiScheduler::clear(bool flushNoteOffs)
+{
+    {
+        std::lock_guard<std::mutex> pendingLock(pendingMutex);
+        priority_queue<MidiEventArgs, vector<MidiEventArgs>, Later> flushed;
+        int64_t now = Bpm::getTimeMicros();
+        while (!pending.empty())
+        {
+            MidiEventArgs e = pending.top();
+            pending.pop();
+            if (flushNoteOffs && e.type == 0)
+            {
+                e.time = now;
+                flushed.push(e);
+            }
+        }
+        pending.swap(flushed);
+        pendingChanged = true;
+    }
+    pendingCondition.notify_all();
+}
+
+void MidiSequencer::MidiScheduler::threadedFunction()
+{
+    vector<MidiEventArgs> due;
+    while (isThreadRunning())
+    {
+        int64_t deadline;
+        {
+            std::unique_lock<std::mutex> pendingLock(pendingMutex);
+            if (pending.empty())
+            {
+                pendingCondition.wait(pendingLock, [this] { return pendingChanged; });
+                pendingChanged = false;
+                continue;
+            }
+            deadline = pending.top().time;
+            std::chrono::steady_clock::time_point wakeTime(std::chrono::microseconds(deadline - Bpm::BPM_SPIN_MICROS));
+            pendingCondition.wait_until(pendingLock, wakeTime, [this] { return pendingChanged; });
+            if (pendingChanged)
+            {
+                pendingChanged = false;
+                continue;
+            }
+        }
+        
+        while (Bpm::getTimeMicros() < deadline && isThreadRunning()) {
+            yield();
+        }
+        
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex);
+            int64_t now = Bpm::getTimeMicros();
+            while (!pending.empty() && pending.top().time <= now)
+            {
+                due.push_back(pending.top());
+                pending.pop();
+            }
+        }
+        for (auto &e : due) {
+            ofNotifyEvent(sequencer->midiEvent, e, sequencer);
+        }
+        due.clear();
+    }
+}
+
+MidiSequencer::MidiSequencer(string name) : GuiWidget(name), scheduler(this)
 {
     cout << "CREATE MIDI SEQUENCER " << name << " " << this <<endl;
     
@@ -39,6 +141,9 @@ MidiSequencer::MidiSequencer(string name) : GuiWidget(name)
 
     bpm = MIDISEQUENCER_DEFAULT_BPM;
     measures = MIDISEQUENCER_DEFAULT_MEASURES;
+    lookAhead = MIDISEQUENCER_DEFAULT_LOOKAHEAD;
+    swing = MIDISEQUENCER_DEFAULT_SWING;
+    offset = 0.0;
     noteMin = MIDISEQUENCER_DEFAULT_NOTE_MIN;
     noteMax = MIDISEQUENCER_DEFAULT_NOTE_MAX;
     start = MIDISEQUENCER_DEFAULT_START;
@@ -50,9 +155,8 @@ MidiSequencer::MidiSequencer(string name) : GuiWidget(name)
 
     setupKeys();
  
-    newEvent = new MidiSequencerEvent(0, 0, 0, 0);
-    selectedEvent = NULL;
-    mouseOverEvent = NULL;
+    selectedEvent = -1;
+    mouseOverEvent = -1;
     mouseOverGrid = false;
     mouseOverKeyboard = false;
     mouseOverVelocity = false;
@@ -77,6 +181,9 @@ MidiSequencer::MidiSequencer(string name) : GuiWidget(name)
     sBpm = new GuiSlider<int>("bpm", &bpm, 10, 1200, this, &MidiSequencer::eventSetBpm);
     sPeriod = new GuiSlider<int>("measures", &measures, 4, 100, this, &MidiSequencer::eventSetPeriod);
     rTime = new GuiRangeSlider<float>("", &start, &end, 0.0f, 1.0f, this, &MidiSequencer::eventSetTimeView);
+    sSwing = new GuiSlider<float>("swing", &swing, 0.0f, 0.5f, this, &MidiSequencer::eventSetSwing);
+    sLookAhead = new GuiSlider<int>("look-ahead", &lookAhead, 0, 500, this, &MidiSequencer::eventSetLookAhead);
+    sOffset = new GuiSlider<float>("offset", &offset, -0.5f, 0.5f, this, &MidiSequencer::eventSetOffset);
 
     play->setParent(this);
     pause->setParent(this);
@@ -84,23 +191,32 @@ MidiSequencer::MidiSequencer(string name) : GuiWidget(name)
     sBpm->setParent(this);
     sPeriod->setParent(this);
     rTime->setParent(this);
+    sSwing->setParent(this);
+    sLookAhead->setParent(this);
+    sOffset->setParent(this);
     play->setAutoUpdate(false);
     pause->setAutoUpdate(false);
     stop->setAutoUpdate(false);
     sBpm->setAutoUpdate(false);
     sPeriod->setAutoUpdate(false);
     rTime->setAutoUpdate(false);
+    sSwing->setAutoUpdate(false);
+    sLookAhead->setAutoUpdate(false);
+    sOffset->setAutoUpdate(false);
     play->setAutoDraw(false);
     pause->setAutoDraw(false);
     stop->setAutoDraw(false);
     sBpm->setAutoDraw(false);
     sPeriod->setAutoDraw(false);
     rTime->setAutoDraw(false);
+    sSwing->setAutoDraw(false);
+    sLookAhead->setAutoDraw(false);
+    sOffset->setAutoDraw(false);
     
     shift = false;
 
     beat = 0;
-    clock.setBeatPerBar(1);
+    scheduledBeat = -1;
     ofAddListener(clock.beatEvent, this, &MidiSequencer::eventBeat);
 
     setBpm(bpm);
@@ -128,10 +244,6 @@ void MidiSequencer::setupKeys()
 
 MidiSequencer::~MidiSequencer()
 {
-    for (auto m : events) {
-        delete m;
-    }
-    events.clear();
     ofRemoveListener(clock.beatEvent, this, &MidiSequencer::eventBeat);
 }
 
@@ -139,13 +251,12 @@ void MidiSequencer::setActive(bool active)
 {
     this->active = active;
     active ? clock.start() : clock.stop();
+    resetSchedule(true);
 }
 
 void MidiSequencer::setNumberBeats(int numBeats)
 {
     this->numBeats = numBeats;
-    midiOnEvents.resize(numBeats);
-    midiOffEvents.resize(numBeats);
     setupGuiPositions();
 }
 
@@ -153,6 +264,7 @@ void MidiSequencer::setBpm(int bpm)
 {
     this->bpm = bpm;
     clock.setBpm(bpm);
+    resetSchedule(true);
 }
 
 void MidiSequencer::setPeriod(int measures)
@@ -161,6 +273,20 @@ void MidiSequencer::setPeriod(int measures)
     setNumberBeats(measures * 16);
 }
 
+void MidiSequencer::setOffset(float offset)
+{
+    this->offset = ofClamp(offset, -0.5, 0.5);
+    for (int i = 0; i < visibleEvents.size(); i++)
+    {
+        if (selection.getWidth() > 0 && isMidiEventSelected(visibleRectangles[i])) {
+            events.setOffset(visibleEvents[i], this->offset);
+        }
+    }
+    if (selectedEvent != -1) {
+        events.setOffset(selectedEvent, this->offset);
+    }
+}
+
 void MidiSequencer::setNoteDisplayRange(int noteMin, int noteMax)
 {
     this->noteMin = noteMin;
@@ -177,143 +303,132 @@ void MidiSequencer::setTimeDisplayRange(float start, float end)
     setupGuiPositions();
 }
 
-void MidiSequencer::setMidiEventRectangle(MidiSequencerEvent *event)
+ofRectangle MidiSequencer::getMidiEventRectangle(const MidiNote &event)
 {
-    if (event->note < noteMin || event->note > noteMax ||
-        (float) event->start / numBeats > end || (float) event->end / numBeats < start) {
-        event->setPosition(0, 0);
-        event->setSize(0, 0);
+    if (event.note < noteMin || event.note > noteMax ||
+        (float) event.start / numBeats > end || (float) event.end / numBeats < start) {
+        return ofRectangle(0, 0, 0, 0);
     }
-    else
-    {
-        event->setPosition(rectGrid.x + rectGrid.width * ofClamp((float) event->start / numBeats - start, 0.0, 1.0) / (end - start),
-                           rectGrid.y + (noteMax - event->note) * rowHeight);
-        event->setSize(rectGrid.width * (min(end, (float) event->end / numBeats) - max(start, (float) event->start / numBeats)) / (end - start),
+    return ofRectangle(rectGrid.x + rectGrid.width * ofClamp((float) event.start / numBeats - start, 0.0, 1.0) / (end - start),
+                       rectGrid.y + (noteMax - event.note) * rowHeight,
+                       rectGrid.width * (min(end, (float) event.end / numBeats) - max(start, (float) event.start / numBeats)) / (end - start),
                        rowHeight);
-
-    }
 }
 
-MidiSequencer::MidiSequencerEvent * MidiSequencer::addMidiEvent(int note, int velocity, int start, int end)
+bool MidiSequencer::isMidiEventSelected(const ofRectangle &r)
 {
-    MidiSequencerEvent *midiEvent = new MidiSequencerEvent(note, velocity, start, end);
-    events.push_back(midiEvent);
-    midiOnEvents[start].push_back(midiEvent);
-    midiOffEvents[end].push_back(midiEvent);
-    setMidiEventRectangle(midiEvent);
-    return midiEvent;
+    return r.getWidth() > 0 &&
+           (selection.inside(r.x, r.y) ||
+            selection.inside(r.x + r.width, r.y) ||
+            selection.inside(r.x + r.width, r.y + r.height) ||
+            selection.inside(r.x, r.y + r.height));
 }
 
-void MidiSequencer::repositionMidiEvent(MidiSequencerEvent* event)
+void MidiSequencer::updateVisibleEvents()
 {
-    for (int b = 0; b < midiOnEvents.size(); b++)
+    // only the notes in the current view get rectangles; drawing and mouse
+    // handling never look at the rest
+    visibleEvents.clear();
+    visibleRectangles.clear();
+    queryEvents.clear();
+    events.getInRange(floor(start * numBeats), ceil(end * numBeats), queryEvents);
+    for (auto id : queryEvents)
     {
-        vector<MidiSequencerEvent*>::iterator it1 = midiOnEvents[b].begin();
-        vector<MidiSequencerEvent*>::iterator it2 = midiOffEvents[b].begin();
-        while (it1 != midiOnEvents[b].end()) {
-            *it1 == event ? midiOnEvents[b].erase(it1) : ++it1;
-        }
-        while (it2 != midiOffEvents[b].end()) {
-            *it2 == event ? midiOffEvents[b].erase(it2) : ++it2;
+        ofRectangle r = getMidiEventRectangle(events.get(id));
+        if (r.getWidth() > 0)
+        {
+            visibleEvents.push_back(id);
+            visibleRectangles.push_back(r);
         }
     }
-    midiOnEvents[event->start].push_back(event);
-    midiOffEvents[event->end].push_back(event);
+    if (mouseOverEvent != -1) {
+        mouseOverRectangle = getMidiEventRectangle(events.get(mouseOverEvent));
+    }
 }
 
-void MidiSequencer::removeEvent(MidiSequencerEvent *event, bool toDelete)
+int MidiSequencer::addMidiEvent(int note, int velocity, int start, int end)
 {
-    for (int b = 0; b < midiOnEvents.size(); b++)
-    {
-        vector<MidiSequencerEvent*>::iterator it = midiOnEvents[b].begin();
-        while (it != midiOnEvents[b].end())
-        {
-            if (*it == event) {
-                midiOnEvents[b].erase(it);
-            }
-            else {
-                ++it;
-            }
-        }
-    }
-    
-    for (int b = 0; b < midiOffEvents.size(); b++)
-    {
-        vector<MidiSequencerEvent*>::iterator it = midiOffEvents[b].begin();
-        while (it != midiOffEvents[b].end())
-        {
-            if (*it == event) {
-                midiOffEvents[b].erase(it);
-            }
-            else {
-                ++it;
-            }
-        }
-    }
-    
-    vector<MidiSequencerEvent*>::iterator it = events.begin();
-    while (it != events.end())
-    {
-        if (*it == event) {
-            events.erase(it);
-        }
-        else {
-            ++it;
-        }
+    int id = events.add(MidiNote(note, velocity, start, end));
+    updateVisibleEvents();
+    return id;
+}
+
+void MidiSequencer::removeEvent(int id)
+{
+    events.remove(id);
+    if (mouseOverEvent == id) {
+        mouseOverEvent = -1;
     }
+    updateVisibleEvents();
     
-    if (toDelete) {
-        delete event;
-    }
+    // its note-on may be queued or playing with the note-off not yet rendered
+    resetSchedule(true);
 }
 
 void MidiSequencer::removeSelectedEvents()
 {
-    vector<MidiSequencerEvent*> eventsToRemove;
-    for (auto m : events)
+    for (int i = 0; i < visibleEvents.size(); i++)
     {
-        if (m->getRectangle().getWidth() > 0)
+        if (isMidiEventSelected(visibleRectangles[i]))
         {
-            if (selection.inside(m->getRectangle().x, m->getRectangle().y) ||
-                selection.inside(m->getRectangle().x + m->getRectangle().width, m->getRectangle().y) ||
-                selection.inside(m->getRectangle().x + m->getRectangle().width, m->getRectangle().y + m->getRectangle().height) ||
-                selection.inside(m->getRectangle().x, m->getRectangle().y + m->getRectangle().height)) {
-                eventsToRemove.push_back(m);
-                removeEvent(m, false);
+            events.remove(visibleEvents[i]);
+            if (selectedEvent == visibleEvents[i]) {
+                selectedEvent = -1;
+            }
+            if (mouseOverEvent == visibleEvents[i]) {
+                mouseOverEvent = -1;
             }
         }
     }
-    
-    vector<MidiSequencerEvent*>::iterator itr = eventsToRemove.begin();
-    while (itr != eventsToRemove.end())
-    {
-        delete *itr;
-        eventsToRemove.erase(itr);
-    }
-    eventsToRemove.clear();
+    updateVisibleEvents();
+    resetSchedule(true);
 }
 
-void MidiSequencer::eventBeat()
+void MidiSequencer::eventBeat(BpmEventArgs &e)
 {
     beat = (beat + 1) % numBeats;
+    scheduleEvents(e);
+}
+
+void MidiSequencer::scheduleEvents(BpmEventArgs &e)
+{
+    // render every beat up to the look-ahead horizon, always including the
+    // next one, and leave the timing to the scheduler thread. notes edited
+    // inside the horizon take effect on the next pass through the loop.
+    double beatDuration = 60.0 * 1000.0 * 1000.0 / bpm;
+    int64_t horizon = e.time + beatDuration + 1000 * lookAhead;
+    if (scheduledBeat < e.beat) {
+        scheduledBeat = e.beat - 1;
+    }
     
-    if (midiOnEvents[beat].size() > 0)
+    vector<MidiEventArgs> rendered;
+    for (int64_t s = scheduledBeat + 1; e.time + (s - e.beat) * beatDuration <= horizon; s++)
     {
-        for (auto m : midiOnEvents[beat])
+        int b = (beat + s - e.beat) % numBeats;
+        double beatTime = e.time + (s - e.beat + (b % 2 == 1 ? swing : 0.0)) * beatDuration;
+        queryEvents.clear();
+        events.getStartingAt(b, queryEvents);
+        for (auto id : queryEvents)
         {
-            MidiEventArgs args(1, m->note, m->velocity);
-            ofNotifyEvent(midiEvent, args, this);
+            const MidiNote &m = events.get(id);
+            rendered.push_back(MidiEventArgs(1, m.note, m.velocity, beatTime + m.offset * beatDuration));
         }
-    }
-    
-    if (midiOffEvents[beat].size() > 0)
-    {
-        for (auto m : midiOffEvents[beat])
+        queryEvents.clear();
+        events.getEndingAt(b, queryEvents);
+        for (auto id : queryEvents)
         {
-            MidiEventArgs args(0, m->note, m->velocity);
-            ofNotifyEvent(midiEvent, args, this);
+            const MidiNote &m = events.get(id);
+            rendered.push_back(MidiEventArgs(0, m.note, m.velocity, beatTime + m.offset * beatDuration));
         }
+        scheduledBeat = s;
     }
+    scheduler.schedule(rendered);
+}
+
+void MidiSequencer::resetSchedule(bool flushNoteOffs)
+{
+    scheduler.clear(flushNoteOffs);
+    scheduledBeat = -1;
 }
 
 void MidiSequencer::eventSelectRoot(GuiMenuEventArgs &e)
@@ -328,8 +443,10 @@ void MidiSequencer::eventSelectKey(GuiMenuEventArgs &e)
 
 void MidiSequencer::eventPlay(GuiButtonEventArgs &e)
 {
-    if (active) {
+    if (active)
+    {
         beat = 0;
+        resetSchedule(true);
     }
     else {
         setActive(true);
@@ -348,7 +465,7 @@ void MidiSequencer::eventStop(GuiButtonEventArgs &e)
     for (int i = 0; i < 127; i++)
     {
         MidiEventArgs args(0, i, 127);
-        ofNotifyEvent(midiEvent, args, this);
+        scheduler.send(args);
     }
 }
 
@@ -362,6 +479,21 @@ void MidiSequencer::eventSetPeriod(GuiSliderEventArgs<int> &e)
     setPeriod(measures);
 }
 
+void MidiSequencer::eventSetSwing(GuiSliderEventArgs<float> &e)
+{
+    setSwing(swing);
+}
+
+void MidiSequencer::eventSetLookAhead(GuiSliderEventArgs<int> &e)
+{
+    setLookAhead(lookAhead);
+}
+
+void MidiSequencer::eventSetOffset(GuiSliderEventArgs<float> &e)
+{
+    setOffset(offset);
+}
+
 void MidiSequencer::eventSetTimeView(GuiRangeSliderEventArgs<float> &e)
 {
     setTimeDisplayRange(start, end);
@@ -416,8 +548,8 @@ void MidiSequencer::drawGrid()
     }
     
     ofSetColor(colorForeground);
-    for (auto m : events) {
-        m->draw();
+    for (auto &r : visibleRectangles) {
+        ofRect(r);
     }
     
     if (selection.getWidth() > 0)
@@ -425,47 +557,43 @@ void MidiSequencer::drawGrid()
         ofSetColor(colorActive);
         ofNoFill();
         ofSetLineWidth(2);
-        for (auto m : events)
+        for (auto &r : visibleRectangles)
         {
-            if (m->getRectangle().getWidth() > 0)
-            {
-                if (selection.inside(m->getRectangle().x, m->getRectangle().y) ||
-                    selection.inside(m->getRectangle().x + m->getRectangle().width, m->getRectangle().y) ||
-                    selection.inside(m->getRectangle().x + m->getRectangle().width, m->getRectangle().y + m->getRectangle().height) ||
-                    selection.inside(m->getRectangle().x, m->getRectangle().y + m->getRectangle().height)) {
-                    m->draw();
-                }
+            if (isMidiEventSelected(r)) {
+                ofRect(r);
             }
         }
     }
-    else if (selectedEvent != NULL)
+    else if (selectedEvent != -1)
     {
         ofSetColor(colorActive);
         ofNoFill();
         ofSetLineWidth(2);
-        selectedEvent->draw();
+        ofRect(getMidiEventRectangle(events.get(selectedEvent)));
     }
     
-    if (mouseDragging && mouseOverEvent == NULL)
+    if (mouseDragging && mouseOverEvent == -1)
     {
         ofSetColor(colorActive);
         ofFill();
-        newEvent->draw();
+        ofRect(newEventRectangle);
     }
-    else if (mouseOverEvent != NULL)
+    else if (mouseOverEvent != -1)
     {
+        const ofRectangle &r = mouseOverRectangle;
         ofSetColor(0, 200);
         if (mouseOverEventMode == LEFT) {
-            ofLine(mouseOverEvent->getRectangle().x - 5, mouseOverEvent->getRectangle().y - 2, mouseOverEvent->getRectangle().x - 5, mouseOverEvent->getRectangle().y + mouseOverEvent->getRectangle().height + 2);
+            ofLine(r.x - 5, r.y - 2, r.x - 5, r.y + r.height + 2);
         }
         else if (mouseOverEventMode == RIGHT) {
-            ofLine(mouseOverEvent->getRectangle().x + mouseOverEvent->getRectangle().width + 5, mouseOverEvent->getRectangle().y - 2, mouseOverEvent->getRectangle().x + mouseOverEvent->getRectangle().width + 5, mouseOverEvent->getRectangle().y + mouseOverEvent->getRectangle().height + 2);
+            ofLine(r.x + r.width + 5, r.y - 2, r.x + r.width + 5, r.y + r.height + 2);
         }
         else if (mouseOverEventMode == TOP || mouseOverEventMode == BOTTOM)
         {
+            float velocity = events.get(mouseOverEvent).velocity;
             ofSetColor(colorOutline);
             ofSetLineWidth(2);
-            ofLine(mouseOverEvent->getRectangle().x, mouseOverEvent->getRectangle().y + (127.0 - mouseOverEvent->velocity) * mouseOverEvent->getRectangle().height / 127.0, mouseOverEvent->getRectangle().x + mouseOverEvent->getRectangle().width, mouseOverEvent->getRectangle().y + (127.0 - mouseOverEvent->velocity) * mouseOverEvent->getRectangle().height / 127.0);
+            ofLine(r.x, r.y + (127.0 - velocity) * r.height / 127.0, r.x + r.width, r.y + (127.0 - velocity) * r.height / 127.0);
         }
     }
     
@@ -519,15 +647,16 @@ void MidiSequencer::drawVelocity()
     ofSetColor(255);
     ofRect(rectVelocity);
     
-    for (int c = floor(start * numBeats); c < ceil(end * numBeats); c++)
+    int c0 = floor(start * numBeats);
+    int c1 = ceil(end * numBeats);
+    for (auto id : visibleEvents)
     {
-        float x = ofClamp(ofMap((float) c / numBeats, start, end, rectVelocity.x, rectVelocity.x + rectVelocity.width), rectVelocity.x, rectVelocity.x + rectVelocity.width);
-        for (int i = 0; i < midiOnEvents[c].size(); i++)
-        {
-            midiOnEvents[c][i] == selectedEvent ? ofSetColor(colorActive, 150) : ofSetColor(colorForeground, 150);
-            float height = ofMap(midiOnEvents[c][i]->velocity, 0, 127, 0, rectVelocity.height);
-            ofRect(x, rectVelocity.y + rectVelocity.height, colWidth, -height);
-        }
+        const MidiNote &m = events.get(id);
+        if (m.start < c0 || m.start >= c1) continue;
+        float x = ofClamp(ofMap((float) m.start / numBeats, start, end, rectVelocity.x, rectVelocity.x + rectVelocity.width), rectVelocity.x, rectVelocity.x + rectVelocity.width);
+        id == selectedEvent ? ofSetColor(colorActive, 150) : ofSetColor(colorForeground, 150);
+        float height = ofMap(m.velocity, 0, 127, 0, rectVelocity.height);
+        ofRect(x, rectVelocity.y + rectVelocity.height, colWidth, -height);
     }
 }
 
@@ -550,6 +679,9 @@ void MidiSequencer::drawToolbar()
     sBpm->update();
     sPeriod->update();
     rTime->update();
+    sSwing->update();
+    sLookAhead->update();
+    sOffset->update();
 
     play->draw();
     pause->draw();
@@ -557,6 +689,9 @@ void MidiSequencer::drawToolbar()
     sBpm->draw();
     sPeriod->draw();
     rTime->draw();
+    sSwing->draw();
+    sLookAhead->draw();
+    sOffset->draw();
     keySelect->draw();
     rootSelect->draw();
 }
@@ -576,27 +711,33 @@ bool MidiSequencer::mouseMoved(int mouseX, int mouseY)
     sBpm->mouseMoved(mouseX, mouseY);
     sPeriod->mouseMoved(mouseX, mouseY);
     rTime->mouseMoved(mouseX, mouseY);
+    sSwing->mouseMoved(mouseX, mouseY);
+    sLookAhead->mouseMoved(mouseX, mouseY);
+    sOffset->mouseMoved(mouseX, mouseY);
     
     if (!mouseDragging)
     {
-        mouseOverEvent = NULL;
-        for (auto m : events)
+        mouseOverEvent = -1;
+        for (int i = 0; i < visibleEvents.size(); i++)
         {
-            if (m->getRectangle().inside(mouseX, mouseY))
+            const ofRectangle &r = visibleRectangles[i];
+            if (r.inside(mouseX, mouseY))
             {
-                mouseOverEvent = m;
+                const MidiNote &m = events.get(visibleEvents[i]);
+                mouseOverEvent = visibleEvents[i];
+                mouseOverRectangle = r;
                 mouseOverEventMode = MIDDLE;
-                float eventMargin = min(2.0, (m->end - m->start) / 3.0);
-                if ((mouseX - m->getRectangle().getX()) / colWidth < eventMargin) {
+                float eventMargin = min(2.0, (m.end - m.start) / 3.0);
+                if ((mouseX - r.getX()) / colWidth < eventMargin) {
                     mouseOverEventMode = LEFT;
                 }
-                else if ((m->getRectangle().getX() + m->getRectangle().getWidth() - mouseX) / colWidth < eventMargin) {
+                else if ((r.getX() + r.getWidth() - mouseX) / colWidth < eventMargin) {
                     mouseOverEventMode = RIGHT;
                 }
-                else if ((mouseY - m->getRectangle().getY()) / m->getRectangle().getHeight() < 0.25) {
+                else if ((mouseY - r.getY()) / r.getHeight() < 0.25) {
                     mouseOverEventMode = TOP;
                 }
-                else if ((m->getRectangle().getY() + m->getRectangle().getHeight() - mouseY) / m->getRectangle().getHeight() < 0.25) {
+                else if ((r.getY() + r.getHeight() - mouseY) / r.getHeight() < 0.25) {
                     mouseOverEventMode = BOTTOM;
                 }
                 return true;
@@ -619,6 +760,9 @@ bool MidiSequencer::mousePressed(int mouseX, int mouseY)
         else if (sBpm->mousePressed(mouseX, mouseY)) return true;
         else if (sPeriod->mousePressed(mouseX, mouseY)) return true;
         else if (rTime->mousePressed(mouseX, mouseY)) return true;
+        else if (sSwing->mousePressed(mouseX, mouseY)) return true;
+        else if (sLookAhead->mousePressed(mouseX, mouseY)) return true;
+        else if (sOffset->mousePressed(mouseX, mouseY)) return true;
 
         selection.set(0, 0, 0, 0);
         pMouse.set(mouseX, mouseY);
@@ -629,17 +773,18 @@ bool MidiSequencer::mousePressed(int mouseX, int mouseY)
         
         if (mouseOverGrid)
         {
-            if (mouseOverEvent != NULL)
+            if (mouseOverEvent != -1)
             {
-                pMouseOverEventNoteVelocity.set(mouseOverEvent->note, mouseOverEvent->velocity);
-                pMouseOverEventStartEnd.set(mouseOverEvent->start, mouseOverEvent->end);
+                const MidiNote &m = events.get(mouseOverEvent);
+                pMouseOverEventNoteVelocity.set(m.note, m.velocity);
+                pMouseOverEventStartEnd.set(m.start, m.end);
             }
             else
             {
-                newEvent->note = noteMax - floor((mouseY - rectGrid.y) / rowHeight);
-                newEvent->start = floor(numBeats * (start + (float) (mouseX - rectGrid.x) * (end - start) / rectGrid.width));
-                newEvent->end = newEvent->start;
-                setMidiEventRectangle(newEvent);
+                newEvent.note = noteMax - floor((mouseY - rectGrid.y) / rowHeight);
+                newEvent.start = floor(numBeats * (start + (float) (mouseX - rectGrid.x) * (end - start) / rectGrid.width));
+                newEvent.end = newEvent.start;
+                newEventRectangle = getMidiEventRectangle(newEvent);
             }
             return true;
         }
@@ -650,7 +795,7 @@ bool MidiSequencer::mousePressed(int mouseX, int mouseY)
                 noteSelected = true;
                 selectedNote = noteMax - floor((mouseY - rectGrid.y) / rowHeight);
                 MidiEventArgs args(1, selectedNote, 127);
-                ofNotifyEvent(midiEvent, args, this);
+                scheduler.send(args);
             }
             return true;
         }
@@ -671,6 +816,9 @@ bool MidiSequencer::mouseDragged(int mouseX, int mouseY)
         else if (sBpm->mouseDragged(mouseX, mouseY)) return true;
         else if (sPeriod->mouseDragged(mouseX, mouseY)) return true;
         else if (rTime->mouseDragged(mouseX, mouseY)) return true;
+        else if (sSwing->mouseDragged(mouseX, mouseY)) return true;
+        else if (sLookAhead->mouseDragged(mouseX, mouseY)) return true;
+        else if (sOffset->mouseDragged(mouseX, mouseY)) return true;
 
         if (mouseOverGrid)
         {
@@ -685,37 +833,34 @@ bool MidiSequencer::mouseDragged(int mouseX, int mouseY)
             {
                 selection.set(pMouse.x, pMouse.y, ofGetMouseX() - pMouse.x, ofGetMouseY() - pMouse.y);
             }
-            else if (mouseOverEvent != NULL)
+            else if (mouseOverEvent != -1)
             {
+                const MidiNote &m = events.get(mouseOverEvent);
                 if (mouseOverEventMode == MIDDLE)
                 {
                     int diffX = (mouseX - pMouse.x) / colWidth;
-                    mouseOverEvent->start = pMouseOverEventStartEnd.x + diffX;
-                    mouseOverEvent->end = pMouseOverEventStartEnd.y + diffX;
-                    mouseOverEvent->note = pMouseOverEventNoteVelocity.x - (mouseY - pMouse.y) / rowHeight;
-                    repositionMidiEvent(mouseOverEvent);
+                    events.setTiming(mouseOverEvent, pMouseOverEventStartEnd.x + diffX, pMouseOverEventStartEnd.y + diffX);
+                    events.setNote(mouseOverEvent, pMouseOverEventNoteVelocity.x - (mouseY - pMouse.y) / rowHeight);
                 }
                 else if (mouseOverEventMode == LEFT)
                 {
-                    mouseOverEvent->start = pMouseOverEventStartEnd.x + (mouseX - pMouse.x) / colWidth;
-                    repositionMidiEvent(mouseOverEvent);
+                    events.setTiming(mouseOverEvent, pMouseOverEventStartEnd.x + (mouseX - pMouse.x) / colWidth, m.end);
                 }
                 else if (mouseOverEventMode == RIGHT)
                 {
-                    mouseOverEvent->end = pMouseOverEventStartEnd.y + (mouseX - pMouse.x) / colWidth;
-                    repositionMidiEvent(mouseOverEvent);
+                    events.setTiming(mouseOverEvent, m.start, pMouseOverEventStartEnd.y + (mouseX - pMouse.x) / colWidth);
                 }
                 else if (mouseOverEventMode == TOP || mouseOverEventMode == BOTTOM)
                 {
-                    mouseOverEvent->velocity = ofClamp(pMouseOverEventNoteVelocity.y + 10.0 * ((pMouse.y - mouseY) / rowHeight), 0, 127);
+                    events.setVelocity(mouseOverEvent, ofClamp(pMouseOverEventNoteVelocity.y + 10.0 * ((pMouse.y - mouseY) / rowHeight), 0, 127));
                 }
-                setMidiEventRectangle(mouseOverEvent);
+                updateVisibleEvents();
                 return true;
             }
             else
             {
-                newEvent->end = floor(numBeats * (start + (mouseX - rectGrid.x) * (end - start) / rectGrid.width));
-                setMidiEventRectangle(newEvent);
+                newEvent.end = floor(numBeats * (start + (mouseX - rectGrid.x) * (end - start) / rectGrid.width));
+                newEventRectangle = getMidiEventRectangle(newEvent);
                 return true;
             }
         }
@@ -752,31 +897,37 @@ bool MidiSequencer::mouseReleased(int mouseX, int mouseY)
         else if (sBpm->mouseReleased(mouseX, mouseY)) return true;
         else if (sPeriod->mouseReleased(mouseX, mouseY)) return true;
         else if (rTime->mouseReleased(mouseX, mouseY)) return true;
+        else if (sSwing->mouseReleased(mouseX, mouseY)) return true;
+        else if (sLookAhead->mouseReleased(mouseX, mouseY)) return true;
+        else if (sOffset->mouseReleased(mouseX, mouseY)) return true;
 
         if (mouseOverGrid)
         {
-            if (newEvent->start != newEvent->end)
+            if (newEvent.start != newEvent.end)
             {
-                selectedEvent = addMidiEvent(newEvent->note, 127, newEvent->start, newEvent->end);
-                newEvent->end = 0;
-                newEvent->start = 0;
+                selectedEvent = addMidiEvent(newEvent.note, 127, newEvent.start, newEvent.end);
+                newEvent.end = 0;
+                newEvent.start = 0;
             }
             else
             {
-                selectedEvent = NULL;
-                for (auto m : events)
+                selectedEvent = -1;
+                for (int i = 0; i < visibleEvents.size(); i++)
                 {
-                    if (m->getRectangle().inside(mouseX, mouseY)) {
-                        selectedEvent = m;
+                    if (visibleRectangles[i].inside(mouseX, mouseY)) {
+                        selectedEvent = visibleEvents[i];
                     }
                 }
+                if (selectedEvent != -1) {
+                    offset = events.get(selectedEvent).offset;
+                }
             }
             return true;
         }
         if (noteSelected)
         {
             MidiEventArgs args(0, selectedNote, 127);
-            ofNotifyEvent(midiEvent, args, this);
+            scheduler.send(args);
             noteSelected = false;
             return true;
         }
@@ -794,6 +945,9 @@ bool MidiSequencer::keyPressed(int key)
     else if (sBpm->keyPressed(key)) return true;
     else if (sPeriod->keyPressed(key)) return true;
     else if (rTime->keyPressed(key)) return true;
+    else if (sSwing->keyPressed(key)) return true;
+    else if (sLookAhead->keyPressed(key)) return true;
+    else if (sOffset->keyPressed(key)) return true;
 
     else if (mouseOverGrid)
     {
@@ -802,20 +956,20 @@ bool MidiSequencer::keyPressed(int key)
             if (selection.getWidth() > 0) {
                 removeSelectedEvents();
             }
-            if (selectedEvent != NULL)
+            if (selectedEvent != -1)
             {
                 removeEvent(selectedEvent);
-                selectedEvent = NULL;
+                selectedEvent = -1;
             }
             return true;
         }
         else if (key == OF_KEY_UP)
         {
-            if (selectedEvent != NULL)
+            if (selectedEvent != -1)
             {
-                if (selectedEvent->note == 127) return true;
-                selectedEvent->note = selectedEvent->note + 1;
-                setMidiEventRectangle(selectedEvent);
+                if (events.get(selectedEvent).note == 127) return true;
+                events.setNote(selectedEvent, events.get(selectedEvent).note + 1);
+                updateVisibleEvents();
             }
             else
             {
@@ -826,11 +980,11 @@ bool MidiSequencer::keyPressed(int key)
         }
         else if (key == OF_KEY_DOWN)
         {
-            if (selectedEvent != NULL)
+            if (selectedEvent != -1)
             {
-                if (selectedEvent->note == 0) return true;
-                selectedEvent->note = selectedEvent->note - 1;
-                setMidiEventRectangle(selectedEvent);
+                if (events.get(selectedEvent).note == 0) return true;
+                events.setNote(selectedEvent, events.get(selectedEvent).note - 1);
+                updateVisibleEvents();
             }
             else
             {
@@ -841,25 +995,23 @@ bool MidiSequencer::keyPressed(int key)
         }
         else if (key == OF_KEY_LEFT)
         {
-            if (selectedEvent != NULL)
+            if (selectedEvent != -1)
             {
-                if (selectedEvent->start == 0 || selectedEvent->end == 0) return true;
-                selectedEvent->start = selectedEvent->start - 1;
-                selectedEvent->end = selectedEvent->end - 1;
-                repositionMidiEvent(selectedEvent);
-                setMidiEventRectangle(selectedEvent);
+                const MidiNote &m = events.get(selectedEvent);
+                if (m.start == 0 || m.end == 0) return true;
+                events.setTiming(selectedEvent, m.start - 1, m.end - 1);
+                updateVisibleEvents();
             }
             return true;
         }
         else if (key == OF_KEY_RIGHT)
         {
-            if (selectedEvent != NULL)
+            if (selectedEvent != -1)
             {
-                if (selectedEvent->start == numBeats || selectedEvent->end == numBeats) return true;
-                selectedEvent->start = selectedEvent->start + 1;
-                selectedEvent->end = selectedEvent->end + 1;
-                repositionMidiEvent(selectedEvent);
-                setMidiEventRectangle(selectedEvent);
+                const MidiNote &m = events.get(selectedEvent);
+                if (m.start == numBeats || m.end == numBeats) return true;
+                events.setTiming(selectedEvent, m.start + 1, m.end + 1);
+                updateVisibleEvents();
             }
             return true;
         }
@@ -893,6 +1045,14 @@ void MidiSequencer::setupGuiPositions()
     stop->setSize(60, 14);
     sBpm->setSize(100, 14);
     sPeriod->setSize(100, 14);
+    
+    // timing on a second row
+    sSwing->setPosition(rectToolbar.x + 350, rectToolbar.y + 15);
+    sLookAhead->setPosition(rectToolbar.x + 460, rectToolbar.y + 15);
+    sOffset->setPosition(rectToolbar.x + 570, rectToolbar.y + 15);
+    sSwing->setSize(100, 14);
+    sLookAhead->setSize(100, 14);
+    sOffset->setSize(100, 14);
 
     if (collapsed)
     {
@@ -915,8 +1075,6 @@ void MidiSequencer::setupGuiPositions()
     colWidth = rectGrid.width / (numBeats * (end - start));
     rowHeight = rectGrid.height / numRows;
     
-    for (auto m : events) {
-        setMidiEventRectangle(m);
-    }
-    setMidiEventRectangle(newEvent);
+    updateVisibleEvents();
+    newEventRectangle = getMidiEventRectangle(newEvent);
 }
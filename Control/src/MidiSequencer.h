@@ -7,6 +7,10 @@
 #include "GuiWidget.h"
 #include "Bpm.h"
 #include "Sequence.h"
+#include "MidiNoteStore.h"
+#include <condition_variable>
+#include <mutex>
+#include <queue>
 
 
 struct MidiEventArgs
@@ -14,6 +18,8 @@ struct MidiEventArgs
     int type;
     int note;
     int velocity;
+    int64_t time;
+    MidiEventArgs(int type, int note, int velocity, int64_t time);
     MidiEventArgs(int type, int note, int velocity);
 };
 
@@ -21,13 +27,30 @@ class MidiSequencer : public GuiWidget
 {
 public:
 
-    class MidiSequencerEvent : public GuiElement
+    // holds rendered, timestamped notes and sends them through midiEvent
+    // from its own thread as each deadline arrives
+    class MidiScheduler : public ofThread
     {
     public:
-        MidiSequencerEvent(int note, int velocity, int start, int end);
-        void draw();
-        int start, end;
-        int note, velocity;
+        MidiScheduler(MidiSequencer *sequencer);
+        ~MidiScheduler();
+        void schedule(vector<MidiEventArgs> &events);
+        void send(MidiEventArgs &event);
+        void clear(bool flushNoteOffs);
+
+    protected:
+        void threadedFunction();
+
+        struct Later
+        {
+            bool operator()(const MidiEventArgs &a, const MidiEventArgs &b) const;
+        };
+
+        MidiSequencer *sequencer;
+        priority_queue<MidiEventArgs, vector<MidiEventArgs>, Later> pending;
+        std::mutex pendingMutex;
+        std::condition_variable pendingCondition;
+        bool pendingChanged;
     };
 
     MidiSequencer(string name);
@@ -38,6 +61,14 @@ public:
     void setActive(bool active);
     void setNoteDisplayRange(int noteMin, int noteMax);
     void setTimeDisplayRange(float start, float end);
+    void setSwing(float swing) {this->swing = ofClamp(swing, 0.0, 0.5);}
+    void setLookAhead(int lookAhead) {this->lookAhead = lookAhead;}
+    
+    // micro-timing of the selected notes, in fractions of a beat
+    void setOffset(float offset);
+
+    float getSwing() {return swing;}
+    int getLookAhead() {return lookAhead;}
 
     void draw();
 
@@ -53,23 +84,26 @@ private:
 
     enum MidiEventMouseMode { MIDDLE, LEFT, RIGHT, TOP, BOTTOM };
     
-    MidiSequencerEvent * addMidiEvent(int row, int velocity, int start, int end);
+    int addMidiEvent(int note, int velocity, int start, int end);
     void removeSelectedEvents();
-    void removeEvent(MidiSequencerEvent *event, bool toDelete=true);
-    void repositionMidiEvent(MidiSequencerEvent* event);
+    void removeEvent(int id);
+    void scheduleEvents(BpmEventArgs &e);
+    void resetSchedule(bool flushNoteOffs);
     
     void setNumberBeats(int numBeats);
     
     void setupKeys();
     void setupGuiPositions();
-    void setMidiEventRectangle(MidiSequencerEvent *event);
+    ofRectangle getMidiEventRectangle(const MidiNote &event);
+    bool isMidiEventSelected(const ofRectangle &r);
+    void updateVisibleEvents();
     
     void drawGrid();
     void drawKeyboard();
     void drawVelocity();
     void drawToolbar();
     
-    void eventBeat();
+    void eventBeat(BpmEventArgs &e);
     void eventSelectRoot(GuiMenuEventArgs &e);
     void eventSelectKey(GuiMenuEventArgs &e);
     void eventPlay(GuiButtonEventArgs &e);
@@ -77,19 +111,26 @@ private:
     void eventStop(GuiButtonEventArgs &e);
     void eventSetBpm(GuiSliderEventArgs<int> &e);
     void eventSetPeriod(GuiSliderEventArgs<int> &e);
+    void eventSetSwing(GuiSliderEventArgs<float> &e);
+    void eventSetLookAhead(GuiSliderEventArgs<int> &e);
+    void eventSetOffset(GuiSliderEventArgs<float> &e);
     void eventSetTimeView(GuiRangeSliderEventArgs<float> &e);
     
     GuiMenu *keySelect;
     GuiMenu *rootSelect;
     GuiButton *play, *pause, *stop, *clear;
-    GuiSlider<int> *sBpm, *sPeriod;
+    GuiSlider<int> *sBpm, *sPeriod, *sLookAhead;
+    GuiSlider<float> *sSwing, *sOffset;
     GuiRangeSlider<float> *rTime;
     
-    MidiSequencerEvent *newEvent;
-    MidiSequencerEvent *selectedEvent, *mouseOverEvent;
-    vector<MidiSequencerEvent*> events;
-    vector<vector<MidiSequencerEvent*> > midiOnEvents;
-    vector<vector<MidiSequencerEvent*> > midiOffEvents;
+    MidiNoteStore events;
+    vector<int> visibleEvents;
+    vector<ofRectangle> visibleRectangles;
+    vector<int> queryEvents;
+    MidiNote newEvent;
+    ofRectangle newEventRectangle;
+    int selectedEvent, mouseOverEvent;
+    ofRectangle mouseOverRectangle;
     
     int numRows;
     float rowHeight, colWidth;
@@ -101,6 +142,11 @@ private:
     map<int, bool> rootIsMinor;
     
     Bpm clock;
+    MidiScheduler scheduler;
+    int64_t scheduledBeat;
+    float swing;
+    int lookAhead;
+    float offset;
     int bpm;
     int measures;
     int numBeats;
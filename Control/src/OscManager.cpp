@@ -1,14 +1,40 @@
 #include "OscManager.h"
 
 
+OscManager::OscSlot::OscSlot(GuiElement *element)
+{
+    this->element = element;
+    fresh = false;
+}
+
+
 OscManager::OscManager()
 {
+    sendInterval = GUI_DEFAULT_OSCMANAGER_SEND_INTERVAL;
+    maxBundleSize = GUI_DEFAULT_OSCMANAGER_MAX_BUNDLE_SIZE;
+    lastSendTime = 0;
+    numPacketsSent = 0;
+    numBytesSent = 0;
+    numMessagesDropped = 0;
+    coalesceReceive = true;
+    verbose = false;
+    logMessages = false;
+    rSlotsChanged = false;
+    
     panel.setName("OSC");
     panel.addToggle("send", &sending, this, &OscManager::eventToggleSending);
     panel.addTextBox("hostOut", &hostOut, this, &OscManager::eventEditHostOut);
     panel.addTextBox("portOut", &portOutS, this, &OscManager::eventEditPortOut);
     panel.addToggle("receive", &receiving, this, &OscManager::eventToggleReceiving);
     panel.addTextBox("portIn", &portInS, this, &OscManager::eventEditPortIn);
+    panel.addToggle("latest only", &coalesceReceive);
+    panel.addToggle("log", &logMessages, this, &OscManager::eventToggleVerbose);
+    panel.addSlider("send interval", &sendInterval, 0, 1000);
+    panel.addSlider("max bundle", &maxBundleSize, 256, 8192);
+    tPackets = panel.addTextBox("packets", &packetsS);
+    tBytes = panel.addTextBox("bytes", &bytesS);
+    tDropped = panel.addTextBox("merged", &droppedS);
+    updateSendStatistics();
     
     portIn = 9000;
     portOut = 9001;
@@ -19,7 +45,7 @@ OscManager::OscManager()
 
 OscManager::~OscManager()
 {
-
+    clearOscSlots();
 }
 
 void OscManager::eventToggleSending(GuiButtonEventArgs &evt)
@@ -53,6 +79,17 @@ void OscManager::eventEditPortIn(GuiTextBoxEventArgs &evt)
     portIn = ofToInt(portInS);
 }
 
+void OscManager::eventToggleVerbose(GuiButtonEventArgs &evt)
+{
+    setVerbose(logMessages);
+}
+
+void OscManager::setVerbose(bool verbose)
+{
+    this->verbose = verbose;
+    logMessages = verbose;
+}
+
 bool OscManager::setupSender(string host, int portOut)
 {
     try
@@ -108,6 +145,7 @@ void OscManager::addElementToOscManager(GuiElement * element)
     {
         if (rParameters.count(element->getOscAddress()) == 0) {
             rParameters[element->getOscAddress()] = element;
+            rSlotsChanged = true;
         }
         else {
             ofLog(OF_LOG_WARNING, "Parameter at "+element->getOscAddress()+" already registered with receiver");
@@ -156,21 +194,84 @@ void OscManager::update()
 
 void OscManager::receiveOscMessages()
 {
+    // ofxOscReceiver listens on its own thread, this only empties its queue
+    if (rSlotsChanged) {
+        setupOscSlots();
+    }
+    ofxOscMessage msg;
     while(receiver.hasWaitingMessages())
     {
-        ofxOscMessage msg;
         receiver.getNextMessage(&msg);
-        string address = msg.getAddress();
-        
-        cout << "RCV " << address << endl;
-        for (int i=0; i<msg.getNumArgs(); i++) {
-            cout << " -> " << cout << msg.getArgAsFloat(i) << endl;
+        if (verbose) {
+            logOscMessage(msg);
         }
-        
-        if (rParameters.count(address) > 0) {
-            rParameters[address]->receiveOsc(msg);
+        unordered_map<string, int>::iterator it = rSlotIndex.find(msg.getAddress());
+        if (it == rSlotIndex.end()) {
+            continue;
+        }
+        OscSlot &slot = rSlots[it->second];
+        if (!coalesceReceive) {
+            slot.element->receiveOsc(msg);
+        }
+        else
+        {
+            // keep only the latest message per address, applied once below
+            swap(slot.message, msg);
+            if (!slot.fresh)
+            {
+                slot.fresh = true;
+                rFreshSlots.push_back(it->second);
+            }
         }
     }
+    applyOscMessages();
+}
+
+void OscManager::applyOscMessages()
+{
+    for (auto i : rFreshSlots)
+    {
+        rSlots[i].element->receiveOsc(rSlots[i].message);
+        rSlots[i].fresh = false;
+    }
+    rFreshSlots.clear();
+}
+
+void OscManager::setupOscSlots()
+{
+    clearOscSlots();
+    map<string,GuiElement*>::iterator it = rParameters.begin();
+    for (; it != rParameters.end(); ++it)
+    {
+        rSlotIndex[it->first] = rSlots.size();
+        rSlots.push_back(OscSlot(it->second));
+    }
+    rSlotsChanged = false;
+}
+
+void OscManager::clearOscSlots()
+{
+    rSlots.clear();
+    rFreshSlots.clear();
+    rSlotIndex.clear();
+}
+
+void OscManager::logOscMessage(ofxOscMessage &msg)
+{
+    string log = "RCV " + msg.getAddress();
+    for (int i=0; i<msg.getNumArgs(); i++)
+    {
+        if (msg.getArgType(i) == OFXOSC_TYPE_STRING) {
+            log += " " + msg.getArgAsString(i);
+        }
+        else if (msg.getArgType(i) == OFXOSC_TYPE_INT32) {
+            log += " " + ofToString(msg.getArgAsInt32(i));
+        }
+        else {
+            log += " " + ofToString(msg.getArgAsFloat(i));
+        }
+    }
+    ofLog(OF_LOG_NOTICE, log);
 }
 
 void OscManager::sendOscMessages()
@@ -182,7 +283,87 @@ void OscManager::sendOscMessages()
             ofxOscMessage msg;
             msg.setAddress(p->getOscAddress());
             p->sendOsc(msg);
-            sender.sendMessage(msg);
+            queueOscMessage(msg);
+        }
+    }
+    
+    if (ofGetElapsedTimeMillis() - lastSendTime >= sendInterval)
+    {
+        flushOscMessages();
+        lastSendTime = ofGetElapsedTimeMillis();
+    }
+}
+
+void OscManager::queueOscMessage(ofxOscMessage &msg)
+{
+    // only the latest value per address survives until the next flush
+    map<string, int>::iterator it = sendQueueIndex.find(msg.getAddress());
+    if (it != sendQueueIndex.end())
+    {
+        sendQueue[it->second] = msg;
+        numMessagesDropped++;
+    }
+    else
+    {
+        sendQueueIndex[msg.getAddress()] = sendQueue.size();
+        sendQueue.push_back(msg);
+    }
+}
+
+void OscManager::flushOscMessages()
+{
+    if (sendQueue.size() == 0) return;
+    
+    // "#bundle" header plus timetag, then each message is prefixed by its size
+    ofxOscBundle bundle;
+    int bundleSize = 16;
+    for (auto &msg : sendQueue)
+    {
+        int messageSize = 4 + getOscMessageSize(msg);
+        if (bundle.getMessageCount() > 0 && bundleSize + messageSize > maxBundleSize)
+        {
+            sendOscBundle(bundle, bundleSize);
+            bundle.clear();
+            bundleSize = 16;
+        }
+        bundle.addMessage(msg);
+        bundleSize += messageSize;
+    }
+    sendOscBundle(bundle, bundleSize);
+    
+    sendQueue.clear();
+    sendQueueIndex.clear();
+    updateSendStatistics();
+}
+
+void OscManager::sendOscBundle(ofxOscBundle &bundle, int bundleSize)
+{
+    sender.sendBundle(bundle);
+    numPacketsSent++;
+    numBytesSent += bundleSize;
+}
+
+int OscManager::getOscMessageSize(ofxOscMessage &msg)
+{
+    int size = 4 * ((msg.getAddress().size() + 4) / 4) + 4 * ((msg.getNumArgs() + 5) / 4);
+    for (int i = 0; i < msg.getNumArgs(); i++)
+    {
+        if (msg.getArgType(i) == OFXOSC_TYPE_STRING) {
+            size += 4 * ((msg.getArgAsString(i).size() + 4) / 4);
+        }
+        else if (msg.getArgType(i) == OFXOSC_TYPE_INT64) {
+            size += 8;
+        }
+        else {
+            size += 4;
         }
     }
+    return size;
+}
+
+void OscManager::updateSendStatistics()
+{
+    tPackets->setValue(ofToString(numPacketsSent));
+    tBytes->setValue(ofToString(numBytesSent));
+    tDropped->setValue(ofToString(numMessagesDropped));
 }
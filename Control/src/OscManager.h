@@ -3,11 +3,23 @@
 #include "ofMain.h"
 #include "ofxOsc.h"
 #include "GuiWidget.h"
+#include <atomic>
+#include <unordered_map>
 
 
 class OscManager
 {
 public:
+    
+    // latest message received for one address since the last update
+    struct OscSlot
+    {
+        GuiElement *element;
+        ofxOscMessage message;
+        bool fresh;
+        OscSlot(GuiElement *element);
+    };
+
     OscManager();
     ~OscManager();
     
@@ -23,6 +35,20 @@ public:
     
     void update();
     
+    void setCoalesceReceive(bool coalesceReceive) {this->coalesceReceive = coalesceReceive;}
+    void setVerbose(bool verbose);
+    bool getCoalesceReceive() {return coalesceReceive;}
+    bool getVerbose() {return verbose;}
+    
+    void setSendInterval(int sendInterval) {this->sendInterval = sendInterval;}
+    void setMaxBundleSize(int maxBundleSize) {this->maxBundleSize = maxBundleSize;}
+    
+    int getSendInterval() {return sendInterval;}
+    int getMaxBundleSize() {return maxBundleSize;}
+    long getNumPacketsSent() {return numPacketsSent;}
+    long getNumBytesSent() {return numBytesSent;}
+    long getNumMessagesDropped() {return numMessagesDropped;}
+    
     
     void blah() {
         
@@ -39,9 +65,19 @@ private:
     void eventEditHostOut(GuiTextBoxEventArgs &evt);
     void eventEditPortOut(GuiTextBoxEventArgs &evt);
     void eventEditPortIn(GuiTextBoxEventArgs &evt);
+    void eventToggleVerbose(GuiButtonEventArgs &evt);
     
     void receiveOscMessages();
+    void applyOscMessages();
+    void setupOscSlots();
+    void clearOscSlots();
+    void logOscMessage(ofxOscMessage &msg);
     void sendOscMessages();
+    void queueOscMessage(ofxOscMessage &msg);
+    void flushOscMessages();
+    void sendOscBundle(ofxOscBundle &bundle, int bundleSize);
+    int getOscMessageSize(ofxOscMessage &msg);
+    void updateSendStatistics();
     
     ofxOscReceiver receiver;
     ofxOscSender sender;
@@ -53,8 +89,27 @@ private:
     vector<GuiElement*> sParameters;
     map<string,GuiElement*> rParameters;
     
+    vector<OscSlot> rSlots;
+    vector<int> rFreshSlots;
+    unordered_map<string, int> rSlotIndex;
+    bool rSlotsChanged;
+    bool coalesceReceive;
+    std::atomic<bool> verbose;
+    bool logMessages;           // the gui's copy
+    
+    vector<ofxOscMessage> sendQueue;
+    map<string, int> sendQueueIndex;
+    int sendInterval;
+    int maxBundleSize;
+    uint64_t lastSendTime;
+    long numPacketsSent;
+    long numBytesSent;
+    long numMessagesDropped;
+    
     GuiWidget panel;
     string hostOut;
     string portInS, portOutS;
+    string packetsS, bytesS, droppedS;
+    GuiTextBox *tPackets, *tBytes, *tDropped;
 };
 
@@ -423,7 +423,7 @@ void Sequencer::setColumnToCurrentValues(int column)
 
 void Sequencer::next()
 {
-    bpmTime = ofGetElapsedTimeMillis();
+    bpmTime = Bpm::getTimeMicros();
     currentColumn = fmodf(currentColumn + 1.0f, (float) numCols);
     cursor = currentColumn;
     
@@ -444,7 +444,7 @@ void Sequencer::update()
 {
     if (active && smooth)
     {
-        cursor = currentColumn + (ofGetElapsedTimeMillis() - bpmTime) / bpmInterval;
+        cursor = currentColumn + (Bpm::getTimeMicros() - bpmTime) / (1000.0 * bpmInterval);
         map<GuiElement*,ElementSequenceGroup*>::iterator it = groups.begin();
         for (; it != groups.end(); ++it)
         {
@@ -688,9 +688,10 @@ void Sequencer::eventSequencerMenuSelection(GuiMenuEventArgs & evt)
     evt.toggle->getName() == "save new" ? saveSequencerSet() : loadSequencerSet(evt.toggle->getName());
 }
 
-void Sequencer::eventBeat()
+void Sequencer::eventBeat(BpmEventArgs &e)
 {
     next();
+    bpmTime = e.time;
 }
 
 void Sequencer::getXml(ofXml &xml)
@@ -101,14 +101,14 @@ protected:
     void eventRandomizeSequencer(GuiButtonEventArgs &b);
     void eventSelectColumn(GuiSliderEventArgs<int> &b);
     void eventSequencerMenuSelection(GuiMenuEventArgs & evt);
-    void eventBeat();
+    void eventBeat(BpmEventArgs &e);
     
     Bpm clock;
     int numCols;
     int column;
     float cursor;
     int bpm;
-    int bpmTime;
+    int64_t bpmTime;
     float bpmInterval;
     int currentColumn;
     int lerpNumFrames;
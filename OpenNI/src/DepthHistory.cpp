@@ -0,0 +1,318 @@
+#include "DepthHistory.h"
+
+
+DepthHistory::DepthHistory()
+{
+    width = 0;
+    height = 0;
+    capacity = 0;
+    tolerance = 0;
+    encoderTolerance = 0;
+    numPushed = 0;
+    numTaken = 0;
+    numCompressed = 0;
+    numDropped = 0;
+    firstFrame = 0;
+    compressedBytes = 0;
+    groupBytes = 0;
+    decodedFrame = -1;
+    memoryBudget = 0;
+}
+
+DepthHistory::~DepthHistory()
+{
+    stop();
+}
+
+void DepthHistory::setup(int width, int height, int capacity)
+{
+    stop();
+    this->width = width;
+    this->height = height;
+    this->capacity = max(capacity, 1);
+    for (int i = 0; i < DEPTHHISTORY_RAW_FRAMES; i++)
+    {
+        raw[i].allocate(width, height, 1);
+        raw[i].set(0);
+    }
+    decoded.allocate(width, height, 1);
+    decoded.set(0);
+    decodedFrame = -1;
+    taken.assign(width * height, 0);
+    reference.assign(width * height, 0);
+    frames.clear();
+    numPushed = 0;
+    numTaken = 0;
+    numCompressed = 0;
+    numDropped = 0;
+    firstFrame = 0;
+    compressedBytes = 0;
+    groupBytes = 0;
+    encoderTolerance = (int) tolerance;
+    if (memoryBudget == 0) {
+        memoryBudget = (size_t) this->capacity * width * height * sizeof(unsigned short) / DEPTHHISTORY_MEMORY_FRACTION;
+    }
+    startThread(true, false);
+}
+
+void DepthHistory::stop()
+{
+    if (!isThreadRunning()) return;
+    stopThread();
+    {
+        std::lock_guard<std::mutex> historyLock(historyMutex);
+    }
+    historyCondition.notify_all();
+    waitForThread(false);
+}
+
+void DepthHistory::setMemoryBudget(int megabytes)
+{
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    memoryBudget = (size_t) max(megabytes, 1) * 1024 * 1024;
+}
+
+void DepthHistory::push(ofShortPixels &pixels)
+{
+    int64_t frame;
+    {
+        std::lock_guard<std::mutex> historyLock(historyMutex);
+        
+        // the compressor is DEPTHHISTORY_RAW_FRAMES behind, give up the oldest frame it has not taken
+        if (numPushed - numTaken >= DEPTHHISTORY_RAW_FRAMES)
+        {
+            numTaken++;
+            numDropped++;
+        }
+        frame = numPushed;
+    }
+    
+    // the compressor only copies the frames from numTaken on, never this slot
+    raw[frame % DEPTHHISTORY_RAW_FRAMES] = pixels;
+    
+    {
+        std::lock_guard<std::mutex> historyLock(historyMutex);
+        numPushed++;
+    }
+    historyCondition.notify_all();
+}
+
+ofShortPixels & DepthHistory::get(int delay)
+{
+    int64_t frame, start;
+    {
+        std::lock_guard<std::mutex> historyLock(historyMutex);
+        if (numPushed == 0) {
+            return decoded;
+        }
+        
+        // the newest frames are still raw, as are the ones the compressor has not got to
+        int64_t oldestRaw = max(numPushed - DEPTHHISTORY_RAW_FRAMES, (int64_t) 0);
+        frame = numPushed - 1 - max(delay, 0);
+        if (frame >= oldestRaw || frame >= numCompressed || frames.empty()) {
+            return raw[max(frame, oldestRaw) % DEPTHHISTORY_RAW_FRAMES];
+        }
+        frame = max(frame, firstFrame);
+        if (frame == decodedFrame) {
+            return decoded;
+        }
+        
+        // continue from the last decoded frame when it is in the same group
+        int64_t key = frame - frame % DEPTHHISTORY_KEYFRAME_INTERVAL;
+        start = decodedFrame >= key && decodedFrame < frame ? decodedFrame + 1 : key;
+        decoding.assign(frames.begin() + (start - firstFrame), frames.begin() + (frame - firstFrame) + 1);
+    }
+    
+    // the frames are shared, eviction can't free them while they are decoded here
+    if (start % DEPTHHISTORY_KEYFRAME_INTERVAL == 0) {
+        decoded.set(0);
+    }
+    for (auto & f : decoding) {
+        decode(*f, decoded.getPixels());
+    }
+    decoding.clear();
+    decodedFrame = frame;
+    return decoded;
+}
+
+int DepthHistory::getMaxDelay()
+{
+    return max(getNumFrames() - 1, 0);
+}
+
+int DepthHistory::getNumFrames()
+{
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    int64_t oldest = frames.empty() ? max(numPushed - DEPTHHISTORY_RAW_FRAMES, (int64_t) 0) : firstFrame;
+    return numPushed - oldest;
+}
+
+size_t DepthHistory::getMemoryUsage()
+{
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    return compressedBytes + (DEPTHHISTORY_RAW_FRAMES + 3) * width * height * sizeof(unsigned short);
+}
+
+float DepthHistory::getCompressionRatio()
+{
+    std::lock_guard<std::mutex> historyLock(historyMutex);
+    if (compressedBytes == 0) return 1.0;
+    return (float) frames.size() * width * height * sizeof(unsigned short) / compressedBytes;
+}
+
+void DepthHistory::threadedFunction()
+{
+    vector<Frame> encoded;
+    while (isThreadRunning())
+    {
+        int64_t first, frame;
+        {
+            std::unique_lock<std::mutex> historyLock(historyMutex);
+            historyCondition.wait(historyLock, [this] { return numTaken < numPushed || !isThreadRunning(); });
+            if (numTaken == numPushed) {
+                continue;
+            }
+            first = numCompressed;
+            frame = numTaken++;
+            
+            // copied under the lock, push may reuse the slot as soon as numTaken has moved past it
+            memcpy(&taken[0], raw[frame % DEPTHHISTORY_RAW_FRAMES].getPixels(), taken.size() * sizeof(unsigned short));
+        }
+        
+        // the frames push gave up repeat the one before them
+        encoded.clear();
+        for (int64_t f = first; f <= frame; f++)
+        {
+            bool key = f % DEPTHHISTORY_KEYFRAME_INTERVAL == 0;
+            encoded.push_back(Frame(new vector<uint8_t>()));
+            if (f == frame) {
+                encode(&taken[0], *encoded.back(), key);
+            }
+            else if (key)
+            {
+                vector<unsigned short> repeat(reference);
+                encode(&repeat[0], *encoded.back(), key);
+            }
+            encoded.back()->shrink_to_fit();
+        }
+        
+        {
+            std::lock_guard<std::mutex> historyLock(historyMutex);
+            if (frames.empty()) {
+                firstFrame = first;
+            }
+            for (int64_t f = first; f <= frame; f++)
+            {
+                size_t bytes = encoded[f - first]->size();
+                frames.push_back(encoded[f - first]);
+                compressedBytes += bytes;
+                groupBytes += bytes;
+                if (f % DEPTHHISTORY_KEYFRAME_INTERVAL == DEPTHHISTORY_KEYFRAME_INTERVAL - 1)
+                {
+                    adaptTolerance(groupBytes);
+                    groupBytes = 0;
+                }
+            }
+            numCompressed = frame + 1;
+            evict();
+        }
+    }
+}
+
+void DepthHistory::encode(const unsigned short *pixels, vector<uint8_t> &data, bool key)
+{
+    // zero run: 0x00 followed by its length as a varint
+    // difference: zigzag encoded varint, never starting with 0x00
+    data.reserve(width * height / 4);
+    int threshold = max((int) tolerance, (int) encoderTolerance);
+    if (key) {
+        fill(reference.begin(), reference.end(), 0);
+    }
+
+    int n = width * height;
+    int run = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int delta = (int) pixels[i] - (int) reference[i];
+        if (abs(delta) <= threshold)
+        {
+            run++;
+            continue;
+        }
+        if (run > 0)
+        {
+            data.push_back(0);
+            for (; run >= 0x80; run >>= 7) {
+                data.push_back((run & 0x7f) | 0x80);
+            }
+            data.push_back(run);
+            run = 0;
+        }
+        reference[i] = pixels[i];
+        uint32_t v = (delta << 1) ^ (delta >> 31);
+        for (; v >= 0x80; v >>= 7) {
+            data.push_back((v & 0x7f) | 0x80);
+        }
+        data.push_back(v);
+    }
+}
+
+void DepthHistory::decode(const vector<uint8_t> &data, unsigned short *pixels)
+{
+    int n = width * height;
+    int i = 0;
+    size_t p = 0;
+    while (p < data.size() && i < n)
+    {
+        bool run = data[p] == 0;
+        if (run) {
+            p++;
+        }
+        uint32_t v = 0;
+        for (int shift = 0; p < data.size(); shift += 7)
+        {
+            uint8_t b = data[p++];
+            v |= (uint32_t) (b & 0x7f) << shift;
+            if ((b & 0x80) == 0) break;
+        }
+        if (run) {
+            i += v;
+        }
+        else
+        {
+            int delta = (int) (v >> 1) ^ -(int) (v & 1);
+            pixels[i] = pixels[i] + delta;
+            i++;
+        }
+    }
+}
+
+void DepthHistory::adaptTolerance(size_t groupBytes)
+{
+    // each group's share of the budget, with room for the one being filled
+    size_t share = memoryBudget / (capacity / DEPTHHISTORY_KEYFRAME_INTERVAL + 1);
+    int threshold = encoderTolerance;
+    if (groupBytes > share) {
+        threshold += groupBytes > 2 * share ? 2 : 1;
+    }
+    else if (groupBytes < share / 2) {
+        threshold--;
+    }
+    encoderTolerance = max((int) tolerance, min(threshold, DEPTHHISTORY_MAX_TOLERANCE));
+}
+
+void DepthHistory::evict()
+{
+    // drop whole keyframe groups from the front, keeping at least one and,
+    // within the budget, at least capacity frames
+    while (frames.size() > DEPTHHISTORY_KEYFRAME_INTERVAL && (compressedBytes > memoryBudget || frames.size() >= capacity + DEPTHHISTORY_KEYFRAME_INTERVAL))
+    {
+        do
+        {
+            compressedBytes -= frames.front()->size();
+            frames.pop_front();
+            firstFrame++;
+        }
+        while (!frames.empty() && firstFrame % DEPTHHISTORY_KEYFRAME_INTERVAL != 0);
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#define DEPTHHISTORY_RAW_FRAMES 8
+#define DEPTHHISTORY_KEYFRAME_INTERVAL 32
+#define DEPTHHISTORY_MEMORY_FRACTION 10     // default budget, of the raw frames
+#define DEPTHHISTORY_MAX_TOLERANCE 20
+
+
+// Delay line of depth frames kept within a memory budget. The newest
+// DEPTHHISTORY_RAW_FRAMES frames are held as they are; a background thread
+// encodes older ones as the difference to the previous frame, with runs of
+// unchanged pixels collapsed and the remaining differences stored as
+// variable-length integers. Every DEPTHHISTORY_KEYFRAME_INTERVAL frames the
+// chain restarts from zero, so the oldest group can be dropped whole when
+// the budget is exceeded. Differences within the tolerance (in depth units)
+// are treated as unchanged; the encoder compares against its own
+// reconstruction, so the error never exceeds the tolerance.
+//
+// The budget defaults to 1/DEPTHHISTORY_MEMORY_FRACTION of the raw frames.
+// The tolerance set is a minimum: after each group the encoder raises it by
+// one while the group was larger than its share of the budget, up to
+// DEPTHHISTORY_MAX_TOLERANCE, and lowers it again when there is room, so
+// the whole capacity fits however noisy the sensor is.
+//
+// push never waits: when the compressor is DEPTHHISTORY_RAW_FRAMES behind,
+// the oldest frame it has not taken yet is dropped and stored as a repeat
+// of the frame before it.
+
+class DepthHistory : public ofThread
+{
+public:
+    DepthHistory();
+    ~DepthHistory();
+
+    void setup(int width, int height, int capacity);
+    void stop();
+
+    void setMemoryBudget(int megabytes);
+    void setTolerance(int tolerance) {this->tolerance = tolerance;}
+    int getMemoryBudget() {return memoryBudget / (1024 * 1024);}
+    int getTolerance() {return tolerance;}
+    int getEncoderTolerance() {return encoderTolerance;}
+
+    void push(ofShortPixels &pixels);
+
+    // frame delay frames before the newest one, or the oldest one held.
+    // only valid until the next call to push or get, from the thread that
+    // pushes
+    ofShortPixels & get(int delay);
+
+    // the longest delay get can give now
+    int getMaxDelay();
+    int getNumFrames();
+    int getNumDropped() {return numDropped;}
+    size_t getMemoryUsage();
+    float getCompressionRatio();
+
+private:
+
+    // shared so that get can decode after letting go of the lock
+    typedef ofPtr<vector<uint8_t> > Frame;
+
+    void threadedFunction();
+    void encode(const unsigned short *pixels, vector<uint8_t> &data, bool key);
+    void decode(const vector<uint8_t> &data, unsigned short *pixels);
+    void adaptTolerance(size_t groupBytes);
+    void evict();
+
+    int width, height;
+    int capacity;
+    size_t memoryBudget;
+    std::atomic<int> tolerance;
+    std::atomic<int> encoderTolerance;
+
+    ofShortPixels raw[DEPTHHISTORY_RAW_FRAMES];
+    int64_t numPushed;
+    int64_t numTaken;
+    int64_t numCompressed;
+    std::atomic<int> numDropped;
+
+    deque<Frame> frames;
+    int64_t firstFrame;
+    size_t compressedBytes;
+
+    // owned by the compressor
+    vector<unsigned short> taken;
+    vector<unsigned short> reference;
+    size_t groupBytes;
+
+    // owned by the thread calling get
+    ofShortPixels decoded;
+    int64_t decodedFrame;
+    vector<Frame> decoding;
+
+    std::mutex historyMutex;
+    std::condition_variable historyCondition;
+};
@@ -6,18 +6,68 @@
 
 #include "ofMain.h"
 
+
+// Fixed-size history kept in a circular buffer. Index 0 is the newest
+// value, depth-1 the oldest. A copy of the newest value is kept apart so
+// references to it stay valid across pushes.
+
+template <typename T>
+class MocapHistory
+{
+public:
+    MocapHistory() : head(0), current(T()) { }
+
+    void setDepth(int depth, T value)
+    {
+        buffer.assign(max(depth, 1), value);
+        head = 0;
+        current = value;
+    }
+
+    // returns the oldest value, which the new one overwrites
+    T push(const T & value)
+    {
+        head = (head + 1) % buffer.size();
+        T oldest = buffer[head];
+        buffer[head] = value;
+        current = value;
+        return oldest;
+    }
+
+    const T & operator[](int i) const {return buffer[(head + buffer.size() - i) % buffer.size()];}
+    int size() const {return buffer.size();}
+    T & getCurrentRef() {return current;}
+
+    vector<T> toVector(int frames) const
+    {
+        vector<T> history(min(frames, size()));
+        for (int i = 0; i < history.size(); i++) {
+            history[i] = (*this)[i];
+        }
+        return history;
+    }
+
+    vector<T> toVector() const {return toVector(size());}
+
+private:
+    vector<T> buffer;
+    int head;
+    T current;
+};
+
+
 class MocapElement
 {
 public:
     MocapElement();
     MocapElement(int elementId, int depth);
-    
+
     void setElementId(int newId) {elementId_ = newId;}
     unsigned int getElementId() {return elementId_;}
-    
+
     void setHistoryDepth(int depth);
     int getHistoryDepth() {return historyDepth_;}
-    
+
     void setPosition(ofPoint position);
     void setPositionFiltered(ofPoint positionFiltered);
     void setVelocity(ofPoint velocity);
@@ -30,50 +80,50 @@ public:
     void setDistanceToTorso(float distanceToTorso);
     void setRelativePositionToTorso(ofPoint relativePositionToTorso);
 
-    vector<ofPoint> getPosition() {return position_;}
-    vector<ofPoint> getPositionFiltered() {return positionFiltered_;}
-    vector<ofPoint> getVelocity() {return velocity_;}
-    vector<float>   getVelocityMagnitude() {return velocityMagnitude_;}
-    vector<float>   getVelocityMean() {return velocityMean_;}
-    vector<ofPoint> getAcceleration() {return acceleration_;}
-    vector<float>   getAccelerationMagnitude() {return accelerationMagnitude_;}
-    vector<float>   getAccelerationMean() {return accelerationMean_;}
-    vector<float>   getAccelerationTrajectory() {return accelerationTrajectory_;}
-    vector<float>   getDistanceToTorso() {return distanceToTorso_;}
-    vector<ofPoint> getRelativePositionToTorso() {return relativePositionToTorso_;}
-    
-    vector<ofPoint> & getPositionRef() {return position_;}
-    vector<ofPoint> & getPositionFilteredRef() {return positionFiltered_;}
-    vector<ofPoint> & getVelocityRef() {return velocity_;}
-    vector<float>   & getVelocityMagnitudeRef() {return velocityMagnitude_;}
-    vector<float>   & getVelocityMeanRef() {return velocityMean_;}
-    vector<ofPoint> & getAccelerationRef() {return acceleration_;}
-    vector<float>   & getAccelerationMagnitudeRef() {return accelerationMagnitude_;}
-    vector<float>   & getAccelerationMeanRef() {return accelerationMean_;}
-    vector<float>   & getAccelerationTrajectoryRef() {return accelerationTrajectory_;}
-    vector<float>   & getDistanceToTorsoRef() {return distanceToTorso_;}
-    vector<ofPoint> & getRelativePositionToTorsoRef() {return relativePositionToTorso_;}
-    
+    const MocapHistory<ofPoint> & getPosition() const {return position_;}
+    const MocapHistory<ofPoint> & getPositionFiltered() const {return positionFiltered_;}
+    const MocapHistory<ofPoint> & getVelocity() const {return velocity_;}
+    const MocapHistory<float>   & getVelocityMagnitude() const {return velocityMagnitude_;}
+    const MocapHistory<float>   & getVelocityMean() const {return velocityMean_;}
+    const MocapHistory<ofPoint> & getAcceleration() const {return acceleration_;}
+    const MocapHistory<float>   & getAccelerationMagnitude() const {return accelerationMagnitude_;}
+    const MocapHistory<float>   & getAccelerationMean() const {return accelerationMean_;}
+    const MocapHistory<float>   & getAccelerationTrajectory() const {return accelerationTrajectory_;}
+    const MocapHistory<float>   & getDistanceToTorso() const {return distanceToTorso_;}
+    const MocapHistory<ofPoint> & getRelativePositionToTorso() const {return relativePositionToTorso_;}
+
+    ofPoint & getPositionRef() {return position_.getCurrentRef();}
+    ofPoint & getPositionFilteredRef() {return positionFiltered_.getCurrentRef();}
+    ofPoint & getVelocityRef() {return velocity_.getCurrentRef();}
+    float   & getVelocityMagnitudeRef() {return velocityMagnitude_.getCurrentRef();}
+    float   & getVelocityMeanRef() {return velocityMean_.getCurrentRef();}
+    ofPoint & getAccelerationRef() {return acceleration_.getCurrentRef();}
+    float   & getAccelerationMagnitudeRef() {return accelerationMagnitude_.getCurrentRef();}
+    float   & getAccelerationMeanRef() {return accelerationMean_.getCurrentRef();}
+    float   & getAccelerationTrajectoryRef() {return accelerationTrajectory_.getCurrentRef();}
+    float   & getDistanceToTorsoRef() {return distanceToTorso_.getCurrentRef();}
+    ofPoint & getRelativePositionToTorsoRef() {return relativePositionToTorso_.getCurrentRef();}
+
 private:
-    
+
     void initialize();
-    
+
     int historyDepth_;
     float historyWeight_;
     int elementId_;
-    
+
     float velocityMeanRunning_;
     float accelerationMeanRunning_;
 
-    vector<ofPoint> position_;
-    vector<ofPoint> positionFiltered_;
-    vector<ofPoint> velocity_;
-    vector<float> velocityMagnitude_;
-    vector<float> velocityMean_;
-    vector<ofPoint> acceleration_;
-    vector<float> accelerationMagnitude_;
-    vector<float> accelerationMean_;
-    vector<float> accelerationTrajectory_;
-    vector<float> distanceToTorso_;
-    vector<ofPoint> relativePositionToTorso_;
+    MocapHistory<ofPoint> position_;
+    MocapHistory<ofPoint> positionFiltered_;
+    MocapHistory<ofPoint> velocity_;
+    MocapHistory<float> velocityMagnitude_;
+    MocapHistory<float> velocityMean_;
+    MocapHistory<ofPoint> acceleration_;
+    MocapHistory<float> accelerationMagnitude_;
+    MocapHistory<float> accelerationMean_;
+    MocapHistory<float> accelerationTrajectory_;
+    MocapHistory<float> distanceToTorso_;
+    MocapHistory<ofPoint> relativePositionToTorso_;
 };
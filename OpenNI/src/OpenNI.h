@@ -10,7 +10,9 @@
 
 #include "Control.h"
 
+#include "OpenNIFeatures.h"
 #include "OpenNIUser.h"
+#include "DepthHistory.h"
 #include "OpenNITracker.h"
 #include "CalibrationModule.h"
 
@@ -0,0 +1,220 @@
+#include "OpenNIFeatures.h"
+#include "OpenNIUser.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+
+OpenNIFeatures::OpenNIFeatures()
+{
+    updateTime = 0.0;
+}
+
+int OpenNIFeatures::addUser(OpenNIUser *user)
+{
+    int slot = 0;
+    while (slot < slots.size() && slots[slot].active) {
+        slot++;
+    }
+    if (slot == slots.size())
+    {
+        slots.resize(slot + 1);
+        positions.resize((slot + 1) * OPENNI_FEATURES_TAPS * OPENNI_FEATURES_STRIDE);
+        filtered.resize(positions.size());
+        velocities.resize(positions.size());
+        accelerations.resize(positions.size());
+        relativePositions.resize((slot + 1) * OPENNI_FEATURES_STRIDE);
+        velocityMagnitudes.resize((slot + 1) * OPENNI_FEATURES_JOINTS);
+        accelerationMagnitudes.resize(velocityMagnitudes.size());
+        accelerationTrajectories.resize(velocityMagnitudes.size());
+        distancesToTorso.resize(velocityMagnitudes.size());
+    }
+    resetSlot(slot);
+    slots[slot].user = user;
+    slots[slot].active = true;
+    return slot;
+}
+
+void OpenNIFeatures::removeUser(int slot)
+{
+    if (slot < 0 || slot >= slots.size()) return;
+    slots[slot].user = NULL;
+    slots[slot].active = false;
+    slots[slot].staged = false;
+}
+
+void OpenNIFeatures::setFilter(int slot, float *aFilter, float *bFilter, float *aLpd1, float *bLpd1, float *aLpd2, float *bLpd2)
+{
+    Slot &s = slots[slot];
+    s.a[0] = aFilter;
+    s.b[0] = bFilter;
+    s.a[1] = aLpd1;
+    s.b[1] = bLpd1;
+    s.a[2] = aLpd2;
+    s.b[2] = bLpd2;
+}
+
+bool OpenNIFeatures::setJoints(int slot, ofxOpenNIUser *user)
+{
+    if (user->getJoint(JOINT_TORSO).getWorldPosition() == ofPoint(0,0,0))   return false;
+
+    Slot &s = slots[slot];
+    s.numJoints = min(user->getNumJoints(), OPENNI_FEATURES_JOINTS);
+    s.head = (s.head + 1) % OPENNI_FEATURES_TAPS;
+    s.staged = true;
+
+    float *position = getRow(positions, slot, s.head);
+    for (int j = 0; j < s.numJoints; j++)
+    {
+        const ofPoint &p = user->getJoint((Joint) j).getWorldPosition();
+        position[j] = p.x;
+        position[OPENNI_FEATURES_JOINTS + j] = p.y;
+        position[2 * OPENNI_FEATURES_JOINTS + j] = p.z;
+    }
+    return true;
+}
+
+void OpenNIFeatures::update()
+{
+    uint64_t t0 = ofGetElapsedTimeMicros();
+
+    for (int slot = 0; slot < slots.size(); slot++)
+    {
+        Slot &s = slots[slot];
+        if (!s.active || !s.staged) continue;
+        applyFilter(filtered, slot, s.a[0], s.b[0]);
+        applyFilter(velocities, slot, s.a[1], s.b[1]);
+        applyFilter(accelerations, slot, s.a[2], s.b[2]);
+        computeDescriptors(slot);
+    }
+
+    updateTime = 0.001 * (ofGetElapsedTimeMicros() - t0);
+
+    for (int slot = 0; slot < slots.size(); slot++)
+    {
+        if (slots[slot].active && slots[slot].staged)
+        {
+            slots[slot].staged = false;
+            slots[slot].user->updateFeatures();
+        }
+    }
+}
+
+float * OpenNIFeatures::getRow(vector<float> &data, int slot, int tap)
+{
+    return &data[(slot * OPENNI_FEATURES_TAPS + tap) * OPENNI_FEATURES_STRIDE];
+}
+
+void OpenNIFeatures::applyFilter(vector<float> &output, int slot, float *a, float *b)
+{
+    // y0 = b0*x0 + b1*x1 + b2*x2 + b3*x3 + b4*x4 - (a1*y1 + a2*y2 + a3*y3 + a4*y4)
+    int head = slots[slot].head;
+    const float *x[OPENNI_FEATURES_TAPS];
+    const float *y[OPENNI_FEATURES_TAPS];
+    for (int t = 0; t < OPENNI_FEATURES_TAPS; t++)
+    {
+        int tap = (head - t + OPENNI_FEATURES_TAPS) % OPENNI_FEATURES_TAPS;
+        x[t] = getRow(positions, slot, tap);
+        y[t] = getRow(output, slot, tap);
+    }
+    float *y0 = getRow(output, slot, head);
+
+#if defined(__SSE__)
+    __m128 b0 = _mm_set1_ps(b[0]), b1 = _mm_set1_ps(b[1]), b2 = _mm_set1_ps(b[2]), b3 = _mm_set1_ps(b[3]), b4 = _mm_set1_ps(b[4]);
+    __m128 a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]), a3 = _mm_set1_ps(a[3]), a4 = _mm_set1_ps(a[4]);
+    for (int i = 0; i < OPENNI_FEATURES_STRIDE; i += 4)
+    {
+        __m128 acc = _mm_mul_ps(b0, _mm_loadu_ps(x[0] + i));
+        acc = _mm_add_ps(acc, _mm_mul_ps(b1, _mm_loadu_ps(x[1] + i)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(b2, _mm_loadu_ps(x[2] + i)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(b3, _mm_loadu_ps(x[3] + i)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(b4, _mm_loadu_ps(x[4] + i)));
+        __m128 fb = _mm_mul_ps(a1, _mm_loadu_ps(y[1] + i));
+        fb = _mm_add_ps(fb, _mm_mul_ps(a2, _mm_loadu_ps(y[2] + i)));
+        fb = _mm_add_ps(fb, _mm_mul_ps(a3, _mm_loadu_ps(y[3] + i)));
+        fb = _mm_add_ps(fb, _mm_mul_ps(a4, _mm_loadu_ps(y[4] + i)));
+        _mm_storeu_ps(y0 + i, _mm_sub_ps(acc, fb));
+    }
+#else
+    for (int i = 0; i < OPENNI_FEATURES_STRIDE; i++) {
+        y0[i] = b[0]*x[0][i] + b[1]*x[1][i] + b[2]*x[2][i] + b[3]*x[3][i] + b[4]*x[4][i] - (a[1]*y[1][i] + a[2]*y[2][i] + a[3]*y[3][i] + a[4]*y[4][i]);
+    }
+#endif
+}
+
+void OpenNIFeatures::computeDescriptors(int slot)
+{
+    const int J = OPENNI_FEATURES_JOINTS;
+    Slot &s = slots[slot];
+    const float *p = getRow(positions, slot, s.head);
+    const float *pf = getRow(filtered, slot, s.head);
+    const float *v = getRow(velocities, slot, s.head);
+    const float *a = getRow(accelerations, slot, s.head);
+    float *rel = &relativePositions[slot * OPENNI_FEATURES_STRIDE];
+    float *velMag = &velocityMagnitudes[slot * J];
+    float *accMag = &accelerationMagnitudes[slot * J];
+    float *accTraj = &accelerationTrajectories[slot * J];
+    float *dist = &distancesToTorso[slot * J];
+
+    float tx = pf[JOINT_TORSO], ty = pf[J + JOINT_TORSO], tz = pf[2*J + JOINT_TORSO];
+    float headTorsoDist = getPoint(p, JOINT_HEAD).distance(getPoint(p, JOINT_TORSO));
+
+    float xMin = numeric_limits<float>::max(), yMin = xMin, zMin = xMin;
+    float xMax = -numeric_limits<float>::max(), yMax = xMax, zMax = xMax;
+    float meanVel = 0.0;
+
+    for (int j = 0; j < s.numJoints; j++)
+    {
+        velMag[j] = sqrt(v[j]*v[j] + v[J+j]*v[J+j] + v[2*J+j]*v[2*J+j]);
+        accMag[j] = sqrt(a[j]*a[j] + a[J+j]*a[J+j] + a[2*J+j]*a[2*J+j]);
+        accTraj[j] = (a[j]*v[j] + a[J+j]*v[J+j] + a[2*J+j]*v[2*J+j]) / velMag[j];
+
+        float dx = pf[j] - tx, dy = pf[J+j] - ty, dz = pf[2*J+j] - tz;
+        dist[j] = dx*dx + dy*dy + dz*dz;
+
+        rel[j] = (p[j] - tx) / (headTorsoDist * 1.8);
+        rel[J+j] = (p[J+j] - ty) / (headTorsoDist * 1.8);
+        rel[2*J+j] = -((p[2*J+j] - tz) / headTorsoDist) / 1.4;
+
+        //qom
+        meanVel += velMag[j];
+
+        //ci
+        xMin = min(xMin, pf[j]);
+        yMin = min(yMin, pf[J+j]);
+        zMin = min(zMin, pf[2*J+j]);
+        xMax = max(xMax, pf[j]);
+        yMax = max(yMax, pf[J+j]);
+        zMax = max(zMax, pf[2*J+j]);
+    }
+
+    s.meanVelocity = meanVel / s.numJoints;
+    s.ci = ( -4.0 + (( abs(xMax-xMin) + abs(yMax-yMin) + abs(zMax-zMin) ) / headTorsoDist) ) / 6.0;
+    s.symmetry = 1.0 - (0.5 * (abs(sqrt(dist[JOINT_RIGHT_HAND])-sqrt(dist[JOINT_LEFT_HAND])) + abs(sqrt(dist[JOINT_RIGHT_ELBOW])-sqrt(dist[JOINT_LEFT_ELBOW]))) / headTorsoDist);
+    s.yMaxHands = max(rel[J + JOINT_RIGHT_HAND], rel[J + JOINT_LEFT_HAND]);
+}
+
+void OpenNIFeatures::resetSlot(int slot)
+{
+    Slot &s = slots[slot];
+    s.user = NULL;
+    s.head = 0;
+    s.numJoints = 0;
+    s.active = false;
+    s.staged = false;
+    s.meanVelocity = s.ci = s.symmetry = s.yMaxHands = 0.0;
+    setFilter(slot, OpenNIUser::lpf_soft_a, OpenNIUser::lpf_soft_b, OpenNIUser::lpd1_soft_a, OpenNIUser::lpd1_soft_b, OpenNIUser::lpd2_soft_a, OpenNIUser::lpd2_soft_b);
+
+    int n = OPENNI_FEATURES_TAPS * OPENNI_FEATURES_STRIDE;
+    fill(positions.begin() + slot * n, positions.begin() + (slot + 1) * n, 0.0f);
+    fill(filtered.begin() + slot * n, filtered.begin() + (slot + 1) * n, 0.0f);
+    fill(velocities.begin() + slot * n, velocities.begin() + (slot + 1) * n, 0.0f);
+    fill(accelerations.begin() + slot * n, accelerations.begin() + (slot + 1) * n, 0.0f);
+    fill(relativePositions.begin() + slot * OPENNI_FEATURES_STRIDE, relativePositions.begin() + (slot + 1) * OPENNI_FEATURES_STRIDE, 0.0f);
+}
+
+ofPoint OpenNIFeatures::getPoint(const float *block, int j)
+{
+    return ofPoint(block[j], block[OPENNI_FEATURES_JOINTS + j], block[2 * OPENNI_FEATURES_JOINTS + j]);
+}
@@ -0,0 +1,100 @@
+/*
+ Batch skeleton feature engine for OpenNIUser.
+ Real-time filters for MoCap by Skogstad et al ( http://www.uio.no/english/research/groups/fourms/projects/sma/subprojects/mocapfilters/ )
+ */
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOpenNI.h"
+
+#define OPENNI_FEATURES_JOINTS 16   // joints per user, padded to a multiple of 4
+#define OPENNI_FEATURES_STRIDE (3 * OPENNI_FEATURES_JOINTS)
+#define OPENNI_FEATURES_TAPS 5
+
+
+class OpenNIUser;
+
+
+// Joints of all tracked users are stored as structure-of-arrays. Each user
+// owns a slot; within a slot a frame is laid out axis-major (all x, then all
+// y, then all z), and the last OPENNI_FEATURES_TAPS frames of positions,
+// filtered positions, velocities and accelerations are kept in a ring. The
+// lowpass and derivative filters run as vector kernels over whole frames, and
+// the per-joint and per-user descriptors are then computed in one pass.
+
+class OpenNIFeatures
+{
+public:
+    OpenNIFeatures();
+
+    int addUser(OpenNIUser *user);
+    void removeUser(int slot);
+
+    void setFilter(int slot, float *aFilter, float *bFilter, float *aLpd1, float *bLpd1, float *aLpd2, float *bLpd2);
+
+    // stage the current skeleton of a user, false if it has no valid torso
+    bool setJoints(int slot, ofxOpenNIUser *user);
+
+    // filter staged users and hand their features back to them
+    void update();
+
+    float getUpdateTime() {return updateTime;}
+
+    // current frame, axis-major blocks of OPENNI_FEATURES_STRIDE floats
+    const float * getPosition(int slot) {return getRow(positions, slot, slots[slot].head);}
+    const float * getPositionFiltered(int slot) {return getRow(filtered, slot, slots[slot].head);}
+    const float * getVelocity(int slot) {return getRow(velocities, slot, slots[slot].head);}
+    const float * getAcceleration(int slot) {return getRow(accelerations, slot, slots[slot].head);}
+    const float * getRelativePositionToTorso(int slot) {return &relativePositions[slot * OPENNI_FEATURES_STRIDE];}
+
+    // current frame, OPENNI_FEATURES_JOINTS floats
+    const float * getVelocityMagnitude(int slot) {return &velocityMagnitudes[slot * OPENNI_FEATURES_JOINTS];}
+    const float * getAccelerationMagnitude(int slot) {return &accelerationMagnitudes[slot * OPENNI_FEATURES_JOINTS];}
+    const float * getAccelerationTrajectory(int slot) {return &accelerationTrajectories[slot * OPENNI_FEATURES_JOINTS];}
+    const float * getDistanceToTorso(int slot) {return &distancesToTorso[slot * OPENNI_FEATURES_JOINTS];}
+
+    int getNumJoints(int slot) {return slots[slot].numJoints;}
+    float getMeanVelocity(int slot) {return slots[slot].meanVelocity;}
+    float getCI(int slot) {return slots[slot].ci;}
+    float getSymmetry(int slot) {return slots[slot].symmetry;}
+    float getYMaxHands(int slot) {return slots[slot].yMaxHands;}
+
+    static ofPoint getPoint(const float *block, int j);
+
+private:
+
+    struct Slot
+    {
+        OpenNIUser *user;
+        float *a[3], *b[3];
+        int head;
+        int numJoints;
+        bool active, staged;
+        float meanVelocity, ci, symmetry, yMaxHands;
+    };
+
+    float * getRow(vector<float> &data, int slot, int tap);
+    void applyFilter(vector<float> &y, int slot, float *a, float *b);
+    void computeDescriptors(int slot);
+    void resetSlot(int slot);
+
+    vector<Slot> slots;
+
+    // slot * OPENNI_FEATURES_TAPS * OPENNI_FEATURES_STRIDE
+    vector<float> positions;
+    vector<float> filtered;
+    vector<float> velocities;
+    vector<float> accelerations;
+
+    // slot * OPENNI_FEATURES_STRIDE
+    vector<float> relativePositions;
+
+    // slot * OPENNI_FEATURES_JOINTS
+    vector<float> velocityMagnitudes;
+    vector<float> accelerationMagnitudes;
+    vector<float> accelerationTrajectories;
+    vector<float> distancesToTorso;
+
+    float updateTime;
+};
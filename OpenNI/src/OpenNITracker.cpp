@@ -1,17 +1,178 @@
 #include "OpenNITracker.h"
 
+#define OPENNI_CONTOUR_DIRTY 4
+
+
+void OpenNI::ContourStage::setup(int width, int height)
+{
+    grayImage.allocate(width, height);
+	grayThreshNear.allocate(width, height);
+	grayThreshFar.allocate(width, height);
+    grayMask.allocate(width, height);
+    masked = false;
+}
+
+void OpenNI::ContourStage::setMask(ofPixels &mask)
+{
+    grayMask.setFromPixels(mask);
+    masked = true;
+}
+
+void OpenNI::ContourStage::process(ofShortPixels &depth, ContourParameters &parameters, ContourSnapshot &snapshot)
+{
+    grayImage.setFromPixels(depth);
+    if (masked) {
+        cvSet(grayImage.getCvImage(), cvScalarAll(0), grayMask.getCvImage());
+    }
+    
+    grayThreshNear = grayImage;
+    grayThreshFar = grayImage;
+    grayThreshNear.threshold(parameters.nearThreshold, true);
+    grayThreshFar.threshold(parameters.farThreshold);
+    cvAnd(grayThreshNear.getCvImage(), grayThreshFar.getCvImage(), grayImage.getCvImage(), NULL);
+    grayImage.flagImageChanged();
+    contourFinder.setMinArea(parameters.minArea);
+    contourFinder.setMaxArea(parameters.maxArea);
+    contourFinder.setThreshold(parameters.threshold);
+    contourFinder.setSimplify(parameters.simplified);
+    contourFinder.getTracker().setPersistence(parameters.persistence);
+    contourFinder.getTracker().setMaximumDistance(parameters.maxDistance);
+    contourFinder.getTracker().setSmoothingRate(parameters.smoothingRate);
+    contourFinder.findContours(grayImage);
+    
+    snapshot.contours = contourFinder.getContours();
+    snapshot.polylines = contourFinder.getPolylines();
+    snapshot.labels.resize(contourFinder.size());
+    snapshot.centers.resize(contourFinder.size());
+    for (int i = 0; i < contourFinder.size(); i++)
+    {
+        snapshot.labels[i] = contourFinder.getLabel(i);
+        snapshot.centers[i] = toOf(contourFinder.getCenter(i));
+    }
+}
+
+OpenNI::ContourWorker::ContourWorker()
+{
+    middle = 1;
+    back = 0;
+    front = 2;
+    pendingFrame = false;
+    pendingMaskChanged = false;
+    pendingMasked = false;
+    pendingTime = 0;
+    busyTime = 0;
+}
+
+OpenNI::ContourWorker::~ContourWorker()
+{
+    stop();
+}
+
+void OpenNI::ContourWorker::setup(int width, int height)
+{
+    stage.setup(width, height);
+}
+
+void OpenNI::ContourWorker::start()
+{
+    if (!isThreadRunning()) {
+        startThread(true, false);
+    }
+}
+
+void OpenNI::ContourWorker::stop()
+{
+    if (!isThreadRunning()) return;
+    stopThread();
+    {
+        std::lock_guard<std::mutex> pendingLock(pendingMutex);
+        pendingFrame = false;
+    }
+    pendingCondition.notify_all();
+    waitForThread(false);
+}
+
+void OpenNI::ContourWorker::submit(ofShortPixels &depth, ContourParameters &parameters)
+{
+    {
+        // a frame the worker has not picked up yet is replaced by the newer one
+        std::lock_guard<std::mutex> pendingLock(pendingMutex);
+        pendingDepth = depth;
+        pendingParameters = parameters;
+        pendingTime = ofGetElapsedTimeMicros();
+        pendingFrame = true;
+    }
+    pendingCondition.notify_all();
+}
+
+void OpenNI::ContourWorker::setMask(ofPixels &mask)
+{
+    std::lock_guard<std::mutex> pendingLock(pendingMutex);
+    pendingMask = mask;
+    pendingMasked = true;
+    pendingMaskChanged = true;
+}
+
+void OpenNI::ContourWorker::clearMask()
+{
+    std::lock_guard<std::mutex> pendingLock(pendingMutex);
+    pendingMasked = false;
+    pendingMaskChanged = true;
+}
+
+bool OpenNI::ContourWorker::read(ContourSnapshot *&snapshot)
+{
+    if ((middle.load() & OPENNI_CONTOUR_DIRTY) == 0) {
+        return false;
+    }
+    front = middle.exchange(front) & ~OPENNI_CONTOUR_DIRTY;
+    snapshot = &snapshots[front];
+    return true;
+}
+
+void OpenNI::ContourWorker::threadedFunction()
+{
+    ContourParameters parameters;
+    while (isThreadRunning())
+    {
+        {
+            std::unique_lock<std::mutex> pendingLock(pendingMutex);
+            pendingCondition.wait(pendingLock, [this] { return pendingFrame || !isThreadRunning(); });
+            if (!pendingFrame) {
+                continue;
+            }
+            if (pendingMaskChanged)
+            {
+                pendingMasked ? stage.setMask(pendingMask) : stage.clearMask();
+                pendingMaskChanged = false;
+            }
+            snapshots[back].depth = pendingDepth;
+            snapshots[back].frameTime = pendingTime;
+            parameters = pendingParameters;
+            pendingFrame = false;
+        }
+        
+        uint64_t t0 = ofGetElapsedTimeMicros();
+        stage.process(snapshots[back].depth, parameters, snapshots[back]);
+        back = middle.exchange(back | OPENNI_CONTOUR_DIRTY) & ~OPENNI_CONTOUR_DIRTY;
+        busyTime += ofGetElapsedTimeMicros() - t0;
+    }
+}
+
+
 OpenNI::OpenNI()
 {
     kinectWidth = 640;
     kinectHeight = 480;
     
-    grayImage.allocate(kinectWidth, kinectHeight);
-	grayThreshNear.allocate(kinectWidth, kinectHeight);
-	grayThreshFar.allocate(kinectWidth, kinectHeight);
+    contourStage.setup(kinectWidth, kinectHeight);
+    contourWorker.setup(kinectWidth, kinectHeight);
+    contours = &contourSnapshot;
     rgbImage.allocate(kinectWidth, kinectHeight);
     
     calibrating = false;
     trackingContours = false;
+    threadedContours = true;
     trackingUsers = false;
     depthMaskEnabled = false;
     
@@ -25,12 +186,21 @@ OpenNI::OpenNI()
     farThreshold = 0;
     smoothingRate = 1;
     numFrames = 1024;
+    historyBudget = numFrames * kinectWidth * kinectHeight * sizeof(unsigned short) / (DEPTHHISTORY_MEMORY_FRACTION * 1024 * 1024);
+    historyTolerance = 0;
 
     // user tracking
     numTrackedUsers = 0;
     maxUsers = 1;
     
-    depthHistory.resize(numFrames);
+    // contour statistics
+    contourLatency = 0;
+    contourWorkerLoad = 0;
+    lastStatisticsTime = 0;
+    lastBusyTime = 0;
+    
+    depthHistory.setMemoryBudget(historyBudget);
+    depthHistory.setTolerance(historyTolerance);
     
     panel.disableControlRow();
     panel.setName("OpenNI");
@@ -47,6 +217,9 @@ OpenNI::OpenNI()
     panelCalibration->addButton("load", this, &OpenNI::eventLoadCalibration);
 
     panelTracking = panel.addWidget("contour tracking");
+    panelTracking->addToggle("threaded", &threadedContours, this, &OpenNI::eventSetThreadedContours);
+    tContourLatency = panelTracking->addTextBox("latency (ms)", &contourLatencyS);
+    tContourWorkerLoad = panelTracking->addTextBox("worker load (%)", &contourWorkerLoadS);
     panelTracking->addToggle("setup mask", &depthMaskEnabled, this, &OpenNI::eventSetupMask);
     panelTracking->addSlider("farThreshold", &farThreshold, 0, 255);
     panelTracking->addSlider("nearThreshold", &nearThreshold, 0, 255);
@@ -58,9 +231,15 @@ OpenNI::OpenNI()
     panelTracking->addSlider("smoothingRate", &smoothingRate, 0, 100);
     panelTracking->addToggle("simplified", &simplified);
     panelTracking->addSlider("delay", &delay, 0, numFrames);
+    panelTracking->addSlider("history (MB)", &historyBudget, 8, 1024, this, &OpenNI::eventSetHistoryBudget);
+    panelTracking->addSlider("tolerance", &historyTolerance, 0, 20, this, &OpenNI::eventSetHistoryTolerance);
+    tHistoryDelay = panelTracking->addTextBox("delay applied", &historyDelayS);
+    tHistoryFrames = panelTracking->addTextBox("history frames", &historyFramesS);
+    tHistoryRatio = panelTracking->addTextBox("compression", &historyRatioS);
     
     panelUsers = panel.addWidget("track users");
     panelUsers->addSlider("max users", &maxUsers, 1, 10, this, &OpenNI::eventSetMaxUsers);
+    tFeatureTime = panelUsers->addTextBox("features (ms)", &featureTimeS);
     panelUsers->setCollapsible(true);
 
     toggleCalibrate->setActive(false);
@@ -86,6 +265,8 @@ void OpenNI::setup(string oni)
     kinect.setDepthColoring(COLORING_GREY);
     kinect.start();
     
+    depthHistory.setup(kinectWidth, kinectHeight, numFrames);
+    
     setTrackingUsers(false);
     setTrackingUserFeatures(false);
     setTrackingContours(false);
@@ -95,6 +276,8 @@ void OpenNI::setup(string oni)
 
 void OpenNI::stop()
 {
+    contourWorker.stop();
+    depthHistory.stop();
     kinect.stop();
 }
 
@@ -137,12 +320,25 @@ void OpenNI::setTrackingContours(bool trackingContours)
 {
     this->trackingContours = trackingContours;
     panelTracking->setActive(trackingContours);
+    setThreadedContours(threadedContours);
+}
+
+void OpenNI::setThreadedContours(bool threadedContours)
+{
+    this->threadedContours = threadedContours;
+    if (threadedContours && trackingContours) {
+        contourWorker.start();
+    }
+    else
+    {
+        contourWorker.stop();
+        contours = &contourSnapshot;
+    }
 }
 
 ofVec3f OpenNI::getWorldCoordinateAt(int x, int y)
 {
-    int idx = (idxHistory - 1 - delay + numFrames) % numFrames;
-    ofPoint depthPoint = ofPoint(x, y, depthHistory[idx][x + y * kinectWidth]);
+    ofPoint depthPoint = ofPoint(x, y, depthHistory.get(delay)[x + y * kinectWidth]);
     ofVec3f worldPoint = kinect.projectiveToWorld(depthPoint);
     return worldPoint;
 }
@@ -157,12 +353,14 @@ void OpenNI::getCalibratedContour(int idx, vector<ofVec2f> & calibratedPoints, i
     smoothness = max(smoothness, 1.0f);
     ofVec2f projectedPoint, mappedPoint;
     //vector<cv::Point> & points = contourFinder.getContour(idx);
-    ofPolyline &line = contourFinder.getPolyline(idx);
+    ofPolyline line = contours->polylines[idx];
     line.simplify(smoothness);
     vector<ofPoint> & vertices = line.getVertices();
+    ofShortPixels & depth = contours->depth;
     for (float j = 0; j < vertices.size(); j++)
     {
-        projectedPoint.set(kpt.getProjectedPoint(getWorldCoordinateAt(vertices[j].x, vertices[j].y)));
+        ofPoint depthPoint = ofPoint(vertices[j].x, vertices[j].y, depth[(int) vertices[j].x + (int) vertices[j].y * kinectWidth]);
+        projectedPoint.set(kpt.getProjectedPoint(kinect.projectiveToWorld(depthPoint)));
         mappedPoint.set(width * projectedPoint.x, height - height * projectedPoint.y);
         calibratedPoints.push_back(mappedPoint);
     }
@@ -172,11 +370,14 @@ bool OpenNI::update()
 {
     panel.update();
     
+    if (trackingContours && threadedContours && contourWorker.read(contours)) {
+        updateContourStatistics();
+    }
+    
     kinect.update();
     if (kinect.isNewFrame())
     {
-        depthHistory[idxHistory] = kinect.getDepthRawPixels();
-        idxHistory = (idxHistory + 1) % numFrames;
+        depthHistory.push(kinect.getDepthRawPixels());
         
         if (calibrating) {
             updateCalibration();
@@ -205,7 +406,7 @@ void OpenNI::updateUsers()
         ofxOpenNIUser * user = &kinect.getTrackedUser(i);
         if (user->isSkeleton() && users.count(user->getXnID()) == 0)
         {
-            OpenNIUser *newUser = new OpenNIUser(user);
+            OpenNIUser *newUser = new OpenNIUser(user, &features);
             newUser->setFeatureTrackingEnabled(trackingUserFeatures);
             users[user->getXnID()] = newUser;
         }
@@ -217,6 +418,12 @@ void OpenNI::updateUsers()
         }
     }
     
+    if (trackingUserFeatures)
+    {
+        features.update();
+        tFeatureTime->setValue(ofToString(features.getUpdateTime(), 3));
+    }
+    
     resetUserGenerator();
 }
 
@@ -235,31 +442,51 @@ void OpenNI::updateSkeletonFeatures()
 
 void OpenNI::updateContours()
 {
-    int idx = (idxHistory - 1 - delay + numFrames) % numFrames;
-    grayImage.setFromPixels(depthHistory[idx]);
-    
-    if (depthMaskEnabled)
+    ContourParameters parameters = getContourParameters();
+    if (threadedContours) {
+        contourWorker.submit(depthHistory.get(delay), parameters);
+    }
+    else
     {
-        cvMask.setFromPixels(maskImage.getPixels(), kinectWidth, kinectHeight);
-        cvInRangeS(cvMask.getCvImage(), cvScalarAll(250), cvScalarAll(255), cvGrayMask.getCvImage());
-        cvSet(grayImage.getCvImage(), cvScalarAll(0), cvGrayMask.getCvImage());
+        contourSnapshot.frameTime = ofGetElapsedTimeMicros();
+        contourSnapshot.depth = depthHistory.get(delay);
+        contourStage.process(contourSnapshot.depth, parameters, contourSnapshot);
+        contours = &contourSnapshot;
+        updateContourStatistics();
     }
-    
-    grayThreshNear = grayImage;
-    grayThreshFar = grayImage;
-    grayThreshNear.threshold(nearThreshold, true);
-    grayThreshFar.threshold(farThreshold);
-    cvAnd(grayThreshNear.getCvImage(), grayThreshFar.getCvImage(), grayImage.getCvImage(), NULL);
-    grayImage.flagImageChanged();
-    contourFinder.setMinArea(minArea);
-    contourFinder.setMaxArea(maxArea);
-    contourFinder.setThreshold(threshold);
-    contourFinder.setSimplify(simplified);
-    contourFinder.getTracker().setPersistence(persistence);
-    contourFinder.getTracker().setMaximumDistance(maxDistance);
-    contourFinder.getTracker().setSmoothingRate(smoothingRate);
-    contourFinder.findContours(grayImage);
-    numContours = contourFinder.size();
+}
+
+void OpenNI::updateContourStatistics()
+{
+    uint64_t now = ofGetElapsedTimeMicros();
+    contourLatency = 0.001 * (now - contours->frameTime);
+    tContourLatency->setValue(ofToString(contourLatency, 2));
+    if (now - lastStatisticsTime > 1000000)
+    {
+        uint64_t busyTime = contourWorker.getBusyTime();
+        contourWorkerLoad = 100.0 * (busyTime - lastBusyTime) / (now - lastStatisticsTime);
+        tContourWorkerLoad->setValue(ofToString(contourWorkerLoad, 1));
+        tHistoryDelay->setValue(ofToString(min(delay, depthHistory.getMaxDelay())));
+        tHistoryFrames->setValue(ofToString(depthHistory.getNumFrames()) + " / " + ofToString(depthHistory.getMemoryUsage() / (1024 * 1024)) + "MB, " + ofToString(depthHistory.getNumDropped()) + " dropped");
+        tHistoryRatio->setValue(ofToString(depthHistory.getCompressionRatio(), 1) + " at " + ofToString(depthHistory.getEncoderTolerance()));
+        lastBusyTime = busyTime;
+        lastStatisticsTime = now;
+    }
+}
+
+OpenNI::ContourParameters OpenNI::getContourParameters()
+{
+    ContourParameters parameters;
+    parameters.nearThreshold = nearThreshold;
+    parameters.farThreshold = farThreshold;
+    parameters.minArea = minArea;
+    parameters.maxArea = maxArea;
+    parameters.threshold = threshold;
+    parameters.persistence = persistence;
+    parameters.maxDistance = maxDistance;
+    parameters.smoothingRate = smoothingRate;
+    parameters.simplified = simplified;
+    return parameters;
 }
 
 void OpenNI::resetUserGenerator()
@@ -298,10 +525,12 @@ void OpenNI::drawDebug()
     
     if (trackingContours)
     {
-        grayImage.draw(0, 0);
+        threadedContours ? kinect.drawDepth() : contourStage.grayImage.draw(0, 0);
         ofSetColor(255, 0, 0);
         ofSetLineWidth(4);
-        contourFinder.draw();
+        for (int i = 0; i < contours->polylines.size(); i++) {
+            contours->polylines[i].draw();
+        }
         ofSetColor(255);
     }
     else {
@@ -343,6 +572,12 @@ void OpenNI::applyDepthMask()
     maskFBO.end();
     maskFBO.readToPixels(maskPixels);
     maskImage.setFromPixels(maskPixels);
+    
+    cvMask.setFromPixels(maskImage.getPixels(), kinectWidth, kinectHeight);
+    cvInRangeS(cvMask.getCvImage(), cvScalarAll(250), cvScalarAll(255), cvGrayMask.getCvImage());
+    cvGrayMask.flagImageChanged();
+    contourStage.setMask(cvGrayMask.getPixelsRef());
+    contourWorker.setMask(cvGrayMask.getPixelsRef());
 }
 
 void OpenNI::eventSetupMask(GuiButtonEventArgs & e)
@@ -373,6 +608,8 @@ void OpenNI::eventSetupMask(GuiButtonEventArgs & e)
         maskImage.allocate(0, 0, OF_IMAGE_COLOR);
         maskFBO.allocate(0, 0, GL_RGB);
         delete maskPad;
+        contourStage.clearMask();
+        contourWorker.clearMask();
     }
 }
 
@@ -396,6 +633,21 @@ void OpenNI::eventSetTrackingContours(GuiButtonEventArgs & b)
     setTrackingContours(trackingContours);
 }
 
+void OpenNI::eventSetThreadedContours(GuiButtonEventArgs & b)
+{
+    setThreadedContours(threadedContours);
+}
+
+void OpenNI::eventSetHistoryBudget(GuiSliderEventArgs<int> & e)
+{
+    depthHistory.setMemoryBudget(historyBudget);
+}
+
+void OpenNI::eventSetHistoryTolerance(GuiSliderEventArgs<int> & e)
+{
+    depthHistory.setTolerance(historyTolerance);
+}
+
 void OpenNI::eventSetTrackingUserFeatures(GuiButtonEventArgs & b)
 {
     setTrackingUserFeatures(trackingUserFeatures);
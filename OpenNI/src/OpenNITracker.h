@@ -10,6 +10,10 @@
 #include "OpenNIUser.h"
 #include "OpenNITracker.h"
 #include "CalibrationModule.h"
+#include "DepthHistory.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 using namespace ofxCv;
 using namespace cv;
@@ -18,6 +22,80 @@ using namespace cv;
 class OpenNI
 {
 public:
+    
+    // contours found in one depth frame, with the frame they came from
+    struct ContourSnapshot
+    {
+        vector<vector<cv::Point> > contours;
+        vector<ofPolyline> polylines;
+        vector<unsigned int> labels;
+        vector<ofPoint> centers;
+        ofShortPixels depth;
+        uint64_t frameTime;
+        ContourSnapshot() : frameTime(0) { }
+    };
+    
+    struct ContourParameters
+    {
+        int nearThreshold, farThreshold;
+        int minArea, maxArea;
+        int threshold, persistence, maxDistance, smoothingRate;
+        bool simplified;
+    };
+    
+    // mask, thresholds and contour finder for one depth frame
+    class ContourStage
+    {
+    public:
+        void setup(int width, int height);
+        void setMask(ofPixels &mask);
+        void clearMask() {masked = false;}
+        void process(ofShortPixels &depth, ContourParameters &parameters, ContourSnapshot &snapshot);
+        
+        ofxCvGrayscaleImage grayImage;
+        ofxCvGrayscaleImage grayThreshNear;
+        ofxCvGrayscaleImage grayThreshFar;
+        ofxCvGrayscaleImage grayMask;
+        ContourFinder contourFinder;
+        bool masked;
+    };
+    
+    // runs a ContourStage on the newest submitted frame. results are
+    // published through an atomic index over three snapshots, so the main
+    // thread picks up the latest one without waiting and keeps it until its
+    // next update.
+    class ContourWorker : public ofThread
+    {
+    public:
+        ContourWorker();
+        ~ContourWorker();
+        void setup(int width, int height);
+        void start();
+        void stop();
+        void submit(ofShortPixels &depth, ContourParameters &parameters);
+        void setMask(ofPixels &mask);
+        void clearMask();
+        bool read(ContourSnapshot *&snapshot);
+        uint64_t getBusyTime() {return busyTime.load();}
+        
+    protected:
+        void threadedFunction();
+        
+        ContourStage stage;
+        ContourSnapshot snapshots[3];
+        std::atomic<int> middle;
+        int back, front;
+        
+        ofShortPixels pendingDepth;
+        ContourParameters pendingParameters;
+        ofPixels pendingMask;
+        bool pendingFrame, pendingMaskChanged, pendingMasked;
+        uint64_t pendingTime;
+        std::mutex pendingMutex;
+        std::condition_variable pendingCondition;
+        std::atomic<uint64_t> busyTime;
+    };
+    
     OpenNI();
     ~OpenNI();
     
@@ -27,6 +105,8 @@ public:
     void setTrackingUsers(bool trackingUsers);
     void setTrackingUserFeatures(bool trackingUserFeatures);
     void setTrackingContours(bool trackingContours);
+    void setThreadedContours(bool threadedContours);
+    bool getThreadedContours() {return threadedContours;}
     
     ofxOpenNI & getKinect() {return kinect;}
     ofxKinectProjectorToolkit & getKinectProjectorToolkit() {return kpt;}
@@ -35,10 +115,15 @@ public:
     ofVec3f getWorldCoordinateAt(int x, int y);
     ofVec2f getProjectedPointAt(int x, int y);
     
-    int getNumContours() {return numContours;}
-    vector<cv::Point> & getContour(int idx) {return contourFinder.getContour(idx);}
+    // latest contours, valid until the next update
+    ContourSnapshot & getContours() {return *contours;}
+    DepthHistory & getDepthHistory() {return depthHistory;}
+    
+    int getNumContours() {return contours->contours.size();}
+    vector<cv::Point> & getContour(int idx) {return contours->contours[idx];}
     void getCalibratedContour(int idx, vector<ofVec2f> & calibratedPoints, int width, int height, float smoothness=1.0);
-    ContourFinder & getContourFinder() {return contourFinder;}
+    float getContourLatency() {return contourLatency;}
+    float getContourWorkerLoad() {return contourWorkerLoad;}
     
     map<int, OpenNIUser*> & getUsers() {return users;}
     int getNumTrackedUsers() {return numTrackedUsers;}
@@ -61,6 +146,8 @@ private:
     void updateUsers();
     void updateSkeletonFeatures();
     void updateContours();
+    void updateContourStatistics();
+    ContourParameters getContourParameters();
     void applyDepthMask();
     void clearUsers();
     void resetUserGenerator();
@@ -71,6 +158,9 @@ private:
     
     void eventSetTrackingUsers(GuiButtonEventArgs & e);
     void eventSetTrackingContours(GuiButtonEventArgs & e);
+    void eventSetThreadedContours(GuiButtonEventArgs & e);
+    void eventSetHistoryBudget(GuiSliderEventArgs<int> & e);
+    void eventSetHistoryTolerance(GuiSliderEventArgs<int> & e);
     void eventSetTrackingUserFeatures(GuiButtonEventArgs & e);
     void eventSetMaxUsers(GuiSliderEventArgs<int> & e);
     void eventToggleCalibrationModule(GuiButtonEventArgs & e);
@@ -92,23 +182,30 @@ private:
     int kinectWidth, kinectHeight;
     ofxOpenNI kinect;
     map<int, OpenNIUser*> users;
-    ContourFinder contourFinder;
+    OpenNIFeatures features;
     ofxKinectProjectorToolkit kpt;
     
     // mode parameters
     bool trackingUsers;
     bool trackingUserFeatures;
     bool trackingContours;
+    bool threadedContours;
     
     // tracking status
     int numTrackedUsers;
-    int numContours;
     bool hadUsers;
     
     // contour tracking
-    ofxCvGrayscaleImage grayImage;
-	ofxCvGrayscaleImage grayThreshNear;
-	ofxCvGrayscaleImage grayThreshFar;
+    ContourStage contourStage;
+    ContourWorker contourWorker;
+    ContourSnapshot contourSnapshot;
+    ContourSnapshot *contours;
+    float contourLatency;
+    float contourWorkerLoad;
+    uint64_t lastStatisticsTime;
+    uint64_t lastBusyTime;
+    string contourLatencyS, contourWorkerLoadS;
+    GuiTextBox *tContourLatency, *tContourWorkerLoad;
     int nearThreshold;
     int farThreshold;
     int minArea;
@@ -130,10 +227,14 @@ private:
     bool depthMaskEnabled;
     
     // user tracking
-    vector<ofShortPixels> depthHistory;
+    DepthHistory depthHistory;
     int numFrames;
-    int idxHistory;
+    int historyBudget;
+    int historyTolerance;
+    string historyDelayS, historyFramesS, historyRatioS;
+    GuiTextBox *tHistoryDelay, *tHistoryFrames, *tHistoryRatio;
     int maxUsers;
+    string featureTimeS;
     
     // gui
     GuiPanel panel;
@@ -141,6 +242,7 @@ private:
     GuiWidget *panelTracking;
     GuiWidget *panelUsers;
     GuiToggle *toggleCalibrate;
+    GuiTextBox *tFeatureTime;
     
     // calibration module
     CalibrationModule calibration;
@@ -27,9 +27,12 @@ float OpenNIUser::lpd2_hard_a[] = {1,-1.628286742,1.418759018,-0.6223424612,0.10
 float OpenNIUser::lpd2_hard_b[] = {-0.0738989849,0.1351624829,-0.0512998379,-0.0072918334,-0.0026718267};
 
 
-OpenNIUser::OpenNIUser(ofxOpenNIUser * user)
+OpenNIUser::OpenNIUser(ofxOpenNIUser * user, OpenNIFeatures * features)
 {
     this->user = user;
+    this->features = features;
+    slot = -1;
+    trackingEnabled = false;
     setFilterLevel(SOFT);
     setFeatureTrackingEnabled(false);
     setDepth(30);
@@ -43,8 +46,19 @@ OpenNIUser::~OpenNIUser()
 void OpenNIUser::setFeatureTrackingEnabled(bool trackingEnabled)
 {
     this->trackingEnabled = trackingEnabled;
-    if (!trackingEnabled) {
+    if (trackingEnabled && slot == -1)
+    {
+        slot = features->addUser(this);
+        setFilterLevel(filterLevel);
+    }
+    else if (!trackingEnabled)
+    {
+        if (slot != -1) {
+            features->removeUser(slot);
+        }
+        slot = -1;
         elements_.clear();
+        meanVels_.clear();
     }
 }
 
@@ -79,103 +93,65 @@ void OpenNIUser::setFilterLevel(FilterLevel filterLevel)
         default:
             break;
     }
+    if (slot != -1) {
+        features->setFilter(slot, aFilter, bFilter, aLpd1, bLpd1, aLpd2, bLpd2);
+    }
 }
 
 void OpenNIUser::update()
 {
     if (trackingEnabled) {
-        updateFeatures();
+        features->setJoints(slot, user);
     }
 }
 
 void OpenNIUser::updateFeatures()
 {
-    if (user->getJoint(JOINT_TORSO).getWorldPosition() == ofPoint(0,0,0))   return;
-
+    int numJoints = features->getNumJoints(slot);
     if (elements_.empty())
     {
-        for (int j = 0; j < user->getNumJoints(); j++) {
+        for (int j = 0; j < numJoints; j++) {
             MocapElement newElement(j, depth_);
             elements_.push_back(newElement);
         }
     }
     
-    ofPoint headPos = user->getJoint(JOINT_HEAD).getWorldPosition();
-    ofPoint torsoPos = user->getJoint(JOINT_TORSO).getWorldPosition();
+    const float *position = features->getPosition(slot);
+    const float *positionFiltered = features->getPositionFiltered(slot);
+    const float *velocity = features->getVelocity(slot);
+    const float *velocityMagnitude = features->getVelocityMagnitude(slot);
+    const float *acceleration = features->getAcceleration(slot);
+    const float *accelerationMagnitude = features->getAccelerationMagnitude(slot);
+    const float *accelerationTrajectory = features->getAccelerationTrajectory(slot);
+    const float *distanceToTorso = features->getDistanceToTorso(slot);
+    const float *relativePositionToTorso = features->getRelativePositionToTorso(slot);
     
-    //for CI
-    float xMax = numeric_limits<float>::min();
-    float yMax = numeric_limits<float>::min();
-    float zMax = numeric_limits<float>::min();
-    float xMin = numeric_limits<float>::max();
-    float yMin = numeric_limits<float>::max();
-    float zMin = numeric_limits<float>::max();
-    
-    float headTorsoDist = headPos.distance(torsoPos);
-    float meanVel = 0.0; //for qom
-
-    for (int j = 0; j < user->getNumJoints(); j++)
+    for (int j = 0; j < elements_.size(); j++)
     {
-        computeJointDescriptors(j, user->getJoint((Joint) j).getWorldPosition(), headTorsoDist);
-        
-        //qom
-        meanVel += getVelocityMagnitude(j);
-        
-        //ci
-        xMin = min(xMin, getPositionFiltered(j).x);
-        yMin = min(yMin, getPositionFiltered(j).y);
-        zMin = min(zMin, getPositionFiltered(j).z);
-        xMax = max(xMax, getPositionFiltered(j).x);
-        yMax = max(yMax, getPositionFiltered(j).y);
-        zMax = max(zMax, getPositionFiltered(j).z);
+        MocapElement &element = elements_[j];
+        element.setPosition(OpenNIFeatures::getPoint(position, j));
+        element.setPositionFiltered(OpenNIFeatures::getPoint(positionFiltered, j));
+        element.setVelocity(OpenNIFeatures::getPoint(velocity, j));
+        element.setVelocityMagnitude(velocityMagnitude[j]);
+        element.setAcceleration(OpenNIFeatures::getPoint(acceleration, j));
+        element.setAccelerationMagnitude(accelerationMagnitude[j]);
+        element.setAccelerationTrajectory(accelerationTrajectory[j]);
+        element.setDistanceToTorso(distanceToTorso[j]);
+        element.setRelativePositionToTorso(OpenNIFeatures::getPoint(relativePositionToTorso, j));
     }
     
     // Add position to history
     if (meanVels_.size() <= depth_) {
-        meanVels_.insert(meanVels_.begin(), meanVel / user->getNumJoints());
+        meanVels_.insert(meanVels_.begin(), features->getMeanVelocity(slot));
     }
     if (meanVels_.size() > depth_) {
         meanVels_.pop_back();
     }
     
     qom_ = accumulate(meanVels_.begin(), meanVels_.end(), 0.0) / (meanVels_.size());
-    ci_ = ( -4.0 + (( abs(xMax-xMin) + abs(yMax-yMin) + abs(zMax-zMin) ) / headTorsoDist) ) / 6.0;
-    symmetry_ = 1.0 - (0.5 * (abs(sqrt(getDistanceToTorso(JOINT_RIGHT_HAND))-sqrt(getDistanceToTorso(JOINT_LEFT_HAND))) + abs(sqrt(getDistanceToTorso(JOINT_RIGHT_ELBOW))-sqrt(getDistanceToTorso(JOINT_LEFT_ELBOW)))) / headTorsoDist);
-    yMaxHands_ = max(getRelativePositionToTorso(JOINT_RIGHT_HAND).y, getRelativePositionToTorso(JOINT_LEFT_HAND).y);
-}
-
-void OpenNIUser::computeJointDescriptors(int jointId, ofPoint jointPos, const float &headTorsoDist)
-{
-    MocapElement* mocapElement = getElement(jointId);
-    
-    //Position
-    mocapElement->setPosition(jointPos);
-    
-    //Filtered position
-    mocapElement->setPositionFiltered(applyFilter(mocapElement->getPosition(), mocapElement->getPositionFiltered(), aFilter, bFilter));
-    
-    //Velocity
-    mocapElement->setVelocity(applyFilter(mocapElement->getPosition(), mocapElement->getVelocity(), aLpd1, bLpd1));
-    mocapElement->setVelocityMagnitude(mocapElement->getVelocity()[0].length());
-    
-    //Acceleration
-    mocapElement->setAcceleration(applyFilter(mocapElement->getPosition(), mocapElement->getAcceleration(), aLpd2, bLpd2));
-    mocapElement->setAccelerationMagnitude(mocapElement->getAcceleration()[0].length());
-    
-    //Acceleration along trajectory
-    ofPoint acc = mocapElement->getAcceleration()[0];
-    ofPoint vel = mocapElement->getVelocity()[0];
-    mocapElement->setAccelerationTrajectory(acc.dot(vel) / vel.length());
-    
-    //Distance to torso
-    mocapElement->setDistanceToTorso(getPositionFiltered(jointId).distanceSquared(getPositionFiltered(JOINT_TORSO)));
-    
-    //Relative position to torso
-    ofPoint relPosToTorso;
-    relPosToTorso.x = (jointPos.x - getPositionFiltered(JOINT_TORSO).x) / (headTorsoDist * 1.8);
-    relPosToTorso.y = (jointPos.y - getPositionFiltered(JOINT_TORSO).y) / (headTorsoDist * 1.8);
-    relPosToTorso.z = -((jointPos.z - getPositionFiltered(JOINT_TORSO).z) / headTorsoDist) / 1.4;
-    mocapElement->setRelativePositionToTorso(relPosToTorso);
+    ci_ = features->getCI(slot);
+    symmetry_ = features->getSymmetry(slot);
+    yMaxHands_ = features->getYMaxHands(slot);
     
     //TODO: auto hand
     //beatTracker.update(getAccTrVector(JOINT_RIGHT_HAND), get3DFiltPosVector(JOINT_RIGHT_HAND)[coord::Y]);
@@ -183,19 +159,13 @@ void OpenNIUser::computeJointDescriptors(int jointId, ofPoint jointPos, const fl
 
 MocapElement* OpenNIUser::getElement(int _id)
 {
-    vector<MocapElement>::iterator it = find_if(elements_.begin(), elements_.end(), MatchId(_id));
-    if (it != elements_.end()){
-        return &(*it);
+    if (_id >= 0 && _id < elements_.size()) {
+        return &elements_[_id];
     } else {
-        return false;
+        return NULL;
     }
 }
 
-ofPoint OpenNIUser::applyFilter(vector<ofPoint> x, vector<ofPoint> y, float *a, float *b)
-{
-    return b[0]*x[0] + b[1]*x[1] + b[2]*x[2] + b[3]*x[3] + b[4]*x[4] - (a[1]*y[0] + a[2]*y[1] + a[3]*y[2] + a[4]*y[3]);
-}
-
 template <typename T> vector<T> OpenNIUser::createVector(T element)
 {
     vector<T> v (depth_);
@@ -218,7 +188,7 @@ ofPoint OpenNIUser::getPosition(int j)
 vector<ofPoint> OpenNIUser::getPositionHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getPosition();
+        return getElement(j)->getPosition().toVector();
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -229,9 +199,7 @@ vector<ofPoint> OpenNIUser::getPositionHistory(int j, int frames)
 {
     if (getElement(j))
     {
-        vector<ofPoint> fullHistory = getElement(j)->getPosition();
-        vector<ofPoint> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getPosition().toVector(frames);
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -251,7 +219,7 @@ ofPoint OpenNIUser::getPositionFiltered(int j)
 vector<ofPoint> OpenNIUser::getPositionFilteredHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getPositionFiltered();
+        return getElement(j)->getPositionFiltered().toVector();
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -261,9 +229,7 @@ vector<ofPoint> OpenNIUser::getPositionFilteredHistory(int j)
 vector<ofPoint> OpenNIUser::getPositionFilteredHistory(int j, int frames)
 {
     if (getElement(j)) {
-        vector<ofPoint> fullHistory = getElement(j)->getPositionFiltered();
-        vector<ofPoint> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getPositionFiltered().toVector(frames);
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -283,7 +249,7 @@ ofPoint OpenNIUser::getVelocity(int j)
 vector<ofPoint> OpenNIUser::getVelocityHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getVelocity();
+        return getElement(j)->getVelocity().toVector();
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -294,9 +260,7 @@ vector<ofPoint> OpenNIUser::getVelocityHistory(int j, int frames)
 {
     if (getElement(j))
     {
-        vector<ofPoint> fullHistory = getElement(j)->getVelocity();
-        vector<ofPoint> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getVelocity().toVector(frames);
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -316,7 +280,7 @@ float OpenNIUser::getVelocityMagnitude(int j)
 float & OpenNIUser::getVelocityMagnitudeRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getVelocityMagnitudeRef()[0];
+        return getElement(j)->getVelocityMagnitudeRef();
     }
 }
 
@@ -343,7 +307,7 @@ float OpenNIUser::getVelocityMean(int j, int frames)
 float & OpenNIUser::getVelocityMeanRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getVelocityMeanRef()[0];
+        return getElement(j)->getVelocityMeanRef();
     }
 }
 
@@ -361,7 +325,7 @@ ofPoint OpenNIUser::getAcceleration(int j)
 vector<ofPoint> OpenNIUser::getAccelerationHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getAcceleration();
+        return getElement(j)->getAcceleration().toVector();
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -371,9 +335,7 @@ vector<ofPoint> OpenNIUser::getAccelerationHistory(int j)
 vector<ofPoint> OpenNIUser::getAccelerationHistory(int j, int frames)
 {
     if (getElement(j)) {
-        vector<ofPoint> fullHistory = getElement(j)->getAcceleration();
-        vector<ofPoint> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getAcceleration().toVector(frames);
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -393,7 +355,7 @@ float OpenNIUser::getAccelerationMagnitude(int j)
 float & OpenNIUser::getAccelerationMagnitudeRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getAccelerationMagnitudeRef()[0];
+        return getElement(j)->getAccelerationMagnitudeRef();
     }
 }
 
@@ -419,7 +381,7 @@ float OpenNIUser::getAccelerationMean(int j, int frames)
 float & OpenNIUser::getAccelerationMeanRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getAccelerationMeanRef()[0];
+        return getElement(j)->getAccelerationMeanRef();
     }
 }
 
@@ -436,7 +398,7 @@ float OpenNIUser::getAccelerationTrajectory(int j)
 vector<float> OpenNIUser::getAccelerationTrajectoryHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getAccelerationTrajectory();
+        return getElement(j)->getAccelerationTrajectory().toVector();
     }
     else {
         return createVector(0.0f);
@@ -447,9 +409,7 @@ vector<float> OpenNIUser::getAccelerationTrajectoryHistory(int j, int frames)
 {
     if (getElement(j))
     {
-        vector<float> fullHistory = getElement(j)->getAccelerationTrajectory();
-        vector<float> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getAccelerationTrajectory().toVector(frames);
     }
     else {
         return createVector(0.0f);
@@ -489,7 +449,7 @@ float OpenNIUser::getDistanceToTorso(int j)
 vector<float> OpenNIUser::getDistanceToTorsoHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getDistanceToTorso();
+        return getElement(j)->getDistanceToTorso().toVector();
     }
     else {
         return createVector(0.0f);
@@ -500,9 +460,7 @@ vector<float> OpenNIUser::getDistanceToTorsoHistory(int j, int frames)
 {
     if (getElement(j))
     {
-        vector<float> fullHistory = getElement(j)->getDistanceToTorso();
-        vector<float> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getDistanceToTorso().toVector(frames);
     }
     else {
         return createVector(0.0f);
@@ -522,7 +480,7 @@ ofPoint OpenNIUser::getRelativePositionToTorso(int j)
 vector<ofPoint> OpenNIUser::getRelativePositionToTorsoHistory(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getRelativePositionToTorso();
+        return getElement(j)->getRelativePositionToTorso().toVector();
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -533,9 +491,7 @@ vector<ofPoint> OpenNIUser::getRelativePositionToTorsoHistory(int j, int frames)
 {
     if (getElement(j))
     {
-        vector<ofPoint> fullHistory = getElement(j)->getRelativePositionToTorso();
-        vector<ofPoint> history(fullHistory.begin(), fullHistory.begin() + frames);
-        return history;
+        return getElement(j)->getRelativePositionToTorso().toVector(frames);
     }
     else {
         return createVector(ofPoint(0.0,0.0,0.0));
@@ -567,49 +523,49 @@ float OpenNIUser::getYMaxHands()
 ofPoint & OpenNIUser::getPositionRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getPositionRef()[0];
+        return getElement(j)->getPositionRef();
     }
 }
 
 ofPoint & OpenNIUser::getPositionFilteredRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getPositionFilteredRef()[0];
+        return getElement(j)->getPositionFilteredRef();
     }
 }
 
 ofPoint & OpenNIUser::getVelocityRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getVelocityRef()[0];
+        return getElement(j)->getVelocityRef();
     }
 }
 
 ofPoint & OpenNIUser::getAccelerationRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getAccelerationRef()[0];
+        return getElement(j)->getAccelerationRef();
     }
 }
 
 float & OpenNIUser::getAccelerationTrajectoryRef(int j)
 {
     if (getElement(j)){
-        return getElement(j)->getAccelerationTrajectoryRef()[0];
+        return getElement(j)->getAccelerationTrajectoryRef();
     }
 }
 
 float & OpenNIUser::getDistanceToTorsoRef(int j)
 {
     if (getElement(j)){
-        return getElement(j)->getDistanceToTorsoRef()[0];
+        return getElement(j)->getDistanceToTorsoRef();
     }
 }
 
 ofPoint & OpenNIUser::getRelativePositionToTorsoRef(int j)
 {
     if (getElement(j)) {
-        return getElement(j)->getRelativePositionToTorsoRef()[0];
+        return getElement(j)->getRelativePositionToTorsoRef();
     }
 }
 
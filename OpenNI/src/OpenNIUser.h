@@ -7,6 +7,7 @@
 
 #include "ofMain.h"
 #include "MocapElement.h"
+#include "OpenNIFeatures.h"
 #include "ofxOpenNI.h"
 
 
@@ -17,7 +18,7 @@ public:
     static float lpf_soft_a[], lpf_soft_b[], lpf_med_a[], lpf_med_b[], lpf_hard_a[], lpf_hard_b[], lpd1_soft_a[], lpd1_soft_b[], lpd1_med_a[], lpd1_med_b[], lpd1_hard_a[], lpd1_hard_b[], lpd2_soft_a[], lpd2_soft_b[], lpd2_med_a[], lpd2_med_b[], lpd2_hard_a[], lpd2_hard_b[];
     enum FilterLevel {SOFT, MEDIUM, HARD };
 
-    OpenNIUser(ofxOpenNIUser * user);
+    OpenNIUser(ofxOpenNIUser * user, OpenNIFeatures * features);
     ~OpenNIUser();
     
     void setFeatureTrackingEnabled(bool trackingEnabled);
@@ -32,7 +33,7 @@ public:
     void setDepth(int depth) {depth_ = depth;}
     int getDepth() {return depth_;}
 
-    //bool isNewDataAvailable();
+    // stage the current skeleton, features are computed by OpenNIFeatures::update
     void update();
     
     // Getters
@@ -97,16 +98,18 @@ public:
 
 private:
 
+    friend class OpenNIFeatures;
+
     void updateFeatures();
     MocapElement* getElement(int _id);
-    void computeJointDescriptors(int jointId, ofPoint jointPos, const float &headTorsoDist);
-    ofPoint applyFilter (vector<ofPoint> x, vector<ofPoint> y, float *a, float *b);
     
     template <typename T> vector<T> createVector (T element);
     
     // user
     ofxOpenNIUser *user;
     bool trackingEnabled;
+    OpenNIFeatures *features;
+    int slot;
 
     // filter
     FilterLevel filterLevel;
@@ -117,18 +120,5 @@ private:
     vector<float> meanVels_;
     vector<MocapElement> elements_;
     int depth_;
-    
-    //Functor to look for mocap elements matching a Joint
-    struct MatchId
-    {
-        MatchId(const int& j) : j_(j) {}
-        bool operator()(MocapElement& obj) const
-        {
-            return obj.getElementId() == j_;
-        }
-        
-    private:
-        const int& j_;
-    };
 };
 
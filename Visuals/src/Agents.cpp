@@ -20,7 +20,7 @@ void Agents::setup(int width, int height, bool clearControls)
     drawLines = false;
     drawTriangles = true;
 
-    control.addSlider("numAgents and some other stuff", &numAgents, 1, 360);
+    control.addSlider("numAgents and some other stuff", &numAgents, 1, 10000);
     control.addSlider("speed", &speed, -5.0f, 5.0f);
     control.addSlider("size and some other stuff", &size, 30, 800);
     control.addColor("colorLines", &color1);
@@ -56,18 +56,127 @@ void Agents::update()
             agents[i].wrap();
         }
     }
+    updateGrid();
+    updateNeighbours();
+}
+
+void Agents::updateGrid()
+{
+    // two agents can only intersect within 2 * size of each other, so
+    // candidates are found in the 3x3 cells around an agent. with wrapping
+    // the grid spans the canvas, otherwise the bounds of the agents.
+    ofVec2f minPos(0, 0), maxPos(width, height);
+    if (!wrapping)
+    {
+        for (int i=0; i<agents.size(); i++)
+        {
+            minPos.set(min(minPos.x, agents[i].pos.x), min(minPos.y, agents[i].pos.y));
+            maxPos.set(max(maxPos.x, agents[i].pos.x), max(maxPos.y, agents[i].pos.y));
+        }
+    }
+    
+    // keep the number of cells in proportion to the number of agents
+    cellSize = max(2.0f * size, 1.0f);
+    float area = (maxPos.x - minPos.x) * (maxPos.y - minPos.y);
+    float maxCells = 4.0f * agents.size() + 16;
+    if (area / (cellSize * cellSize) > maxCells) {
+        cellSize = sqrt(area / maxCells);
+    }
+    gridOrigin = minPos;
+    gridWidth = (int) ((maxPos.x - minPos.x) / cellSize) + 1;
+    gridHeight = (int) ((maxPos.y - minPos.y) / cellSize) + 1;
+    
+    cellStart.assign(gridWidth * gridHeight + 1, 0);
+    agentCells.resize(agents.size());
     for (int i=0; i<agents.size(); i++)
     {
-        for (int j=i+1; j<agents.size(); j++)
+        int cx = ofClamp((int) ((agents[i].pos.x - gridOrigin.x) / cellSize), 0, gridWidth - 1);
+        int cy = ofClamp((int) ((agents[i].pos.y - gridOrigin.y) / cellSize), 0, gridHeight - 1);
+        agentCells[i] = cx + cy * gridWidth;
+        cellStart[agentCells[i]]++;
+    }
+    
+    // running sums give the end of each cell, filling backwards moves them
+    // to the start, so cell c ends up at [cellStart[c], cellStart[c+1])
+    for (int c=1; c<=gridWidth * gridHeight; c++) {
+        cellStart[c] += cellStart[c - 1];
+    }
+    cellAgents.resize(agents.size());
+    for (int i=agents.size()-1; i>=0; i--) {
+        cellAgents[--cellStart[agentCells[i]]] = i;
+    }
+}
+
+void Agents::updateNeighbours()
+{
+    // positions are copied in cell order so candidates are read
+    // contiguously. each cell is tested against itself and the four cells
+    // after it, so every pair is visited once.
+    cellX.resize(agents.size());
+    cellY.resize(agents.size());
+    cellRad.resize(agents.size());
+    for (int k=0; k<cellAgents.size(); k++)
+    {
+        Agent &agent = agents[cellAgents[k]];
+        cellX[k] = agent.pos.x;
+        cellY[k] = agent.pos.y;
+        cellRad[k] = agent.rad;
+    }
+    
+    const int dx[4] = {1, -1, 0, 1};
+    const int dy[4] = {0, 1, 1, 1};
+    pairs.clear();
+    for (int cy=0; cy<gridHeight; cy++)
+    {
+        for (int cx=0; cx<gridWidth; cx++)
         {
-            bool intersecting = agents[i].isIntersecting(agents[j]);
-            if (intersecting)
+            int c = cx + cy * gridWidth;
+            for (int k=cellStart[c]; k<cellStart[c+1]; k++)
             {
-                agents[i].addIntersectingAgent(&agents[j]);
-                agents[j].addIntersectingAgent(&agents[i]);
+                findIntersecting(k, k+1, cellStart[c+1]);
+                for (int d=0; d<4; d++)
+                {
+                    int x = cx + dx[d], y = cy + dy[d];
+                    if (x >= 0 && x < gridWidth && y < gridHeight) {
+                        findIntersecting(k, cellStart[x + y * gridWidth], cellStart[x + y * gridWidth + 1]);
+                    }
+                }
             }
         }
     }
+    
+    neighbourStart.assign(agents.size() + 1, 0);
+    for (int p=0; p<pairs.size(); p++)
+    {
+        neighbourStart[pairs[p].first]++;
+        neighbourStart[pairs[p].second]++;
+    }
+    for (int i=1; i<=agents.size(); i++) {
+        neighbourStart[i] += neighbourStart[i - 1];
+    }
+    neighbours.resize(2 * pairs.size());
+    for (int p=pairs.size()-1; p>=0; p--)
+    {
+        neighbours[--neighbourStart[pairs[p].first]] = pairs[p].second;
+        neighbours[--neighbourStart[pairs[p].second]] = pairs[p].first;
+    }
+    for (int i=0; i<agents.size(); i++) {
+        sort(neighbours.begin() + neighbourStart[i], neighbours.begin() + neighbourStart[i+1]);
+    }
+}
+
+void Agents::findIntersecting(int k, int begin, int end)
+{
+    // same test as Agent::isIntersecting
+    for (int m=begin; m<end; m++)
+    {
+        float dx = cellX[k] - cellX[m];
+        float dy = cellY[k] - cellY[m];
+        float r = cellRad[k] + cellRad[m];
+        if (dx*dx + dy*dy < r*r) {
+            pairs.push_back(make_pair(cellAgents[k], cellAgents[m]));
+        }
+    }
 }
 
 void Agents::refresh()
@@ -94,8 +203,10 @@ void Agents::draw(int x, int y)
 {
     Scene::beginDraw(x, y);
     
-    if (debug) {
+    if (debug)
+    {
         drawDebug();
+        Scene::endDraw();
         return;
     }
     
@@ -104,9 +215,9 @@ void Agents::draw(int x, int y)
     {
         for (int i=0; i<agents.size(); i++)
         {
-            for (int j=0; j<agents[i].getIntersecting().size(); j++)
+            for (int j=0; j<getNumNeighbours(i); j++)
             {
-                Agent *a = agents[i].getIntersecting()[j];
+                Agent *a = &getNeighbour(i, j);
                 float t = (float) ((ofGetFrameNum() + a->tOffset) % cycle) / cycle;
                 if (t < density)
                 {
@@ -123,10 +234,10 @@ void Agents::draw(int x, int y)
     {
         for (int i=0; i<agents.size(); i++)
         {
-            if (agents[i].getIntersecting().size() == 2)
+            if (getNumNeighbours(i) == 2)
             {
-                Agent *a1 = agents[i].getIntersecting()[0];
-                Agent *a2 = agents[i].getIntersecting()[1];
+                Agent *a1 = &getNeighbour(i, 0);
+                Agent *a2 = &getNeighbour(i, 1);
                 float t = (float) ((ofGetFrameNum() + a1->tOffset + a2->tOffset) % cycle) / cycle;
                 if (t < density)
                 {
@@ -173,7 +284,6 @@ void Agent::setSize(float size)
 
 void Agent::update()
 {
-    intersecting.clear();
     rad = baseRad * size;
     pos += (speed * vel);
 }
@@ -189,16 +299,6 @@ bool Agent::isIntersecting(Agent &other)
     return isIntersecting;
 }
 
-vector<Agent *> Agent::getIntersecting()
-{
-    return intersecting;
-}
-
-void Agent::addIntersectingAgent(Agent *other)
-{
-    intersecting.push_back(other);
-}
-
 void Agent::wrap()
 {
     if      (pos.x < 0)             pos.set(width, pos.y);
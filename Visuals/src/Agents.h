@@ -16,15 +16,12 @@ public:
     void update();
     void wrap();
     void draw();
-    void addIntersectingAgent(Agent *other);
     bool isIntersecting(Agent &other);
-    vector<Agent *> getIntersecting();
 
     float rad, baseRad, speed, size;
     int tOffset;
     ofVec2f pos, vel;
     int width, height;
-    vector<Agent *> intersecting;
 };
 
 
@@ -46,9 +43,28 @@ protected:
     void addNewAgent();
     void refresh();
     void drawDebug();
+    void updateGrid();
+    void updateNeighbours();
+    void findIntersecting(int k, int begin, int end);
+    int getNumNeighbours(int i) {return neighbourStart[i+1] - neighbourStart[i];}
+    Agent & getNeighbour(int i, int n) {return agents[neighbours[neighbourStart[i] + n]];}
 
     vector<Agent> agents;
     
+    // uniform grid, agents sorted by cell (counting sort, rebuilt per frame)
+    float cellSize;
+    ofVec2f gridOrigin;
+    int gridWidth, gridHeight;
+    vector<int> cellStart;
+    vector<int> cellAgents;
+    vector<int> agentCells;
+    vector<float> cellX, cellY, cellRad;
+    
+    // neighbours of agent i are neighbours[neighbourStart[i] .. neighbourStart[i+1]]
+    vector<int> neighbours;
+    vector<int> neighbourStart;
+    vector<pair<int, int> > pairs;
+    
     int numAgents;
     bool wrapping;
     bool debug;
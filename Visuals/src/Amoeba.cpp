@@ -46,6 +46,8 @@ void Amoeba::setup(int width, int height, bool clearControls)
 void Amoeba::update()
 {
     time += speed;
+    radii.resize(numVertices);
+    Noise::noiseLine(numVertices, ofVec3f(offset, noiseRegion, time), ofVec3f(noiseFactor, 0, 0), &radii[0]);
 }
 
 void Amoeba::draw(int x, int y)
@@ -81,12 +83,11 @@ void Amoeba::draw(int x, int y)
 void Amoeba::drawAmoeba()
 {
     ofBeginShape();
-    float ang, rad0, rad, x, y;
-    for (int i=0; i<numVertices; i++)
+    float ang, rad, x, y;
+    for (int i=0; i<radii.size(); i++)
     {
-        ang = ofMap(i, 0, numVertices, 0, TWO_PI);
-        rad0 = ofNoise(offset + noiseFactor * i, noiseRegion, time);
-        rad = ofMap(rad0, 0, 1, radRange.x, radRange.y);
+        ang = ofMap(i, 0, radii.size(), 0, TWO_PI);
+        rad = ofMap(radii[i], 0, 1, radRange.x, radRange.y);
         x = center.x + rad * cos(ang);
         y = center.y + rad * sin(ang);
         if (curvedVertices) ofCurveVertex(x, y);
@@ -2,6 +2,7 @@
 
 #include "ofMain.h"
 #include "Scene.h"
+#include "Noise.h"
 
 
 class Amoeba : public Scene
@@ -16,6 +17,7 @@ private:
     
     void drawAmoeba();
     
+    vector<float> radii;
     float time;
     int numVertices;
     ofVec2f radRange;
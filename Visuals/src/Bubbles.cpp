@@ -1,57 +1,12 @@
 #include "Bubbles.h"
 
 
-void Bubbles::BubbleCreator::setup(vector<TimeFunction<ofVec2f> *> &position,
-           vector<ofVec3f> &colorMargin,
-           vector<float> &blurLevel,
-           vector<float> &alpha,
-           vector<float> &size,
-           int &numBubbles,
-           int width, int height) {
-    this->position = &position;
-    this->colorMargin = &colorMargin;
-    this->blurLevel = &blurLevel;
-    this->alpha = &alpha;
-    this->size = &size;
-    this->numBubbles = &numBubbles;
-    this->width = width;
-    this->height = height;
-}
-
-void Bubbles::BubbleCreator::setRunning(bool b)
-{
-    if (b != isThreadRunning()) {
-        isThreadRunning() ? stopThread() : startThread();
-    }
-}
-
-void Bubbles::BubbleCreator::threadedFunction()
-{
-    while(isThreadRunning())
-    {
-        if(lock())
-        {
-            while (position->size() < *numBubbles)
-            {
-                TimeFunction<ofVec2f> *newPosition = new TimeFunction<ofVec2f>(false);
-                newPosition->setConstant(ofVec2f(ofRandom(width), ofRandom(height)));
-                position->push_back(newPosition);
-                blurLevel->push_back(ofRandom(1));
-                alpha->push_back(0);
-                size->push_back(0);
-                colorMargin->push_back(ofVec3f(ofRandom(-1,1), ofRandom(-1,1), ofRandom(-1,1)));
-            }
-            unlock();
-        }
-    }
-}
-
 void Bubbles::setup(int width, int height, bool clearControls)
 {
     Scene::setup(width, height, clearControls);
 
     control.addSlider("speed", &speed, 0.0f, 0.1f);
-    control.addSlider("numBubbles", &numBubbles, 1, 2048);
+    control.addSlider("numBubbles", &numBubbles, 1, BUBBLES_MAX_BUBBLES);
     control.addSlider("maxSizeInitial", &maxSizeInitial, 100, 1000, this, &Bubbles::fboParametersChanged);
     control.addSlider("maxSize", &maxSize, 10, 800);
     control.addColor("baseColor", &baseColor);
@@ -81,14 +36,27 @@ void Bubbles::setup(int width, int height, bool clearControls)
     setupBubblesFbo();
     time = 0;
     
-    bubbleCreator.setup(position, colorMargin, blurLevel, alpha, size, numBubbles, width, height);
+    // the bank keeps its capacity when shrunk, so spawning never reallocates
+    numLive = 0;
+    position.resize(BUBBLES_MAX_BUBBLES);
+    position.resize(0);
+    colorMargin.resize(BUBBLES_MAX_BUBBLES);
+    blurLevel.resize(BUBBLES_MAX_BUBBLES);
+    alpha.resize(BUBBLES_MAX_BUBBLES);
+    size.resize(BUBBLES_MAX_BUBBLES);
+    timeNoise.resize(2 * BUBBLES_MAX_BUBBLES);
+    Noise::noiseLine(BUBBLES_MAX_BUBBLES, ofVec2f(0, 10), ofVec2f(1, 0), &timeNoise[0]);
+    Noise::noiseLine(BUBBLES_MAX_BUBBLES, ofVec2f(0, 20), ofVec2f(1, 0), &timeNoise[BUBBLES_MAX_BUBBLES]);
 }
 
-Bubbles::~Bubbles()
+void Bubbles::spawnBubble(int i)
 {
-    for (int i=0; i<position.size(); i++) {
-        delete position[i];
-    }
+    position.resize(i + 1);
+    position.set(TIMEFUNCTION_CONSTANT, i, ofVec2f(ofRandom(width), ofRandom(height)));
+    blurLevel[i] = ofRandom(1);
+    alpha[i] = 0;
+    size[i] = 0;
+    colorMargin[i] = ofVec3f(ofRandom(-1,1), ofRandom(-1,1), ofRandom(-1,1));
 }
 
 void Bubbles::fboParametersChanged(GuiSliderEventArgs<int> &e)
@@ -119,39 +87,41 @@ void Bubbles::setupBubblesFbo()
 
 void Bubbles::update()
 {
-    bubbleCreator.setRunning(position.size()<numBubbles);
-    
-    if (position.size() > numBubbles)
+    // grow to numBubbles at once, shrink by one bubble a frame
+    int n = numLive;
+    int target = ofClamp(numBubbles, 0, BUBBLES_MAX_BUBBLES);
+    if (n < target)
     {
-        int newSize = position.size()-1;
-        for (int i=newSize; i<position.size(); i++)
-        {
-            delete position[i];
+        for (int i=n; i<target; i++) {
+            spawnBubble(i);
         }
-        position.erase(position.begin()+newSize, position.end());
-        blurLevel.erase(blurLevel.begin()+newSize, blurLevel.end());
-        alpha.erase(alpha.begin()+newSize, alpha.end());
-        size.erase(size.begin()+newSize, size.end());
-        colorMargin.erase(colorMargin.begin()+newSize, colorMargin.end());
+        n = target;
+    }
+    else if (n > target)
+    {
+        n--;
+        position.resize(n);
     }
+    numLive = n;
     
-    for (int i=0; i<position.size(); i++)
+    position.setAll(TIMEFUNCTION_NOISE_MIN, -1*positionNoiseMargin);
+    position.setAll(TIMEFUNCTION_NOISE_MAX, positionNoiseMargin);
+    position.setAll(TIMEFUNCTION_NOISE_SPEED, positionNoiseFactor);
+    position.setAll(TIMEFUNCTION_SINE_MIN, -1*positionSineMargin);
+    position.setAll(TIMEFUNCTION_SINE_MAX, positionSineMargin);
+    position.setAll(TIMEFUNCTION_SINE_FREQ, positionSineFreq);
+    position.setDelTime(speed*10.0);
+    for (int i=0; i<n; i++)
     {
         alpha[i] = ofLerp(alpha[i], 100 + 100*sin(time + i), 0.03f);
         blurLevel[i] = ofLerp(blurLevel[i], 0.5 + 0.5*sin(1.2*time - i), 0.03f);
         size[i] = ofLerp(size[i], 0.2 + 0.4*sin(1.1*time-5+1.8*i), 0.03f);
-        position[i]->setNoiseMin(-1*positionNoiseMargin);
-        position[i]->setNoiseMax(positionNoiseMargin);
-        position[i]->setNoiseSpeed(positionNoiseFactor);
-        position[i]->setSineMin(-1*positionSineMargin);
-        position[i]->setSineMax(positionSineMargin);
-        position[i]->setSineFreq(positionSineFreq);
-        position[i]->setTimeCoefficient(ofVec2f(
-            positionTimeConstant.x * (0.5 + 0.5*ofNoise(i, 10)),
-            positionTimeConstant.y * (0.5 + 0.5*ofNoise(i, 20))));
-        position[i]->setDelTime(speed*10.0);
-        position[i]->update();
+        position.set(TIMEFUNCTION_TIME_COEFFICIENT, i, ofVec2f(
+            positionTimeConstant.x * (0.5 + 0.5*timeNoise[i]),
+            positionTimeConstant.y * (0.5 + 0.5*timeNoise[BUBBLES_MAX_BUBBLES + i])));
     }
+    position.update();
+    position.evaluate();
     
     time += speed;
 }
@@ -161,8 +131,8 @@ void Bubbles::draw(int x, int y)
     Scene::beginDraw(x, y);
 
     ofSetRectMode(OF_RECTMODE_CENTER);
-    cout << "size :: pos " << position.size() << ", cm " << colorMargin.size() << endl;
-    for (int i=0; i<position.size(); i++)
+    int n = numLive;
+    for (int i=0; i<n; i++)
     {
         ofSetColor(255 * baseColor.r + colorMargin[i].x * varColor.x,
                    255 * baseColor.g + colorMargin[i].y * varColor.y,
@@ -171,7 +141,7 @@ void Bubbles::draw(int x, int y)
         int idx = (int) (blurAmt * blurLevel[i]);
         
         // draw + wrap
-        ofVec2f pos = position[i]->get();
+        ofVec2f pos = position.getValue(i);
         bubbleFbo[idx].draw((int)(pos.x + width  * (1 + abs(ceil(pos.x / width )))) % width,
                             (int)(pos.y + height * (1 + abs(ceil(pos.y / height)))) % height,
                             maxSize * size[i], maxSize * size[i]);
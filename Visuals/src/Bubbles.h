@@ -2,47 +2,31 @@
 
 #include "ofMain.h"
 #include "Scene.h"
-#include "TimeFunction.h"
+#include "TimeFunctionBank.h"
+#include "Noise.h"
 #include "ofxBlurShader.h"
+#include <atomic>
 
+#define BUBBLES_MAX_BUBBLES 2048
+
+
+// Bubbles live in fixed arrays of BUBBLES_MAX_BUBBLES allocated in setup,
+// the first numLive of them drawn. Spawning initializes the next slot and
+// bumps the count, so nothing is reallocated while the scene runs.
 
 class Bubbles : public Scene
 {
 public:
     Bubbles() {setName("Bubbles");}
-    ~Bubbles();  
     void setup(int width, int height, bool clearControls=true);
     void update();
     void draw(int x, int y);
     
 private:
     
-    class BubbleCreator : public ofThread
-    {
-    public:
-        void setup(vector<TimeFunction<ofVec2f> *> &position,
-                   vector<ofVec3f> &colorMargin,
-                   vector<float> &blurLevel,
-                   vector<float> &alpha,
-                   vector<float> &size,
-                   int &numBubbles,
-                   int width, int height);
-        void setRunning(bool b);
-        
-    protected:
-        void threadedFunction();
-        
-        vector<TimeFunction<ofVec2f> *> *position;
-        vector<ofVec3f> *colorMargin;
-        vector<float> *blurLevel;
-        vector<float> *alpha;
-        vector<float> *size;
-        int *numBubbles;
-        int width, height;
-    };
-
     void fboParametersChanged(GuiSliderEventArgs<int> &e);
     void setupBubblesFbo();
+    void spawnBubble(int i);
     
     ofxBlurShader blur;
     vector<ofFbo> bubbleFbo;
@@ -63,12 +47,13 @@ private:
     int blurAmt;
     
     // for each bubble
-    vector<TimeFunction<ofVec2f> *> position;
+    std::atomic<int> numLive;
+    TimeFunctionBank<ofVec2f> position;
     vector<ofVec3f> colorMargin;
     vector<float> blurLevel;
     vector<float> alpha;
     vector<float> size;
+    vector<float> timeNoise;
     
     float time;
-    BubbleCreator bubbleCreator;
 };
\ No newline at end of file
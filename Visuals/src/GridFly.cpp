@@ -25,15 +25,9 @@ void GridFly::setup(int width, int height, bool clearControls)
     control.addMultiSlider("axis", &axis, ofVec3f(0, -1, -1), ofVec3f(1, 1, 1));
     control.addColor("color", &color);
     
-    vertices = &mesh.getVertices();
-    for (int j=0; j<ny; j++)
-    {
-        addRow();
-        y++;
-    }
-    minY = -length.y;
-    dy = length.y / ny;
-    y = 0;
+    Z = 0;
+    firstRow = 0;
+    setupGrid();
 }
 
 void GridFly::update()
@@ -44,51 +38,98 @@ void GridFly::update()
     cam.rotate(angle, axis.x, axis.y, axis.z);
     cam.setPosition(camPosition.x, Z, camPosition.y);
     
-    if (vertices->size() > nx*ny*6)
-    {
-        vertices->erase(vertices->begin(), vertices->begin() + (vertices->size() - nx*ny));
+    if (nx != gridNx || ny != gridNy) {
+        setupGrid();
     }
-    while (cam.getPosition().y > minY)
+    
+    // recycle the rows behind the camera to the far end
+    while (cam.getPosition().y > vertices[(firstRow % gridNy) * gridNx * 6].y)
     {
-        vertices->erase(vertices->begin(), vertices->begin() + nx*6);
-        minY = vertices->at(0).y;
-        addRow();
-        y++;
+        setRow(firstRow + gridNy);
+        firstRow++;
+        if (numDirtyRows++ == 0) {
+            firstDirtyRow = firstRow + gridNy - 1;
+        }
+        if (numDirtyRows > gridNy)
+        {
+            firstDirtyRow = firstRow;
+            numDirtyRows = gridNy;
+        }
+    }
+}
+
+void GridFly::setupGrid()
+{
+    gridNx = nx;
+    gridNy = ny;
+    vertices.resize(gridNx * gridNy * 6);
+    for (int row=firstRow; row<firstRow+gridNy; row++) {
+        setRow(row);
     }
+    vbo.setVertexData(&vertices[0], vertices.size(), GL_DYNAMIC_DRAW);
+    firstDirtyRow = firstRow;
+    numDirtyRows = 0;
 }
 
-void GridFly::addRow()
+void GridFly::setRow(int row)
 {
-    for (int x=0; x<nx; x++)
+    ofVec3f *v = &vertices[(row % gridNy) * gridNx * 6];
+    float y1 = ofMap(row, 0, gridNy, -length.y, 0);
+    float y2 = ofMap(row+1, 0, gridNy, -length.y, 0);
+    for (int x=0; x<gridNx; x++)
     {
-        float x1 = ofMap(x, 0, nx, -0.5*length.x, 0.5*length.x);
-        float x2 = ofMap(x+1, 0, nx, -0.5*length.x, 0.5*length.x);
-        float y1 = ofMap(y, 0, ny, -length.y, 0);
-        float y2 = ofMap(y+1, 0, ny, -length.y, 0);
+        float x1 = ofMap(x, 0, gridNx, -0.5*length.x, 0.5*length.x);
+        float x2 = ofMap(x+1, 0, gridNx, -0.5*length.x, 0.5*length.x);
         
         float z11 = -margin * (-1.0 + 2.0*ofNoise(noiseFactor.x * x1, noiseFactor.y * y1));
         float z12 = -margin * (-1.0 + 2.0*ofNoise(noiseFactor.x * x1, noiseFactor.y * y2));
         float z21 = -margin * (-1.0 + 2.0*ofNoise(noiseFactor.x * x2, noiseFactor.y * y1));
         float z22 = -margin * (-1.0 + 2.0*ofNoise(noiseFactor.x * x2, noiseFactor.y * y2));
         
-        mesh.addVertex(ofVec3f(x1, y1, z11));
-        mesh.addVertex(ofVec3f(x2, y1, z21));
-        mesh.addVertex(ofVec3f(x2, y2, z22));
+        *v++ = ofVec3f(x1, y1, z11);
+        *v++ = ofVec3f(x2, y1, z21);
+        *v++ = ofVec3f(x2, y2, z22);
         
-        mesh.addVertex(ofVec3f(x1, y1, z11));
-        mesh.addVertex(ofVec3f(x1, y2, z12));
-        mesh.addVertex(ofVec3f(x2, y2, z22));
+        *v++ = ofVec3f(x1, y1, z11);
+        *v++ = ofVec3f(x1, y2, z12);
+        *v++ = ofVec3f(x2, y2, z22);
     }
 }
 
+void GridFly::uploadRows()
+{
+    // the recycled rows are consecutive, so at most two runs of slots
+    if (numDirtyRows == 0) return;
+    int rowSize = gridNx * 6;
+    int slot = firstDirtyRow % gridNy;
+    int n1 = min(numDirtyRows, gridNy - slot);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.getVertId());
+    glBufferSubData(GL_ARRAY_BUFFER, slot * rowSize * sizeof(ofVec3f), n1 * rowSize * sizeof(ofVec3f), &vertices[slot * rowSize]);
+    if (numDirtyRows > n1) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (numDirtyRows - n1) * rowSize * sizeof(ofVec3f), &vertices[0]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    numDirtyRows = 0;
+}
+
 void GridFly::draw(int x, int y)
 {
     Scene::beginDraw(x, y);
 
+    uploadRows();
+    
+    // oldest row first, wrapping around the end of the ring
+    int rowSize = gridNx * 6;
+    int slot = firstRow % gridNy;
     ofNoFill();
     ofSetColor(color);
     cam.begin();
-    mesh.drawWireframe();
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    vbo.draw(GL_TRIANGLES, slot * rowSize, (gridNy - slot) * rowSize);
+    if (slot > 0) {
+        vbo.draw(GL_TRIANGLES, 0, slot * rowSize);
+    }
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     cam.end();
 
     Scene::endDraw();
@@ -13,13 +13,20 @@ public:
         
 private:
     
-    void addRow();
+    void setupGrid();
+    void setRow(int row);
+    void uploadRows();
     
-    ofMesh mesh;
     ofEasyCam cam;
     
-    vector<ofVec3f> *vertices;
-    float minY, dy, y, Z;
+    // ring of gridNy rows of gridNx*6 vertices; row r lives in slot r % gridNy
+    // and is overwritten in place by row r + gridNy once the camera passes it
+    vector<ofVec3f> vertices;
+    ofVbo vbo;
+    int gridNx, gridNy;
+    int firstRow;
+    int firstDirtyRow, numDirtyRows;
+    float Z;
     ofPoint camPosition = ofPoint(0, 100);
     
     int nx;
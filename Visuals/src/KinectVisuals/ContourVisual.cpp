@@ -60,22 +60,17 @@ void ContourVisual::draw()
 
 void ContourVisual::recordContours(OpenNI & openNi)
 {
-    ContourFinder & contourFinder = openNi.getContourFinder();
-    RectTracker & tracker = contourFinder.getTracker();
+    OpenNI::ContourSnapshot & snapshot = openNi.getContours();
     
     currentContours.clear();
     labels.clear();
     
     calibrated = true;
     
-    for(int i = 0; i < openNi.getNumContours(); i++)
+    for(int i = 0; i < snapshot.contours.size(); i++)
     {
-        vector<cv::Point> points = contourFinder.getContour(i);
-        int label = contourFinder.getLabel(i);
-        ofPoint center = toOf(contourFinder.getCenter(i));
-        int age = tracker.getAge(label);
-        vector<cv::Point> fitPoints = contourFinder.getFitQuad(i);
-        cv::RotatedRect fitQuad = contourFinder.getFitEllipse(i);
+        int label = snapshot.labels[i];
+        ofPoint center = snapshot.centers[i];
         
         bool contourExists = false;
         for (int c=0; c<contours.size(); c++)
@@ -98,7 +93,7 @@ void ContourVisual::recordContours(OpenNI & openNi)
                     contours[c]->setPoints(calibratedContour, center);
                 }
                 else {
-                    contours[c]->setPoints((vector<ofVec2f> &) contourFinder.getContour(i), center);
+                    contours[c]->setPoints((vector<ofVec2f> &) snapshot.contours[i], center);
                 }
                 contourExists = true;
                 break;
@@ -123,7 +118,7 @@ void ContourVisual::recordContours(OpenNI & openNi)
                 contours.push_back(new Contour(calibratedContour, center, label));
             }
             else {
-                contours.push_back(new Contour((vector<ofVec2f> &) contourFinder.getContour(i), center, label));
+                contours.push_back(new Contour((vector<ofVec2f> &) snapshot.contours[i], center, label));
             }
         }
         labels.push_back(label);
@@ -42,27 +42,32 @@ void Letters::setup(int width, int height, bool clearControls)
 
 void Letters::update()
 {
-    if (chars.size() != nrows * ncols)
+    if (chars.size() != nrows * ncols || rateField.getCols() != ncols)
     {
         chars.resize(nrows * ncols);
         charsC.resize(nrows * ncols);
         font.loadFont("fonts/AndaleMono.ttf", (int) height / nrows);
         fontC.loadFont("fonts/Chinese4.ttf", 0.72 * (int) height / nrows, true, true, true);
+        rateField.setup(ncols, nrows);
+        letterField.setup(ncols, nrows);
+        beginFields(ofGetFrameNum(), 1);
     }
     
     if (ofGetFrameNum() % rate == 0)
     {
+        rateField.finish();
+        letterField.finish();
         int idx = 0;
         float noiseX;
         for (int i=0; i<ncols; i++)
         {
             for (int j=0; j<nrows; j++)
             {
-                if (ofNoise(rateNoise.x*i, rateNoise.y*j, rateNoiseTime * ofGetFrameNum()) < density)
+                if (rateField.get(i, j) < density)
                 {
                     if (noisyLetters)
                     {
-                        noiseX = ofNoise(letterNoise.x*i, letterNoiseTime * ofGetFrameNum(), letterNoise.y*j);
+                        noiseX = letterField.get(i, j);
                         chars[idx] = alphanum [ (int) ofMap(noiseX, 0, 1, 81*letterRange.x, 81*letterRange.y) ];
                         charsC[idx] = 38 + (int) ofMap(noiseX, 0, 1, 86 * letterRange.x, 86 * letterRange.y);
                     }
@@ -75,7 +80,19 @@ void Letters::update()
                 idx++;
             }
         }
+        beginFields(ofGetFrameNum() + rate, rate);
     }
+    rateField.update();
+    letterField.update();
+}
+
+void Letters::beginFields(int frame, int numSlices)
+{
+    // the noise for the next refresh is spread over the frames until then
+    rateField.setSteps(ofVec3f(rateNoise.x, 0, 0), ofVec3f(0, rateNoise.y, 0));
+    rateField.begin(ofVec3f(0, 0, rateNoiseTime * frame), numSlices);
+    letterField.setSteps(ofVec3f(letterNoise.x, 0, 0), ofVec3f(0, 0, letterNoise.y));
+    letterField.begin(ofVec3f(0, letterNoiseTime * frame, 0), numSlices);
 }
 
 void Letters::draw(int x, int y)
@@ -2,6 +2,7 @@
 
 #include "ofMain.h"
 #include "Scene.h"
+#include "Noise.h"
 
 
 class Letters : public Scene
@@ -14,6 +15,8 @@ public:
 
 private:
     
+    void beginFields(int frame, int numSlices);
+    
     int nrows;
     int ncols;
     ofVec2f letterRange;
@@ -29,6 +32,7 @@ private:
     
     vector<char> chars;
     vector<int> charsC;
+    NoiseField rateField, letterField;
     ofTrueTypeFont font, fontC;
     static const char * alphanum;
 };
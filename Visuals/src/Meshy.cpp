@@ -6,6 +6,7 @@ void Meshy::setup(int width, int height, bool clearControls)
     Scene::setup(width, height, clearControls);
  
     realtime = true;
+    incremental = true;
     circles = true;
     filled = false;
     numCandidates = 10;
@@ -18,6 +19,7 @@ void Meshy::setup(int width, int height, bool clearControls)
     colorNoise = 0.001;
     
     control.addToggle("realtime", &realtime);
+    control.addToggle("incremental", &incremental);
     control.addToggle("circles", &circles);
     control.addToggle("filled", &filled);
     control.addSlider("numCandidates", &numCandidates, 1, 50);
@@ -59,36 +61,55 @@ void Meshy::update()
 {
     if (realtime)
     {
-        points.clear();
-        float x, y;
+        points.resize(numPoints);
+        noise.resize(2 * numPoints);
+        float t = triNoise * ofGetFrameNum();
+        Noise::noiseLine(numPoints, ofVec3f(10, t+10, 15), ofVec3f(0.7, 0, 0), &noise[0]);
+        Noise::noiseLine(numPoints, ofVec3f(20, t,    25), ofVec3f(1.2, 0, 0), &noise[numPoints]);
         for (int i=0; i<numPoints; i++) {
-            x = width  * ofNoise(10+0.7*i, triNoise * ofGetFrameNum()+10, 15);
-            y = height * ofNoise(20+1.2*i, triNoise * ofGetFrameNum(),    25);
-            points.push_back(ofPoint(x, y));
+            points[i].set(width * noise[i], height * noise[numPoints + i]);
+        }
+        if (incremental) {
+            triangulator.update(points);
+        }
+        else {
+            triangulator.triangulate(points);
         }
-        triangulator.triangulate(points);
     }
-    triangles = triangulator.getTriangles();
-    vertices = triangulator.getVertices();
 }
 
 void Meshy::draw(int x, int y)
 {
     Scene::beginDraw(x, y);
 
-    for (int i=0; i<triangles.size(); i++)
+    const vector<ITRIANGLE> &triangles = triangulator.getTriangles();
+    const vector<XYZ> &vertices = triangulator.getVertices();
+
+    // three color and six corner offsets per triangle, one batch each
+    int n = triangles.size();
+    float tc = colorNoise * ofGetFrameNum();
+    float tm = triNoise * ofGetFrameNum();
+    noise.resize(9 * max(n, 1));
+    const float *colorNoises = &noise[0];
+    const float *marginNoises = &noise[3 * n];
+    for (int k=0; k<3; k++) {
+        Noise::signedNoiseLine(n, ofVec3f(tc, 0, 50 + 10*k), ofVec3f(0, 1, 0), &noise[k * n]);
+    }
+    for (int k=0; k<6; k++) {
+        Noise::signedNoiseLine(n, ofVec3f(5*k, 0, tm), ofVec3f(0, 1, 0), &noise[(3 + k) * n]);
+    }
+
+    for (int i=0; i<n; i++)
     {
-        ITRIANGLE t0 = triangles[i];
-        XYZ v1 = vertices[t0.p1];
-        XYZ v2 = vertices[t0.p2];
-        XYZ v3 = vertices[t0.p3];
+        const ITRIANGLE &t0 = triangles[i];
+        const XYZ &v1 = vertices[t0.p1];
+        const XYZ &v2 = vertices[t0.p2];
+        const XYZ &v3 = vertices[t0.p3];
         
         float z = abs(v1.x-v2.x) + abs(v3.x-v2.x) + abs(v2.y-v1.y) + abs(v3.y-v2.y);
         if (z > 800) continue;
         
-        ofVec3f colorMargin = ofVec3f(ofSignedNoise(colorNoise * ofGetFrameNum(), i, 50),
-                                      ofSignedNoise(colorNoise * ofGetFrameNum(), i, 60),
-                                      ofSignedNoise(colorNoise * ofGetFrameNum(), i, 70));
+        ofVec3f colorMargin = ofVec3f(colorNoises[i], colorNoises[n + i], colorNoises[2*n + i]);
         
         ofSetColor(255*color.r + colorMargin.x * varColor.r,
                    255*color.g + colorMargin.y * varColor.g,
@@ -106,12 +127,12 @@ void Meshy::draw(int x, int y)
             ofSetLineWidth(lineWidth);
         }
         
-        ofTriangle(v1.x + margin * ofSignedNoise( 0, i, triNoise * ofGetFrameNum()),
-                   v1.y + margin * ofSignedNoise( 5, i, triNoise * ofGetFrameNum()),
-                   v2.x + margin * ofSignedNoise(10, i, triNoise * ofGetFrameNum()),
-                   v2.y + margin * ofSignedNoise(15, i, triNoise * ofGetFrameNum()),
-                   v3.x + margin * ofSignedNoise(20, i, triNoise * ofGetFrameNum()),
-                   v3.y + margin * ofSignedNoise(25, i, triNoise * ofGetFrameNum()));
+        ofTriangle(v1.x + margin * marginNoises[i],
+                   v1.y + margin * marginNoises[n + i],
+                   v2.x + margin * marginNoises[2*n + i],
+                   v2.y + margin * marginNoises[3*n + i],
+                   v3.x + margin * marginNoises[4*n + i],
+                   v3.y + margin * marginNoises[5*n + i]);
     }
 
     Scene::endDraw();
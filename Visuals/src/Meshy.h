@@ -3,6 +3,7 @@
 #include "ofMain.h"
 #include "Scene.h"
 #include "PointGeneration.h"
+#include "Noise.h"
 
 
 class Meshy : public Scene
@@ -21,11 +22,11 @@ private:
     EvenPointsGenerator pointGenerator;
     Triangulator triangulator;
     
-    vector<ITRIANGLE> triangles;
-    vector<XYZ> vertices;
     vector<ofPoint> points;
+    vector<float> noise;
     
     bool realtime;
+    bool incremental;
     bool circles;
     bool filled;
     int numCandidates;
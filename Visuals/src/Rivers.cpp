@@ -1,44 +1,108 @@
 #include "Rivers.h"
 
 
-void Streak::setup(float x, float y, int maxAge, float speed,
-                   int maxThickness, float strokeAlpha,
-                   int width, int height, ofFloatColor color) {
-    pos.set(x, y);
-    prev.set(x, y);
-    age = 0;
-
-    this->width = width;
-    this->height = height;
-    this->maxAge = maxAge;
-    this->speed = speed;
-    this->maxThickness = maxThickness;
-    this->strokeAlpha = strokeAlpha;
-    this->color = color;
+StreakBatch::StreakBatch()
+{
+    numQuads = 0;
+    numIndicesUploaded = 0;
 }
 
-void Streak::update(ofPoint vel)
+void StreakBatch::resize(int numStreaks)
 {
-    prev.set(pos.x, pos.y);
-    pos += (speed * vel);
-    age++;
-    if (pos.x > width  || pos.x < 0 ||
-        pos.y > height || pos.y < 0) {
-        age = maxAge;
+    numQuads = numStreaks;
+    vertices.resize(4 * numQuads);
+    colors.resize(4 * numQuads);
+    
+    // texture coordinates and indices are the same every frame
+    int previous = indices.size() / 6;
+    if (numQuads > previous)
+    {
+        texCoords.resize(4 * numQuads);
+        indices.resize(6 * numQuads);
+        for (int i=previous; i<numQuads; i++)
+        {
+            texCoords[4*i  ].set(0, 0);
+            texCoords[4*i+1].set(1, 0);
+            texCoords[4*i+2].set(1, 1);
+            texCoords[4*i+3].set(0, 1);
+            indices[6*i  ] = 4*i;
+            indices[6*i+1] = 4*i+1;
+            indices[6*i+2] = 4*i+2;
+            indices[6*i+3] = 4*i;
+            indices[6*i+4] = 4*i+2;
+            indices[6*i+5] = 4*i+3;
+        }
     }
 }
 
-void Streak::draw()
+void StreakBatch::build(int begin, int end,
+                        const vector<ofVec2f> &pos, const vector<float> &age,
+                        const vector<float> &maxAge, const vector<ofColor> &color,
+                        float maxThickness, float streakAlpha)
 {
-    float size = ofMap(abs(age - 0.5 * maxAge), 0.5 * maxAge, 0, 0, maxThickness);
-    float alph = ofMap(abs(age - 0.5 * maxAge), 0.5 * maxAge, 0, 1, strokeAlpha);
-    ofSetColor(255 * color.r, 255 * color.g, 255 * color.b, alph);
-    ofEllipse(pos.x, pos.y, size, size);
+    // streaks grow and fade in over the first half of their life, then shrink and fade out
+    for (int i=begin; i<end; i++)
+    {
+        float halfAge = 0.5 * maxAge[i];
+        float size = 0, alph = 0;
+        if (halfAge > 0)
+        {
+            size = ofMap(abs(age[i] - halfAge), halfAge, 0, 0, maxThickness);
+            alph = ofMap(abs(age[i] - halfAge), halfAge, 0, 1, streakAlpha);
+        }
+        float r = 0.5 * size;
+        vertices[4*i  ].set(pos[i].x - r, pos[i].y - r);
+        vertices[4*i+1].set(pos[i].x + r, pos[i].y - r);
+        vertices[4*i+2].set(pos[i].x + r, pos[i].y + r);
+        vertices[4*i+3].set(pos[i].x - r, pos[i].y + r);
+        ofFloatColor c(color[i].r / 255.0f, color[i].g / 255.0f, color[i].b / 255.0f, alph / 255.0f);
+        colors[4*i] = colors[4*i+1] = colors[4*i+2] = colors[4*i+3] = c;
+    }
 }
 
-bool Streak::isActive()
+void StreakBatch::draw()
 {
-    return age<maxAge;
+    if (numQuads == 0) return;
+    if (!sprite.isAllocated()) {
+        setupSprite();
+    }
+    
+    vbo.setVertexData(&vertices[0], vertices.size(), GL_STREAM_DRAW);
+    vbo.setColorData(&colors[0], colors.size(), GL_STREAM_DRAW);
+    if (numIndicesUploaded < indices.size())
+    {
+        // rectangle textures address in pixels
+        vector<ofVec2f> coords(texCoords.size());
+        for (int i=0; i<coords.size(); i++) {
+            coords[i] = sprite.getCoordFromPercent(texCoords[i].x, texCoords[i].y);
+        }
+        vbo.setTexCoordData(&coords[0], coords.size(), GL_STATIC_DRAW);
+        vbo.setIndexData(&indices[0], indices.size(), GL_STATIC_DRAW);
+        numIndicesUploaded = indices.size();
+    }
+    
+    ofSetColor(255);
+    sprite.bind();
+    vbo.drawElements(GL_TRIANGLES, 6 * numQuads);
+    sprite.unbind();
+}
+
+void StreakBatch::setupSprite()
+{
+    // white disc with a one pixel soft edge, coverage in the alpha channel
+    ofPixels pixels;
+    pixels.allocate(RIVERS_SPRITE_SIZE, RIVERS_SPRITE_SIZE, OF_IMAGE_COLOR_ALPHA);
+    float c = 0.5 * RIVERS_SPRITE_SIZE;
+    for (int y=0; y<RIVERS_SPRITE_SIZE; y++)
+    {
+        for (int x=0; x<RIVERS_SPRITE_SIZE; x++)
+        {
+            float d = ofDist(x + 0.5, y + 0.5, c, c);
+            pixels.setColor(x, y, ofColor(255, 255 * ofClamp(c - d, 0, 1)));
+        }
+    }
+    sprite.allocate(pixels);
+    sprite.loadData(pixels);
 }
 
 void Rivers::setup(int width, int height, bool clearControls)
@@ -73,9 +137,16 @@ void Rivers::setup(int width, int height, bool clearControls)
     GuiButtonEventArgs evt(NULL, true);
     setupForceField(evt);
 
-    for (int i=0; i<numStreaks; i++) {
-        addNewStreak();
+    if (randoms.empty())
+    {
+        pool.setup();
+        randoms.resize(pool.getNumThreads());
+        for (int i=0; i<randoms.size(); i++) {
+            randoms[i].setSeed(ofRandom(1, 2147483647.0f));
+        }
     }
+    resizeStreaks(0);
+    resizeStreaks(numStreaks);
 }
 
 void Rivers::setupForceField(GuiButtonEventArgs &evt)
@@ -95,56 +166,76 @@ void Rivers::setupForceField(GuiButtonEventArgs &evt)
     }
 }
 
-void Rivers::setupStreak(Streak &streak)
+void Rivers::setupStreak(int i, FastRandom &random)
 {
-    int x = ofRandom(width);
-    int y = ofRandom(height);
-    int age = ofRandom(minAge, maxAge);
-    float speed = ofRandom(1.0-speedVar, 1.0+speedVar) * baseSpeed;
-    ofColor newColor = ofColor(ofClamp(255*color.r + ofRandom(-colorVar,colorVar), 0, 255),
-                               ofClamp(255*color.g + ofRandom(-colorVar,colorVar), 0, 255),
-                               ofClamp(255*color.b + ofRandom(-colorVar,colorVar), 0, 255));
-    streak.setup(x, y, age, speed,
-                 maxThickness, streakAlpha,
-                 width, height, newColor);
+    int x = random.random(width);
+    int y = random.random(height);
+    streakPos[i].set(x, y);
+    streakPrev[i].set(x, y);
+    streakAge[i] = 0;
+    streakMaxAge[i] = (int) random.random(minAge, maxAge);
+    streakSpeed[i] = random.random(1.0-speedVar, 1.0+speedVar) * baseSpeed;
+    streakColor[i].set(ofClamp(255*color.r + random.random(-colorVar,colorVar), 0, 255),
+                       ofClamp(255*color.g + random.random(-colorVar,colorVar), 0, 255),
+                       ofClamp(255*color.b + random.random(-colorVar,colorVar), 0, 255));
 }
 
-void Rivers::addNewStreak()
+void Rivers::resizeStreaks(int n)
 {
-    Streak streak; // = new Streak();
-    setupStreak(streak);
-    streaks.push_back(streak);
+    int previous = streakPos.size();
+    streakPos.resize(n);
+    streakPrev.resize(n);
+    streakAge.resize(n);
+    streakMaxAge.resize(n);
+    streakSpeed.resize(n);
+    streakColor.resize(n);
+    for (int i=previous; i<n; i++) {
+        setupStreak(i, randoms[0]);
+    }
 }
 
 void Rivers::update()
 {
-    while (streaks.size() < numStreaks) {
-        addNewStreak();
-    }
-    while (streaks.size() > numStreaks) {
-        streaks.pop_back();
+    if (streakPos.size() != numStreaks) {
+        resizeStreaks(numStreaks);
     }
-    
-    vector<Streak>::iterator streak = streaks.begin();
-    while (streak != streaks.end())
+    pool.parallelFor(numStreaks, RIVERS_CHUNK_SIZE, [this](int begin, int end, int thread) {
+        updateStreaks(begin, end, thread);
+    });
+}
+
+void Rivers::updateStreaks(int begin, int end, int thread)
+{
+    // work on a copy of the generator so threads don't share a cache line
+    FastRandom random = randoms[thread];
+    float fx = (float) FORCE_RESOLUTION / width;
+    float fy = (float) FORCE_RESOLUTION / height;
+    for (int i=begin; i<end; i++)
     {
-        int ix = ofClamp(ofMap((*streak).pos.x, 0, width, 0, FORCE_RESOLUTION), 0, FORCE_RESOLUTION-1);
-        int iy = ofClamp(ofMap((*streak).pos.y, 0, height, 0, FORCE_RESOLUTION), 0, FORCE_RESOLUTION-1);
-        (*streak).update(force[ix][iy]);
-        if (!(*streak).isActive()) {
-            setupStreak(*streak);            
+        ofVec2f &pos = streakPos[i];
+        int ix = ofClamp(pos.x * fx, 0, FORCE_RESOLUTION-1);
+        int iy = ofClamp(pos.y * fy, 0, FORCE_RESOLUTION-1);
+        streakPrev[i] = pos;
+        pos += streakSpeed[i] * force[ix][iy];
+        streakAge[i]++;
+        if (pos.x > width  || pos.x < 0 ||
+            pos.y > height || pos.y < 0 ||
+            streakAge[i] >= streakMaxAge[i]) {
+            setupStreak(i, random);
         }
-        streak++;
     }
+    randoms[thread] = random;
 }
 
 void Rivers::draw(int x, int y)
 {
     Scene::beginDraw(x, y);
 
-    for (vector<Streak>::iterator it = streaks.begin(); it != streaks.end(); ++it){
-        (*it).draw();
-    }
+    batch.resize(streakPos.size());
+    pool.parallelFor(streakPos.size(), RIVERS_CHUNK_SIZE, [this](int begin, int end, int thread) {
+        batch.build(begin, end, streakPos, streakAge, streakMaxAge, streakColor, maxThickness, streakAlpha);
+    });
+    batch.draw();
     
     Scene::endDraw();
 }
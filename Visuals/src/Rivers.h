@@ -2,25 +2,51 @@
 
 #include "ofMain.h"
 #include "Scene.h"
+#include "WorkerPool.h"
+#include "FastRandom.h"
 
 
 #define FORCE_RESOLUTION 16
+#define RIVERS_CHUNK_SIZE 4096
+#define RIVERS_SPRITE_SIZE 64
 
 
-class Streak
+// Vertex buffer holding one textured quad per streak, drawn in a single call.
+// build() only fills the CPU-side arrays, so it can run on worker threads
+// (and without a GL context); draw() uploads them and renders the quads with
+// a round sprite.
+
+class StreakBatch
 {
 public:
-    void setup(float x, float y, int maxAge, float speed,
-               int maxThickness, float strokeAlpha,
-               int width, int height, ofFloatColor color);
-    void update(ofPoint vel);
+    StreakBatch();
+
+    void resize(int numStreaks);
+    void build(int begin, int end,
+               const vector<ofVec2f> &pos, const vector<float> &age,
+               const vector<float> &maxAge, const vector<ofColor> &color,
+               float maxThickness, float streakAlpha);
     void draw();
-    bool isActive();
 
-    ofVec2f pos, prev;
-    float age, maxAge, speed, speedVar, maxThickness, strokeAlpha;
-    ofFloatColor color;
-    int width, height;
+    int getNumQuads() {return numQuads;}
+    const vector<ofVec2f> & getVertices() {return vertices;}
+    const vector<ofVec2f> & getTexCoords() {return texCoords;}
+    const vector<ofFloatColor> & getColors() {return colors;}
+    const vector<ofIndexType> & getIndices() {return indices;}
+
+private:
+
+    void setupSprite();
+
+    int numQuads;
+    vector<ofVec2f> vertices;
+    vector<ofVec2f> texCoords;
+    vector<ofFloatColor> colors;
+    vector<ofIndexType> indices;
+
+    ofVbo vbo;
+    ofTexture sprite;
+    int numIndicesUploaded;
 };
 
 
@@ -39,8 +65,9 @@ public:
 private:
     
     void setupForceField(GuiButtonEventArgs &evt);
-    void addNewStreak();
-    void setupStreak(Streak &streak);
+    void resizeStreaks(int n);
+    void setupStreak(int i, FastRandom &random);
+    void updateStreaks(int begin, int end, int thread);
     
     int numStreaks;
     float complexity;
@@ -54,7 +81,16 @@ private:
     ofFloatColor color;
     int colorVar;
     
-    vector<Streak> streaks;
-    //ofVec2f force[FORCE_RESOLUTION][FORCE_RESOLUTION];
+    // streaks as structure-of-arrays, updated in chunks on the pool
+    vector<ofVec2f> streakPos;
+    vector<ofVec2f> streakPrev;
+    vector<float> streakAge;
+    vector<float> streakMaxAge;
+    vector<float> streakSpeed;
+    vector<ofColor> streakColor;
+    
+    StreakBatch batch;
+    WorkerPool pool;
+    vector<FastRandom> randoms;     // one per pool thread
     float noiseSeed;
 };
@@ -22,6 +22,8 @@ void Scene::setName(string name)
 {
     this->name = name;
     control.setName(name);
+    updateStage = Profiler::getShared().getStage(name + "/update");
+    drawStage = Profiler::getShared().getStage(name + "/draw");
 }
 
 void Scene::setAutoUpdate(bool autoUpdate)
@@ -48,6 +50,7 @@ void Scene::setup(int width, int height, bool clearControls)
 
 void Scene::update(ofEventArgs &data)
 {
+    ProfilerScope scope(updateStage);
     update();
 }
 
@@ -64,6 +67,8 @@ void Scene::draw(int x, int y)
 
 void Scene::beginDraw(int x, int y)
 {
+    Profiler::getShared().begin(drawStage);
+    
     ofPushMatrix();
     ofPushStyle();
     
@@ -94,4 +99,6 @@ void Scene::endDraw()
 {
     ofPopStyle();
     ofPopMatrix();
+    
+    Profiler::getShared().end();
 }
@@ -2,6 +2,7 @@
 
 #include "ofMain.h"
 #include "Control.h"
+#include "Profiler.h"
 
 
 class Scene
@@ -40,5 +41,8 @@ protected:
     bool toClear;
     bool upsideDown;
     bool autoUpdate;
+    
+    // Profiler stages, named after the scene
+    int updateStage, drawStage;
 };
 
@@ -7,6 +7,11 @@ Shader::ShaderData::ShaderData(string name, string vert, string frag, GuiPanel &
     this->name = name;
     this->vert = vert;
     this->frag = frag;
+    program = ShaderCache::getShared().add(vert, frag);
+    linked = -1;
+    timeLocation = -1;
+    resolutionLocation = -1;
+    ubo = 0;
     widget = control.addWidget(name);
     widget->setCollapsible(true);
     widget->setActive(false);
@@ -40,6 +45,95 @@ void Shader::ShaderData::addParameter(string name, ofFloatColor min, ofFloatColo
     widget->addColor(name, var);
 }
 
+void Shader::ShaderData::upload(ofShader *shader)
+{
+    // uniforms belong to the program, which other Shaders may share
+    if (linked != program->links)
+    {
+        resolve(shader);
+        linked = program->links;
+    }
+    if (program->user != this)
+    {
+        for (auto p : shaderParameters) {
+            p->uploaded = p->generation - 1;
+        }
+        program->user = this;
+    }
+    
+    bool blockChanged = false;
+    for (auto p : shaderParameters)
+    {
+        p->poll();
+        if (p->uploaded == p->generation) {
+            continue;
+        }
+        if (p->location != -1) {
+            p->upload();
+        }
+        else if (p->offset != -1)
+        {
+            p->write(&block[p->offset]);
+            blockChanged = true;
+        }
+        p->uploaded = p->generation;
+    }
+    
+    if (!block.empty())
+    {
+        if (blockChanged)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, block.size(), &block[0]);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        glBindBufferBase(GL_UNIFORM_BUFFER, SHADER_UNIFORM_BINDING, ubo);
+    }
+}
+
+void Shader::ShaderData::resolve(ofShader *shader)
+{
+    GLuint id = shader->getProgram();
+    timeLocation = glGetUniformLocation(id, "time");
+    resolutionLocation = glGetUniformLocation(id, "resolution");
+    for (auto p : shaderParameters)
+    {
+        p->location = glGetUniformLocation(id, p->name.c_str());
+        p->offset = -1;
+        p->uploaded = p->generation - 1;
+    }
+    block.clear();
+    
+    // parameters declared in a uniform block go up in one buffer update
+    if (!GLEW_ARB_uniform_buffer_object) {
+        return;
+    }
+    GLuint blockIndex = glGetUniformBlockIndex(id, SHADER_UNIFORM_BLOCK);
+    if (blockIndex == GL_INVALID_INDEX) {
+        return;
+    }
+    GLint size;
+    glGetActiveUniformBlockiv(id, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+    glUniformBlockBinding(id, blockIndex, SHADER_UNIFORM_BINDING);
+    for (auto p : shaderParameters)
+    {
+        if (p->location != -1)  continue;
+        const GLchar *name = p->name.c_str();
+        GLuint index;
+        glGetUniformIndices(id, 1, &name, &index);
+        if (index != GL_INVALID_INDEX) {
+            glGetActiveUniformsiv(id, 1, &index, GL_UNIFORM_OFFSET, &p->offset);
+        }
+    }
+    block.assign(size, 0);
+    if (ubo == 0) {
+        glGenBuffers(1, &ubo);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 Shader::Shader(bool colorShader)
 {
     setName("Shader");
@@ -116,19 +210,17 @@ void Shader::selectShader(string shaderName)
 {
     if (shaders.count(shaderName) != 0)
     {
+        if (activeShader == shaders[shaderName]) {
+            return;
+        }
         if (activeShader != NULL) {
             activeShader->widget->setActive(false);
         }
-        else if (activeShader == shaders[shaderName]) {
-            return;
-        }
         
+        // the program is usually warm by now, otherwise it compiles here
         activeShader = shaders[shaderName];
         activeShader->widget->setActive(true);
-
-        shader.end();
-        shader.unload();
-        shader.load(activeShader->vert, activeShader->frag);
+        ShaderCache::getShared().get(activeShader->program);
         
         //vector<string> fragName = ofSplitString(activeShader->frag, "/");
         //setName(fragName[fragName.size()-1]);
@@ -149,6 +241,7 @@ void Shader::setTexture(ofFbo *fboTex)
 
 void Shader::update()
 {
+    ShaderCache::getShared().update();
     if (toSetNextShader)
     {
         selectShader(nextShader);
@@ -160,21 +253,26 @@ void Shader::draw(int x, int y)
 {
     Scene::beginDraw(x, y);
  
-    if (activeShader == NULL)
+    ofShader *shader = NULL;
+    if (activeShader != NULL) {
+        shader = ShaderCache::getShared().get(activeShader->program);
+    }
+    if (shader == NULL)
     {
         Scene::endDraw();
         return;
     }
         
-    shader.begin();
+    shader->begin();
     
-    shader.setUniform2f("resolution", width, height);
-    shader.setUniform1f("time", ofGetElapsedTimef());
-    
-    for (auto s : activeShader->shaderParameters)
-    {
-        s->update(&shader);
+    Profiler &profiler = Profiler::getShared();
+    if (profiler.getEnabled()) {
+        profiler.begin(getName() + "/uniforms");
     }
+    activeShader->upload(shader);
+    glUniform2f(activeShader->resolutionLocation, width, height);
+    glUniform1f(activeShader->timeLocation, ofGetElapsedTimef());
+    profiler.end();
 
     if (hasTexture) {
         fboTex->draw(0, 0, width, height);
@@ -188,7 +286,7 @@ void Shader::draw(int x, int y)
         glEnd();
     }
     
-    shader.end();
+    shader->end();
     
     Scene::endDraw();
 }
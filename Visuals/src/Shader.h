@@ -2,56 +2,122 @@
 
 #include "ofMain.h"
 #include "Scene.h"
+#include "ShaderCache.h"
 
 //http://patriciogonzalezvivo.com/2015/thebookofshaders/
 
 
+#define SHADER_UNIFORM_BLOCK "ShaderParameters"   // optional uniform block of the parameters
+#define SHADER_UNIFORM_BINDING 0                   // binding point of the block
+
+
+// A parameter's value and where it goes in the linked program: its uniform
+// location, or its offset in the parameter block. poll compares the value
+// the gui writes to with the last one seen and counts a new generation when
+// it changed, so only parameters newer than the generation uploaded to the
+// program are sent again.
+
 struct ShaderParameterBase
 {
-    virtual void update(ofShader *shader) {};
+    ShaderParameterBase(string name)
+    {
+        this->name = name;
+        location = -1;
+        offset = -1;
+        generation = 0;
+        uploaded = -1;
+    }
+    virtual ~ShaderParameterBase() {}
+    virtual void poll() {}
+    virtual void upload() {}
+    virtual void write(char *block) {}
+    
+    string name;
+    GLint location, offset;
+    int generation, uploaded;
 };
 
 template<typename T>
 struct ShaderParameter : public ShaderParameterBase
 {
-    ShaderParameter(string name, T *value)
+    ShaderParameter(string name, T *value) : ShaderParameterBase(name)
     {
-        this->name = name;
         this->value = value;
+        this->last = *value;
     }
-    void update(ofShader *shader);
+    void poll()
+    {
+        if (*value != last)
+        {
+            last = *value;
+            generation++;
+        }
+    }
+    void upload();
+    void write(char *block);
     T *value;
-    string name;
+    T last;
 };
 
 template<> inline
-void ShaderParameter<int>::update(ofShader *shader)
+void ShaderParameter<int>::upload()
+{
+    glUniform1f(location, last);
+}
+
+template<> inline
+void ShaderParameter<float>::upload()
+{
+    glUniform1f(location, last);
+}
+
+template<> inline
+void ShaderParameter<ofVec2f>::upload()
+{
+    glUniform2f(location, last.x, last.y);
+}
+
+template<> inline
+void ShaderParameter<ofVec3f>::upload()
+{
+    glUniform3f(location, last.x, last.y, last.z);
+}
+
+template<> inline
+void ShaderParameter<ofFloatColor>::upload()
+{
+    glUniform3f(location, last.r, last.g, last.b);
+}
+
+template<> inline
+void ShaderParameter<int>::write(char *block)
 {
-    shader->setUniform1f(name, *value);
+    float v = last;
+    memcpy(block, &v, sizeof(float));
 }
 
 template<> inline
-void ShaderParameter<float>::update(ofShader *shader)
+void ShaderParameter<float>::write(char *block)
 {
-    shader->setUniform1f(name, *value);
+    memcpy(block, &last, sizeof(float));
 }
 
 template<> inline
-void ShaderParameter<ofVec2f>::update(ofShader *shader)
+void ShaderParameter<ofVec2f>::write(char *block)
 {
-    shader->setUniform2f(name, value->x, value->y);
+    memcpy(block, last.getPtr(), 2 * sizeof(float));
 }
 
 template<> inline
-void ShaderParameter<ofVec3f>::update(ofShader *shader)
+void ShaderParameter<ofVec3f>::write(char *block)
 {
-    shader->setUniform3f(name, value->x, value->y, value->z);
+    memcpy(block, last.getPtr(), 3 * sizeof(float));
 }
 
 template<> inline
-void ShaderParameter<ofFloatColor>::update(ofShader *shader)
+void ShaderParameter<ofFloatColor>::write(char *block)
 {
-    shader->setUniform3f(name, value->r, value->g, value->b);
+    memcpy(block, &last.r, 3 * sizeof(float));
 }
 
 
@@ -69,11 +135,22 @@ public:
         void addParameter(string name, ofVec3f min, ofVec3f max);
         void addParameter(string name, ofFloatColor min, ofFloatColor max);
         
+        // with the program bound, uploads the parameters that changed
+        void upload(ofShader *shader);
+        void resolve(ofShader *shader);
+        
         vector<ShaderParameterBase *> shaderParameters;
         GuiWidget *widget;
         string name;
         string vert;
         string frag;
+        ShaderProgram *program;
+        
+        // locations are for this link of the program
+        int linked;
+        GLint timeLocation, resolutionLocation;
+        GLuint ubo;
+        vector<char> block;
     };
     
     Shader(bool colorShader=true);
@@ -86,6 +163,7 @@ public:
     void draw(int x, int y);
     
     void selectShader(string shaderName);
+    ShaderData * createShader(string shaderName, string vert, string frag);
     void setTexture(ofFbo *fboTex);
     
     // color presets
@@ -130,11 +208,9 @@ public:
 private:
 
     void chooseShader(GuiMenuEventArgs &e);
-    ShaderData * createShader(string shaderName, string vert, string frag);
 
     map<string, ShaderData*> shaders;
     ShaderData *activeShader;
-    ofShader shader;
     ofFbo *fboTex;
     bool hasTexture;
     GuiMenu *menuChoose;
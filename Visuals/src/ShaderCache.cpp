@@ -0,0 +1,200 @@
+#include "ShaderCache.h"
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+
+
+static long getModifiedTime(const string &path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+    return info.st_mtime;
+}
+
+static string readFile(const string &path)
+{
+    ifstream file(path.c_str());
+    stringstream source;
+    source << file.rdbuf();
+    return source.str();
+}
+
+ShaderCache & ShaderCache::getShared()
+{
+    static ShaderCache cache;
+    return cache;
+}
+
+ShaderCache::ShaderCache()
+{
+    hotReload = true;
+    lastUpdate = -1;
+    added = false;
+}
+
+ShaderCache::~ShaderCache()
+{
+    // programs are left to the context, which may be gone by now
+    stop();
+}
+
+ShaderProgram * ShaderCache::add(string vert, string frag)
+{
+    string key = vert + "|" + frag;
+    if (programs.count(key) != 0) {
+        return programs[key];
+    }
+
+    ShaderProgram *program = new ShaderProgram();
+    program->vert = vert;
+    program->frag = frag;
+    program->vertPath = ofToDataPath(vert, true);
+    program->fragPath = ofToDataPath(frag, true);
+    program->shader = NULL;
+    program->links = 0;
+    program->user = NULL;
+    program->vertTime = -1;
+    program->fragTime = -1;
+    program->sourceReady = false;
+    programs[key] = program;
+
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        list.push_back(program);
+        added = true;
+    }
+    cacheCondition.notify_all();
+    if (!isThreadRunning()) {
+        startThread(true, false);
+    }
+    return program;
+}
+
+ofShader * ShaderCache::get(ShaderProgram *program)
+{
+    if (program->shader == NULL)
+    {
+        read(program);
+        compile(program);
+    }
+    return program->shader;
+}
+
+void ShaderCache::update()
+{
+    if (lastUpdate == ofGetFrameNum())  return;
+    lastUpdate = ofGetFrameNum();
+
+    // programs compiled by get in the meantime are skipped
+    int compiled = 0;
+    while (compiled < SHADERCACHE_COMPILES_PER_FRAME)
+    {
+        ShaderProgram *program;
+        {
+            std::lock_guard<std::mutex> cacheLock(cacheMutex);
+            if (ready.empty())  break;
+            program = ready.front();
+            ready.erase(ready.begin());
+        }
+        compiled += compile(program);
+    }
+}
+
+void ShaderCache::setHotReload(bool hotReload)
+{
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    this->hotReload = hotReload;
+}
+
+void ShaderCache::threadedFunction()
+{
+    vector<ShaderProgram*> toRead;
+    while (isThreadRunning())
+    {
+        {
+            std::lock_guard<std::mutex> cacheLock(cacheMutex);
+            toRead = list;
+        }
+        for (auto program : toRead) {
+            read(program);
+        }
+
+        std::unique_lock<std::mutex> cacheLock(cacheMutex);
+        cacheCondition.wait_for(cacheLock, std::chrono::milliseconds(SHADERCACHE_POLL_MS),
+                                [this] { return added || !isThreadRunning(); });
+        added = false;
+    }
+}
+
+void ShaderCache::read(ShaderProgram *program)
+{
+    long vertTime = getModifiedTime(program->vertPath);
+    long fragTime = getModifiedTime(program->fragPath);
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        if (vertTime == program->vertTime && fragTime == program->fragTime) {
+            return;
+        }
+        if (program->vertTime != -1 && !hotReload) {
+            return;
+        }
+    }
+
+    string vertSource = readFile(program->vertPath);
+    string fragSource = readFile(program->fragPath);
+
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    program->vertTime = vertTime;
+    program->fragTime = fragTime;
+    program->vertSource = vertSource;
+    program->fragSource = fragSource;
+    program->sourceReady = true;
+    ready.push_back(program);
+}
+
+bool ShaderCache::compile(ShaderProgram *program)
+{
+    string vertSource, fragSource;
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        if (!program->sourceReady) {
+            return false;
+        }
+        vertSource.swap(program->vertSource);
+        fragSource.swap(program->fragSource);
+        program->sourceReady = false;
+    }
+
+    ofShader *shader = new ofShader();
+    bool linked = shader->setupShaderFromSource(GL_VERTEX_SHADER, vertSource) &&
+                  shader->setupShaderFromSource(GL_FRAGMENT_SHADER, fragSource);
+    if (linked)
+    {
+        shader->bindDefaults();
+        linked = shader->linkProgram();
+    }
+    if (!linked)
+    {
+        ofLog(OF_LOG_ERROR, "Can't compile shader "+program->vert+", "+program->frag);
+        delete shader;
+        return false;
+    }
+
+    delete program->shader;
+    program->shader = shader;
+    program->links++;
+    return true;
+}
+
+void ShaderCache::stop()
+{
+    if (!isThreadRunning()) return;
+    stopThread();
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    }
+    cacheCondition.notify_all();
+    waitForThread(false);
+}
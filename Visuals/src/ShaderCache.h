@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ofMain.h"
+#include <condition_variable>
+#include <mutex>
+
+#define SHADERCACHE_POLL_MS 500             // between checks of the files on disk
+#define SHADERCACHE_COMPILES_PER_FRAME 1    // pre-warm and reload budget
+
+
+// A linked program for one vert/frag pair. shader is only touched on the
+// render thread and is replaced, never modified, when the files change;
+// links counts the replacements, and user is whoever set its uniforms
+// last. The rest belongs to the cache's loader thread, under its lock.
+
+struct ShaderProgram
+{
+    string vert, frag;
+    string vertPath, fragPath;
+    ofShader *shader;
+    int links;
+    void *user;
+
+    long vertTime, fragTime;
+    string vertSource, fragSource;
+    bool sourceReady;
+};
+
+
+// Programs keyed by their vert and frag paths, shared by every Shader. A
+// loader thread reads the sources of new programs and polls the files'
+// modification times, reading them again when they change; update, on the
+// render thread, compiles a few read programs per frame, so all programs
+// are warm soon after startup and edited ones reload in place. A program
+// needed before it is warm is read and compiled on the spot. A failed
+// compile keeps the last working program.
+
+class ShaderCache : public ofThread
+{
+public:
+    ShaderCache();
+    ~ShaderCache();
+
+    static ShaderCache & getShared();
+
+    ShaderProgram * add(string vert, string frag);
+    ofShader * get(ShaderProgram *program);
+
+    // compile what the loader has read, once per frame at most
+    void update();
+
+    void setHotReload(bool hotReload);
+    bool getHotReload() {return hotReload;}
+
+private:
+
+    void threadedFunction();
+    void read(ShaderProgram *program);
+    bool compile(ShaderProgram *program);
+    void stop();
+
+    map<string, ShaderProgram*> programs;
+    vector<ShaderProgram*> list;
+    vector<ShaderProgram*> ready;
+    bool hotReload;
+    bool added;
+    int lastUpdate;
+
+    std::mutex cacheMutex;
+    std::condition_variable cacheCondition;
+};
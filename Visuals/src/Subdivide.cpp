@@ -1,159 +1,174 @@
 #include "Subdivide.h"
 
 
-Subdivision::Subdivision(int generation,
-                         int x, int y,
-                         int width, int height,
-                         ofFloatColor *color,
-                         ofFloatColor *varColor,
-                         int *circleResolution,
-                         bool *isLerp) {
-    this->generation = generation;
-    this->x = x;
-    this->y = y;
-    this->width = width;
-    this->height = height;
-    this->color = color;
-    this->varColor = varColor;
-    this->circleResolution = circleResolution;
-    this->isLerp = isLerp;
-    parent = NULL;
-    subdivide();
-}
-
-Subdivision::Subdivision(int generation,
-                         Subdivision *parent,
-                         bool topleft,
-                         int *circleResolution,
-                         bool *isLerp) {
-    this->generation = generation;
-    this->parent = parent;
-    this->topleft = topleft;
-    this->circleResolution = circleResolution;
-    this->isLerp = isLerp;
-    color = new ofFloatColor();
-    varColor = parent->varColor;
-    offset = ofVec3f(ofRandom(-1, 1), ofRandom(-1, 1), ofRandom(-1, 1));
-    subdivide();
-    update();
+void Subdivision::setup(int generations, int x, int y, int width, int height)
+{
+    nodes.clear();
+    Node root;
+    root.parent = -1;
+    root.x = x;
+    root.y = y;
+    root.width = width;
+    root.height = height;
+    nodes.push_back(root);
+    addNode(generations, -1, true);
 }
 
-void Subdivision::subdivide()
+int Subdivision::addNode(int generation, int parent, bool topleft)
 {
+    int index = 0;
+    if (parent != -1)
+    {
+        // a child takes its share of the parent's rectangle
+        const Node &p = nodes[parent];
+        Node node;
+        node.parent = parent;
+        if (p.horizontal)
+        {
+            node.x = p.x + (topleft ? 0.0 : p.width * p.ratio);
+            node.y = p.y;
+            node.width = p.width * (topleft ? p.ratio : 1.0 - p.ratio);
+            node.height = p.height;
+        }
+        else
+        {
+            node.y = p.y + (topleft ? 0.0 : p.height * p.ratio);
+            node.x = p.x;
+            node.width = p.width;
+            node.height = p.height * (topleft ? p.ratio : 1.0-p.ratio);
+        }
+        node.offset = ofVec3f(ofRandom(-1, 1), ofRandom(-1, 1), ofRandom(-1, 1));
+        index = nodes.size();
+        nodes.push_back(node);
+    }
+    
+    Node &node = nodes[index];
+    node.generation = generation;
+    node.child1 = node.child2 = -1;
     if (generation > 0)
     {
-        ratio = ofRandom(1);
-        horizontal = ofRandom(1) < 0.5 ? true : false;
-        child1 = new Subdivision(generation-1, this, true, circleResolution, isLerp);
-        child2 = new Subdivision(generation-1, this, false, circleResolution, isLerp);
+        node.ratio = ofRandom(1);
+        node.horizontal = ofRandom(1) < 0.5 ? true : false;
+        int child1 = addNode(generation-1, index, true);
+        int child2 = addNode(generation-1, index, false);
+        nodes[index].child1 = child1;
+        nodes[index].child2 = child2;
     }
+    return index;
 }
 
-void Subdivision::update()
+void Subdivision::update(const ofFloatColor &color, const ofFloatColor &varColor, bool isLerp)
 {
+    // parents come first, so one pass carries the colors down the tree
+    if (nodes.empty()) return;
+    nodes[0].color = color;
     int r, g, b;
-    if (parent == NULL) return;
-    if (parent->horizontal)
+    for (int i=1; i<nodes.size(); i++)
     {
-        x = parent->x + (topleft ? 0.0 : parent->width * parent->ratio);
-        y = parent->y;
-        width = parent->width * (topleft ? parent->ratio : 1.0 - parent->ratio);
-        height = parent->height;
-    }
-    else
-    {
-        y = parent->y + (topleft ? 0.0 : parent->height * parent->ratio);
-        x = parent->x;
-        width = parent->width;
-        height = parent->height * (topleft ? parent->ratio : 1.0-parent->ratio);
-    }
-    if (*isLerp)
-    {
-        r = ofClamp(ofLerp(255 * color->r, 255 * parent->color->r +
-                           255 * varColor->r * 0.2 * offset.x, 0.2), 0, 255);
-        g = ofClamp(ofLerp(255 * color->g, 255 * parent->color->g +
-                           255 * varColor->g * 0.2 * offset.y, 0.2), 0, 255);
-        b = ofClamp(ofLerp(255 * color->b, 255 * parent->color->b +
-                           255 * varColor->b * 0.2 * offset.z, 0.2), 0, 255);
-    }
-    else
-    {
-        r = 255 * parent->color->r + 255 * varColor->r * offset.x;
-        g = 255 * parent->color->g + 255 * varColor->g * offset.y;
-        b = 255 * parent->color->b + 255 * varColor->b * offset.z;
+        Node &node = nodes[i];
+        const ofFloatColor &parentColor = nodes[node.parent].color;
+        if (isLerp)
+        {
+            r = ofClamp(ofLerp(255 * node.color.r, 255 * parentColor.r +
+                               255 * varColor.r * 0.2 * node.offset.x, 0.2), 0, 255);
+            g = ofClamp(ofLerp(255 * node.color.g, 255 * parentColor.g +
+                               255 * varColor.g * 0.2 * node.offset.y, 0.2), 0, 255);
+            b = ofClamp(ofLerp(255 * node.color.b, 255 * parentColor.b +
+                               255 * varColor.b * 0.2 * node.offset.z, 0.2), 0, 255);
+        }
+        else
+        {
+            r = 255 * parentColor.r + 255 * varColor.r * node.offset.x;
+            g = 255 * parentColor.g + 255 * varColor.g * node.offset.y;
+            b = 255 * parentColor.b + 255 * varColor.b * node.offset.z;
+        }
+        node.color.set(ofColor(r, g, b, 255));
     }
-    color->set(ofColor(r, g, b, 255));
 }
 
-void Subdivision::draw(DrawStrategy drawStrategy)
+void Subdivision::draw(DrawStrategy drawStrategy, int circleResolution)
 {
-    update();
-    
-    ofSetCircleResolution(*circleResolution);
-    ofEnableSmoothing();
-    
-    if (generation == 0)
+    fills.clear();
+    fills.setMode(OF_PRIMITIVE_TRIANGLES);
+    lines.clear();
+    lines.setMode(OF_PRIMITIVE_LINES);
+    for (int i=0; i<nodes.size(); i++)
     {
+        if (nodes[i].generation != 0) continue;
         if (drawStrategy == RECTS) {
-            drawRect();
+            addRect(nodes[i]);
         }
         else if (drawStrategy == DIAMONDS) {
-            drawDiamond();
+            addDiamond(nodes[i]);
         }
         else if (drawStrategy == CIRCLES) {
-            drawCircle();
+            addCircle(nodes[i], circleResolution);
         }
     }
-    else
-    {
-        child1->draw(drawStrategy);
-        child2->draw(drawStrategy);
-    }
     
+    ofEnableSmoothing();
+    ofSetColor(255);
+    fills.draw();
+    ofSetColor(0);
+    ofSetLineWidth(1);
+    lines.draw();
     ofDisableSmoothing();
 }
 
-void Subdivision::drawRect()
+void Subdivision::addRect(const Node &node)
 {
-    ofSetColor(*color);
-    ofFill();
-    ofRect(x, y, width, height);
-    ofNoFill();
-    ofSetColor(0);
-    ofSetLineWidth(1);
-    ofRect(x, y, width, height);
+    outline.resize(4);
+    outline[0].set(node.x, node.y);
+    outline[1].set(node.x+node.width, node.y);
+    outline[2].set(node.x+node.width, node.y+node.height);
+    outline[3].set(node.x, node.y+node.height);
+    addOutline(outline, node.color);
 }
 
-void Subdivision::drawDiamond()
+void Subdivision::addDiamond(const Node &node)
 {
-    ofSetColor(*color);
-    ofFill();
-    ofBeginShape();
-        ofVertex(x, y+height/2);
-        ofVertex(x+width/2, y);
-        ofVertex(x+width, y+height/2);
-        ofVertex(x+width/2, y+height);
-    ofEndShape();
-    ofNoFill();
-    ofSetColor(0);
-    ofSetLineWidth(1);
-    ofBeginShape();
-        ofVertex(x, y+height/2);
-        ofVertex(x+width/2, y);
-        ofVertex(x+width, y+height/2);
-        ofVertex(x+width/2, y+height);
-    ofEndShape();
+    outline.resize(4);
+    outline[0].set(node.x, node.y+node.height/2);
+    outline[1].set(node.x+node.width/2, node.y);
+    outline[2].set(node.x+node.width, node.y+node.height/2);
+    outline[3].set(node.x+node.width/2, node.y+node.height);
+    addOutline(outline, node.color);
 }
 
-void Subdivision::drawCircle()
+void Subdivision::addCircle(const Node &node, int circleResolution)
 {
-    ofSetColor(*color);
-    ofFill();
-    ofEllipse(x+width/2, y+height/2, width, height);
-    ofNoFill();
-    ofSetColor(0);
-    ofSetLineWidth(1);
-    ofEllipse(x+width/2, y+height/2, width, height);
+    outline.resize(circleResolution);
+    for (int i=0; i<circleResolution; i++)
+    {
+        float angle = TWO_PI * i / circleResolution;
+        outline[i].set(node.x + 0.5 * node.width * (1 + cos(angle)),
+                       node.y + 0.5 * node.height * (1 + sin(angle)));
+    }
+    addOutline(outline, node.color);
+}
+
+void Subdivision::addOutline(const vector<ofPoint> &outline, const ofFloatColor &color)
+{
+    // convex, so filled as a fan from the first corner
+    int base = fills.getNumVertices();
+    int baseLines = lines.getNumVertices();
+    for (int i=0; i<outline.size(); i++)
+    {
+        fills.addVertex(outline[i]);
+        fills.addColor(color);
+        lines.addVertex(outline[i]);
+    }
+    for (int i=1; i+1<outline.size(); i++)
+    {
+        fills.addIndex(base);
+        fills.addIndex(base + i);
+        fills.addIndex(base + i + 1);
+    }
+    for (int i=0; i<outline.size(); i++)
+    {
+        lines.addIndex(baseLines + i);
+        lines.addIndex(baseLines + (i+1) % outline.size());
+    }
 }
 
 void Subdivide::setup(int width, int height, bool clearControls)
@@ -172,7 +187,7 @@ void Subdivide::setup(int width, int height, bool clearControls)
     drawTypes.push_back("Circles");
     control.addMenu("draw", drawTypes, this, &Subdivide::setDrawType);
 
-    start = new Subdivision(9, 0, 0, width, height, &color, &varColor, &circleResolution, &isLerp);
+    subdivision.setup(9, 0, 0, width, height);
 }
 
 void Subdivide::setDrawType(GuiMenuEventArgs &e)
@@ -197,6 +212,7 @@ void Subdivide::update()
 void Subdivide::draw(int x, int y)
 {
     Scene::beginDraw(x, y);
-    start->draw(drawStrategy);
+    subdivision.update(color, varColor, isLerp);
+    subdivision.draw(drawStrategy, circleResolution);
     Scene::endDraw();
 }
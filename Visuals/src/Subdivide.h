@@ -7,45 +7,43 @@
 enum DrawStrategy { RECTS, DIAMONDS, CIRCLES };
 
 
+// Recursive split of a rectangle, stored as one node array in depth-first
+// order with children linked by index, so a parent always comes before its
+// children and regenerating just clears the array. The leaves are drawn as
+// two batched meshes, fills and outlines.
+
 class Subdivision
 {
 public:
-    Subdivision(int generation,
-                int x, int y,
-                int width, int height,
-                ofFloatColor *color,
-                ofFloatColor *varColor,
-                int *circleResolution,
-                bool *isLerp);
-    Subdivision(int generation,
-                Subdivision *parent,
-                bool topleft,
-                int *circleResolution,
-                bool *isLerp);
-    void draw(DrawStrategy drawStrategy);
+    void setup(int generations, int x, int y, int width, int height);
+    void update(const ofFloatColor &color, const ofFloatColor &varColor, bool isLerp);
+    void draw(DrawStrategy drawStrategy, int circleResolution);
 
 private:
     
-    void subdivide();
-    void update();
+    struct Node
+    {
+        int parent, child1, child2;
+        int generation;
+        float ratio;
+        bool horizontal;
+        int x, y;
+        int width, height;
+        ofFloatColor color;
+        ofVec3f offset;
+    };
     
-    void drawRect();
-    void drawDiamond();
-    void drawCircle();
-
-    Subdivision *parent, *child1, *child2;
-    int generation;
-    float ratio;
-    bool topleft, horizontal;
-
-    int x, y;
-    int width, height;
+    int addNode(int generation, int parent, bool topleft);
+    
+    void addRect(const Node &node);
+    void addDiamond(const Node &node);
+    void addCircle(const Node &node, int circleResolution);
+    void addOutline(const vector<ofPoint> &outline, const ofFloatColor &color);
     
-    ofFloatColor *color;
-    ofFloatColor *varColor;
-    int *circleResolution;
-    bool *isLerp;
-    ofVec3f offset;
+    vector<Node> nodes;
+    vector<ofPoint> outline;
+    ofVboMesh fills;
+    ofVboMesh lines;
 };
 
 
@@ -67,5 +65,5 @@ private:
     ofFloatColor varColor;
     int circleResolution;
     bool isLerp;
-    Subdivision *start;
+    Subdivision subdivision;
 };